@@ -0,0 +1,216 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "src/assetrecord.h"
+#include "src/topologyresolver.h"
+#include <getopt.h>
+#include <iostream>
+#include <malamute.h>
+
+//  Record messages of the ASSETS stream into a file and replay them into a
+//  topologyresolver (as fty-info would process them) or into a broker, at
+//  the recorded speed, N times faster or as fast as possible.
+
+#define REPORT_PERIOD 1000000 // usec
+
+static void s_usage(void)
+{
+    std::cout << "fty-info-assets record [options] file\n"
+                 "  -e|--endpoint E     malamute endpoint [ipc://@/malamute]\n"
+                 "  -d|--duration S     stop after S seconds (default: until interrupted)\n"
+                 "fty-info-assets replay [options] file\n"
+                 "  -s|--speed X        X times the recorded speed, 0 as fast as possible (default 1)\n"
+                 "  -i|--iname INAME    iname of the rack controller (default: discovered from messages)\n"
+                 "  -e|--endpoint E     publish on ASSETS of the broker instead of feeding a local\n"
+                 "                      topologyresolver, announces are counted on ANNOUNCE\n";
+}
+
+typedef struct
+{
+    int64_t start;       // zclock_usecs() of the replay start
+    int64_t last_report; // usec since start
+    size_t  messages;
+    size_t  announces;
+    size_t  cached;      // assets cached by the resolver, 0 with a broker
+} replay_stats_t;
+
+static void s_report(replay_stats_t* stats, int64_t now)
+{
+    double elapsed = double(now) / 1000000;
+    printf("%8.1lf s: %zu messages (%.0lf/s), %zu announces, %zu assets cached\n", elapsed, stats->messages,
+        elapsed > 0 ? double(stats->messages) / elapsed : 0, stats->announces, stats->cached);
+    stats->last_report = now;
+}
+
+static int s_record(const char* endpoint, const char* path, int duration)
+{
+    assetrecord_t* record = assetrecord_new(path, true);
+    if (!record)
+        return EXIT_FAILURE;
+    mlm_client_t* client = mlm_client_new();
+    if (mlm_client_connect(client, endpoint, 1000, "fty-info-assets-recorder") != 0 ||
+        mlm_client_set_consumer(client, FTY_PROTO_STREAM_ASSETS, ".*") != 0) {
+        fprintf(stderr, "Could not subscribe to %s on %s\n", FTY_PROTO_STREAM_ASSETS, endpoint);
+        mlm_client_destroy(&client);
+        assetrecord_destroy(&record);
+        return EXIT_FAILURE;
+    }
+
+    zpoller_t* poller = zpoller_new(mlm_client_msgpipe(client), NULL);
+    int64_t    start  = zclock_usecs();
+    int64_t    end    = duration > 0 ? start + int64_t(duration) * 1000000 : INT64_MAX;
+    while (!zsys_interrupted && zclock_usecs() < end) {
+        if (!zpoller_wait(poller, 1000))
+            continue;
+        zmsg_t*      msg     = mlm_client_recv(client);
+        fty_proto_t* message = fty_proto_is(msg) ? fty_proto_decode(&msg) : NULL;
+        zmsg_destroy(&msg);
+        if (message) {
+            assetrecord_write(record, zclock_usecs() - start, message);
+            fty_proto_destroy(&message);
+        }
+    }
+    printf("%zu messages recorded in %.1lf s\n", assetrecord_size(record), double(zclock_usecs() - start) / 1000000);
+
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+    assetrecord_destroy(&record);
+    return EXIT_SUCCESS;
+}
+
+static size_t s_count_announces(mlm_client_t* client)
+{
+    size_t     announces = 0;
+    zpoller_t* poller    = zpoller_new(mlm_client_msgpipe(client), NULL);
+    while (zpoller_wait(poller, 0)) {
+        zmsg_t* msg = mlm_client_recv(client);
+        if (streq(mlm_client_command(client), "STREAM DELIVER"))
+            announces++;
+        zmsg_destroy(&msg);
+    }
+    zpoller_destroy(&poller);
+    return announces;
+}
+
+static int s_replay(const char* endpoint, const char* path, double speed, const char* iname)
+{
+    assetrecord_t* record = assetrecord_new(path, false);
+    if (!record)
+        return EXIT_FAILURE;
+    topologyresolver_t* resolver = NULL;
+    mlm_client_t*       client   = NULL;
+    if (endpoint) {
+        client = mlm_client_new();
+        if (mlm_client_connect(client, endpoint, 1000, "fty-info-assets-replayer") != 0 ||
+            mlm_client_set_producer(client, FTY_PROTO_STREAM_ASSETS) != 0 ||
+            mlm_client_set_consumer(client, "ANNOUNCE", ".*") != 0) {
+            fprintf(stderr, "Could not connect to %s\n", endpoint);
+            mlm_client_destroy(&client);
+            assetrecord_destroy(&record);
+            return EXIT_FAILURE;
+        }
+    } else
+        resolver = topologyresolver_new(iname);
+
+    replay_stats_t stats = {zclock_usecs(), 0, 0, 0, 0};
+    int64_t        timestamp;
+    fty_proto_t*   message;
+    while (!zsys_interrupted && (message = assetrecord_read(record, &timestamp)) != NULL) {
+        if (speed > 0) {
+            int64_t wait = int64_t(double(timestamp) / speed) - (zclock_usecs() - stats.start);
+            if (wait > 1000)
+                zclock_sleep(int(wait / 1000));
+        }
+        if (resolver) {
+            if (topologyresolver_asset(resolver, message))
+                stats.announces++;
+            stats.cached = topologyresolver_assets_size(resolver);
+            fty_proto_destroy(&message);
+        } else {
+            char* subject = zsys_sprintf("%s.%s@%s", fty_proto_aux_string(message, "type", ""),
+                fty_proto_aux_string(message, "subtype", ""), fty_proto_name(message));
+            zmsg_t* msg = fty_proto_encode(&message);
+            mlm_client_send(client, subject, &msg);
+            zstr_free(&subject);
+            stats.announces += s_count_announces(client);
+        }
+        stats.messages++;
+
+        int64_t now = zclock_usecs() - stats.start;
+        if (now - stats.last_report >= REPORT_PERIOD)
+            s_report(&stats, now);
+    }
+    if (client) {
+        // announces triggered by the last messages
+        zclock_sleep(500);
+        stats.announces += s_count_announces(client);
+    }
+    s_report(&stats, zclock_usecs() - stats.start);
+
+    mlm_client_destroy(&client);
+    topologyresolver_destroy(&resolver);
+    assetrecord_destroy(&record);
+    return EXIT_SUCCESS;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* endpoint = NULL;
+    const char* iname    = NULL;
+    double      speed    = 1;
+    int         duration = 0;
+
+    if (argc < 2 || !(streq(argv[1], "record") || streq(argv[1], "replay"))) {
+        s_usage();
+        return EXIT_FAILURE;
+    }
+    bool record = streq(argv[1], "record");
+
+    static const struct option options[] = {{"endpoint", required_argument, NULL, 'e'},
+        {"duration", required_argument, NULL, 'd'}, {"speed", required_argument, NULL, 's'},
+        {"iname", required_argument, NULL, 'i'}, {"help", no_argument, NULL, 'h'}, {NULL, 0, NULL, 0}};
+    int opt;
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "e:d:s:i:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'e':
+                endpoint = optarg;
+                break;
+            case 'd':
+                duration = atoi(optarg);
+                break;
+            case 's':
+                speed = strtod(optarg, NULL);
+                break;
+            case 'i':
+                iname = optarg;
+                break;
+            case 'h':
+                s_usage();
+                return EXIT_SUCCESS;
+            default:
+                s_usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        s_usage();
+        return EXIT_FAILURE;
+    }
+
+    if (record)
+        return s_record(endpoint ? endpoint : "ipc://@/malamute", argv[optind], duration);
+    return s_replay(endpoint, argv[optind], speed, iname);
+}
@@ -0,0 +1,142 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+
+#include "counters.h"
+#include "results.h"
+#include "tests/allocbudget.h"
+#include <cmath>
+#include <errno.h>
+#include <iostream>
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+//  System calls, counted by the kernel on the raw_syscalls:sys_enter
+//  tracepoint for the calling thread, so that calls made inside libc (stdio,
+//  getifaddrs, opendir) and io_uring_enter are included and library calls
+//  which need no system call are not
+
+static const char* s_tracepoint_ids[] = {
+    "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+    "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+};
+
+//  Return descriptor of the system call counter of this thread or -1 when
+//  tracefs is not mounted or perf events are not permitted
+static int s_syscall_counter()
+{
+    static int counter = -2;
+    if (counter != -2)
+        return counter;
+    counter               = -1;
+    unsigned long long id = 0;
+    for (const char* path : s_tracepoint_ids) {
+        FILE* file = fopen(path, "r");
+        if (!file)
+            continue;
+        int found = fscanf(file, "%llu", &id);
+        fclose(file);
+        if (found == 1)
+            break;
+        id = 0;
+    }
+    if (id == 0) {
+        std::cerr << "syscalls/op not measured: raw_syscalls:sys_enter tracepoint not found, mount tracefs"
+                  << std::endl;
+        return counter;
+    }
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type     = PERF_TYPE_TRACEPOINT;
+    attr.size     = sizeof(attr);
+    attr.config   = id;
+    attr.disabled = 1;
+    counter       = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    if (counter == -1)
+        std::cerr << "syscalls/op not measured: perf_event_open: " << strerror(errno)
+                  << " (see /proc/sys/kernel/perf_event_paranoid)" << std::endl;
+    return counter;
+}
+
+static void s_syscalls_start(int counter)
+{
+    if (counter != -1) {
+        ioctl(counter, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+//  Stop counter and return the system calls counted since start, the
+//  disabling ioctl itself included
+static double s_syscalls_stop(int counter)
+{
+    uint64_t count = 0;
+    if (counter == -1)
+        return NAN;
+    ioctl(counter, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(counter, &count, sizeof(count)) != sizeof(count))
+        return NAN;
+    return double(count);
+}
+
+//  --------------------------------------------------------------------------
+//  Run operation and count allocations and system calls
+
+bench_counters_t bench_count(const std::function<void()>& operation, int iterations)
+{
+    int counter = s_syscall_counter();
+    // calls of the counter itself
+    s_syscalls_start(counter);
+    double overhead = s_syscalls_stop(counter);
+    // first run fills caches, histories and open files
+    operation();
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    s_syscalls_start(counter);
+    allocbudget_start();
+    for (int i = 0; i < iterations; i++) {
+        operation();
+    }
+    allocbudget_t allocations = allocbudget_stop();
+    double        syscalls    = s_syscalls_stop(counter) - overhead;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = double(end.tv_sec - start.tv_sec) * 1e9 + double(end.tv_nsec - start.tv_nsec);
+    return {double(allocations.allocations) / iterations, syscalls / iterations, ns / iterations};
+}
+
+//  --------------------------------------------------------------------------
+//  Print counters of operation
+
+void bench_report(const char* name, const std::function<void()>& operation, int iterations)
+{
+    bench_counters_t counters = bench_count(operation, iterations);
+    char             line[200];
+    snprintf(line, sizeof(line), "%-40s %10.1f allocations/op %10.1f syscalls/op %12.0f ns/op", name,
+        counters.allocations, counters.syscalls, counters.ns);
+    // same stream as the Catch2 reporter, so that lines are not interleaved
+    std::cout << std::endl << line << std::endl;
+
+    bench_result_t result     = bench_result(name);
+    result.ns_per_op          = counters.ns;
+    result.allocations_per_op = counters.allocations;
+    result.syscalls_per_op    = counters.syscalls;
+    bench_result_add(result);
+}
@@ -0,0 +1,41 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+
+#pragma once
+#include <functional>
+#include <stddef.h>
+
+//  Heap allocations and system calls made by the benchmark thread.
+//  Allocations are counted by tests/allocbudget, the same malloc/calloc/
+//  realloc wrappers the allocation budget tests use. System calls
+//  of the calling thread are counted by the kernel with a perf event on the
+//  raw_syscalls:sys_enter tracepoint, which needs tracefs mounted and
+//  kernel.perf_event_paranoid <= 1 (or CAP_PERFMON); without them syscalls
+//  are NaN and left out of the results.
+
+typedef struct
+{
+    double allocations; // per operation
+    double syscalls;    // per operation, NaN if not measured
+    double ns;          // wall clock time per operation
+} bench_counters_t;
+
+//  Run operation iterations times and return the counters per operation
+bench_counters_t bench_count(const std::function<void()>& operation, int iterations = 1000);
+
+//  Print the counters of operation under name, next to Catch2 timing output,
+//  and add them to the results of this run (see results.h)
+void bench_report(const char* name, const std::function<void()>& operation, int iterations = 1000);
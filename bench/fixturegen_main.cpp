@@ -0,0 +1,90 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "tests/fixturegen.h"
+#include <getopt.h>
+#include <iostream>
+#include <stdlib.h>
+#include <unistd.h>
+
+static void s_usage(void)
+{
+    std::cout << "fty-info-fixturegen [options] root_dir\n"
+                 "  -i|--interfaces N   number of network interfaces (default 1000)\n"
+                 "  -c|--cpus N         number of CPUs (default 128)\n"
+                 "  -t|--thermal N      number of thermal zones (default 64)\n"
+                 "  -g|--cgroups N      number of cgroups (default 500)\n"
+                 "  -s|--snapshots N    write N snapshots (default 1)\n"
+                 "  -p|--period S       advance counters by S seconds per snapshot (default 30)\n"
+                 "  -h|--help           print this help\n"
+                 "With more snapshots, counters are advanced every period seconds of wall time,\n"
+                 "so fty-info can collect from root_dir meanwhile.\n";
+}
+
+int main(int argc, char* argv[])
+{
+    fixturegen_config_t config    = {1000, 128, 64, 500, 0};
+    long                snapshots = 1;
+    long                period    = 30;
+
+    static const struct option options[] = {{"interfaces", required_argument, NULL, 'i'},
+        {"cpus", required_argument, NULL, 'c'}, {"thermal", required_argument, NULL, 't'},
+        {"cgroups", required_argument, NULL, 'g'}, {"snapshots", required_argument, NULL, 's'},
+        {"period", required_argument, NULL, 'p'}, {"help", no_argument, NULL, 'h'}, {NULL, 0, NULL, 0}};
+    int opt;
+    while ((opt = getopt_long(argc, argv, "i:c:t:g:s:p:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                config.interfaces = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                config.cpus = strtoul(optarg, NULL, 10);
+                break;
+            case 't':
+                config.thermal_zones = strtoul(optarg, NULL, 10);
+                break;
+            case 'g':
+                config.cgroups = strtoul(optarg, NULL, 10);
+                break;
+            case 's':
+                snapshots = strtol(optarg, NULL, 10);
+                break;
+            case 'p':
+                period = strtol(optarg, NULL, 10);
+                break;
+            case 'h':
+                s_usage();
+                return EXIT_SUCCESS;
+            default:
+                s_usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        s_usage();
+        return EXIT_FAILURE;
+    }
+    std::string root_dir = argv[optind];
+    if (root_dir.back() != '/')
+        root_dir += '/';
+
+    fixturegen_t* fixture = fixturegen_new(root_dir, config);
+    for (long snapshot = 1; snapshot < snapshots; snapshot++) {
+        sleep(unsigned(period));
+        fixturegen_advance(fixture, double(period));
+    }
+    fixturegen_destroy(&fixture);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "bench/counters.h"
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/metricarena.h"
+#include "src/sourcereader.h"
+#include "src/syslimits.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <string.h>
+#include <vector>
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "tests/selftest-ro/data/"
+#endif
+
+TEST_CASE("linuxmetric parsers", "[benchmark]")
+{
+    sourcereader_t* reader  = sourcereader_new(BENCH_DATA_DIR);
+    sourcereader_t* live    = sourcereader_new("/");
+    zhashx_t*       history = linuxmetric_history_new();
+
+    auto uptime = [&] {
+        return linuxmetric_uptime(reader, false);
+    };
+    auto uptime_live = [&] {
+        return linuxmetric_uptime(live, true);
+    };
+    auto meminfo = [&] {
+        linuxmetric_memory_t memory;
+        linuxmetric_memory(reader, false, &memory);
+        return memory.total;
+    };
+    auto meminfo_live = [&] {
+        linuxmetric_memory_t memory;
+        linuxmetric_memory(live, true, &memory);
+        return memory.total;
+    };
+    auto interfaces = [&] {
+        zhashx_t* list = linuxmetric_list_interfaces(reader);
+        size_t    size = zhashx_size(list);
+        zhashx_destroy(&list);
+        return size;
+    };
+    auto get_all = [&] {
+        linuxmetric_list_t* info = linuxmetric_get_all(30, history, reader, true);
+        return metriclist_destroy(&info);
+    };
+
+    BENCHMARK("linuxmetric_uptime (proc/uptime)") { return uptime(); };
+    BENCHMARK("linuxmetric_uptime (CLOCK_BOOTTIME)") { return uptime_live(); };
+    BENCHMARK("linuxmetric_memory (proc/meminfo)") { return meminfo(); };
+    BENCHMARK("linuxmetric_memory (live host)") { return meminfo_live(); };
+    BENCHMARK("linuxmetric_list_interfaces") { return interfaces(); };
+    BENCHMARK("linuxmetric_get_all") { return get_all(); };
+
+    bench_report("linuxmetric_uptime (proc/uptime)", [&] { uptime(); });
+    bench_report("linuxmetric_uptime (CLOCK_BOOTTIME)", [&] { uptime_live(); });
+    bench_report("linuxmetric_memory (proc/meminfo)", [&] { meminfo(); });
+    bench_report("linuxmetric_memory (live host)", [&] { meminfo_live(); });
+    bench_report("linuxmetric_list_interfaces", [&] { interfaces(); });
+    bench_report("linuxmetric_get_all", [&] { get_all(); });
+
+    zhashx_destroy(&history);
+    sourcereader_destroy(&live);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("collectors", "[benchmark]")
+{
+    sourcereader_t* reader  = sourcereader_new(BENCH_DATA_DIR);
+    linuxsensors_t* sensors = linuxsensors_new(reader);
+    syslimits_t*    limits  = syslimits_new(reader);
+    metricarena_t*  arena   = metricarena_new(METRICARENA_SIZE);
+    zhashx_t*       history = linuxmetric_history_new();
+
+    auto sensors_all = [&] {
+        linuxmetric_list_t* info = linuxsensors_get_all(sensors, 30, history);
+        return metriclist_destroy(&info);
+    };
+    auto limits_all = [&] {
+        linuxmetric_list_t* info = syslimits_get_all(limits);
+        return metriclist_destroy(&info);
+    };
+    // one interval of the server over the fixture tree
+    auto tick = [&] {
+        linuxmetric_set_arena(arena);
+        linuxmetric_list_t* info  = linuxmetric_get_all(30, history, reader, true);
+        linuxmetric_list_t* other = linuxsensors_get_all(sensors, 30, history);
+        size_t    size  = metriclist_destroy(&other);
+        other           = syslimits_get_all(limits);
+        size += metriclist_destroy(&other) + metriclist_destroy(&info);
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+        return size;
+    };
+
+    BENCHMARK("linuxsensors_get_all") { return sensors_all(); };
+    BENCHMARK("syslimits_get_all") { return limits_all(); };
+    BENCHMARK("interval (linuxmetric, sensors, limits)") { return tick(); };
+
+    bench_report("linuxsensors_get_all", [&] { sensors_all(); });
+    bench_report("syslimits_get_all", [&] { limits_all(); });
+    bench_report("interval (linuxmetric, sensors, limits)", [&] { tick(); });
+
+    zhashx_destroy(&history);
+    metricarena_destroy(&arena);
+    syslimits_destroy(&limits);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("sourcereader backends", "[benchmark]")
+{
+    sourcereader_t*  reader = sourcereader_new(BENCH_DATA_DIR);
+    std::vector<int> handles;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(BENCH_DATA_DIR)) {
+        if (!entry.is_regular_file())
+            continue;
+        std::string path   = entry.path().string().substr(strlen(BENCH_DATA_DIR));
+        int         handle = sourcereader_open(reader, path.c_str());
+        if (handle >= 0)
+            handles.push_back(handle);
+    }
+    std::vector<sourcereader_value_t> values(handles.size());
+
+    auto batch = [&] {
+        for (size_t j = 0; j < handles.size(); j++) {
+            sourcereader_queue(reader, handles[j], &values[j]);
+        }
+        sourcereader_submit(reader);
+        return values[0].size;
+    };
+
+    for (sourcereader_backend_t backend : {SOURCEREADER_PREAD, SOURCEREADER_IO_URING}) {
+        if (sourcereader_set_backend(reader, backend) != backend) {
+            WARN("io_uring is not available");
+            continue;
+        }
+        std::string name = std::string(backend == SOURCEREADER_PREAD ? "pread" : "io_uring") + " batch of " +
+                           std::to_string(handles.size()) + " files";
+        BENCHMARK(name.c_str()) { return batch(); };
+        bench_report(name.c_str(), [&] { batch(); });
+    }
+    sourcereader_destroy(&reader);
+}
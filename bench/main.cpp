@@ -0,0 +1,50 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#define CATCH_CONFIG_RUNNER
+#include "results.h"
+#include <catch2/catch.hpp>
+
+//  Catch2 main with options to store the results of bench_report() as JSON
+//  and to fail when they regressed against a baseline (see results.h)
+
+int main(int argc, char* argv[])
+{
+    Catch::Session session;
+    std::string    results;
+    std::string    baseline;
+    double         threshold = 10;
+
+    using namespace Catch::clara;
+    auto cli = session.cli() | Opt(results, "file")["--results"]("write results as JSON to file") |
+               Opt(baseline, "file")["--baseline"]("compare results with file, fail on regressions") |
+               Opt(threshold, "percent")["--threshold"]("allowed regression in percent (default 10)");
+    session.cli(cli);
+    int rv = session.applyCommandLine(argc, argv);
+    if (rv != 0)
+        return rv;
+
+    rv = session.run();
+    if (!results.empty() && !bench_results_write(results.c_str(), bench_results()))
+        rv = EXIT_FAILURE;
+    if (!baseline.empty()) {
+        std::vector<bench_result_t> base;
+        bool                        same_machine;
+        if (!bench_results_load(baseline.c_str(), &base, &same_machine) ||
+            bench_results_compare(bench_results(), base, threshold, same_machine, stdout))
+            rv = EXIT_FAILURE;
+    }
+    return rv;
+}
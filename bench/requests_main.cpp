@@ -0,0 +1,244 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "src/fty_info.h"
+#include "src/fty_info_server.h"
+#include "results.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <getopt.h>
+#include <iostream>
+#include <malamute.h>
+#include <thread>
+#include <vector>
+
+//  Throughput and latency of the mailbox requests of fty-info: an in-process
+//  malamute broker and fty_info_server are started the same way as in
+//  tests/info_server.cpp and N clients, each in its own thread, send requests
+//  one after another and measure the round trip of every reply.
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "tests/selftest-ro/data/"
+#endif
+
+#define ENDPOINT      "inproc://fty-info-bench-requests"
+#define AGENT_NAME    "fty-info"
+#define REPLY_TIMEOUT 5000 // ms
+
+static void s_usage(void)
+{
+    std::cout << "fty-info-bench-requests [options]\n"
+                 "  -c|--clients N      number of concurrent clients (default 4)\n"
+                 "  -n|--requests N     requests sent by each client (default 1000)\n"
+                 "  -r|--request CMD    INFO, INFO-TEST or HW_CAP (default INFO)\n"
+                 "  --results FILE      write results as JSON to FILE\n"
+                 "  --baseline FILE     compare results with FILE, fail on regressions\n"
+                 "  --threshold PCT     allowed regression in percent (default 10)\n"
+                 "  -h|--help           print this help\n";
+}
+
+static zmsg_t* s_request(const char* command, const char* uuid)
+{
+    zmsg_t* request = zmsg_new();
+    zmsg_addstr(request, command);
+    zmsg_addstr(request, uuid);
+    if (streq(command, "HW_CAP"))
+        zmsg_addstr(request, "gpo");
+    return request;
+}
+
+//  Wait for the reply to the request uuid sent at start and return its
+//  latency (usec), or REPLY_TIMEOUT when it does not come in time. Replies
+//  to earlier requests which timed out are dropped.
+static int64_t s_wait_reply(mlm_client_t* client, zpoller_t* poller, const char* uuid, int64_t start)
+{
+    int64_t deadline = start + REPLY_TIMEOUT * 1000;
+    int64_t now;
+    while ((now = zclock_usecs()) < deadline) {
+        if (!zpoller_wait(poller, int((deadline - now + 999) / 1000)))
+            break;
+        zmsg_t* reply = mlm_client_recv(client);
+        if (!reply)
+            break;
+        int64_t end      = zclock_usecs();
+        char*   id_reply = zmsg_popstr(reply);
+        bool    matches  = id_reply && streq(id_reply, uuid);
+        zstr_free(&id_reply);
+        zmsg_destroy(&reply);
+        if (matches)
+            return end - start;
+    }
+    return int64_t(REPLY_TIMEOUT) * 1000;
+}
+
+//  Send requests and store latency of each of them (usec) into latencies,
+//  requests without a reply are stored with the latency of REPLY_TIMEOUT;
+//  return number of failed requests
+static size_t s_client(int id, const char* command, size_t requests, std::vector<int64_t>* latencies)
+{
+    char address[32];
+    snprintf(address, sizeof(address), "bench-client-%d", id);
+    mlm_client_t* client = mlm_client_new();
+    if (mlm_client_connect(client, ENDPOINT, 1000, address) != 0) {
+        mlm_client_destroy(&client);
+        return requests;
+    }
+    zpoller_t* poller = zpoller_new(mlm_client_msgpipe(client), NULL);
+
+    size_t failed = 0;
+    for (size_t i = 0; i < requests; i++) {
+        char uuid[48];
+        snprintf(uuid, sizeof(uuid), "%s-%zu", address, i);
+        zmsg_t* request = s_request(command, uuid);
+        int64_t start   = zclock_usecs();
+        mlm_client_sendto(client, AGENT_NAME, "info", NULL, 1000, &request);
+        zmsg_destroy(&request);
+
+        int64_t latency = s_wait_reply(client, poller, uuid, start);
+        if (latency >= int64_t(REPLY_TIMEOUT) * 1000)
+            failed++;
+        latencies->push_back(latency);
+    }
+
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+    return failed;
+}
+
+static int64_t s_percentile(const std::vector<int64_t>& sorted, double percentile)
+{
+    size_t rank = size_t(std::ceil(percentile / 100 * double(sorted.size())));
+    return sorted[std::min(std::max(rank, size_t(1)), sorted.size()) - 1];
+}
+
+int main(int argc, char* argv[])
+{
+    size_t      clients  = 4;
+    size_t      requests = 1000;
+    const char* command  = "INFO";
+    const char* results  = NULL;
+    const char* baseline = NULL;
+    double      threshold = 10;
+
+    static const struct option options[] = {{"clients", required_argument, NULL, 'c'},
+        {"requests", required_argument, NULL, 'n'}, {"request", required_argument, NULL, 'r'},
+        {"results", required_argument, NULL, 'R'}, {"baseline", required_argument, NULL, 'B'},
+        {"threshold", required_argument, NULL, 'T'}, {"help", no_argument, NULL, 'h'}, {NULL, 0, NULL, 0}};
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:n:r:h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'c':
+                clients = strtoul(optarg, NULL, 10);
+                break;
+            case 'n':
+                requests = strtoul(optarg, NULL, 10);
+                break;
+            case 'r':
+                command = optarg;
+                break;
+            case 'R':
+                results = optarg;
+                break;
+            case 'B':
+                baseline = optarg;
+                break;
+            case 'T':
+                threshold = strtod(optarg, NULL);
+                break;
+            case 'h':
+                s_usage();
+                return EXIT_SUCCESS;
+            default:
+                s_usage();
+                return EXIT_FAILURE;
+        }
+    }
+    if (clients == 0 || requests == 0 ||
+        !(streq(command, "INFO") || streq(command, "INFO-TEST") || streq(command, "HW_CAP"))) {
+        s_usage();
+        return EXIT_FAILURE;
+    }
+
+    zactor_t* broker = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+    zstr_sendx(broker, "BIND", ENDPOINT, NULL);
+    zactor_t* server = zactor_new(fty_info_server, const_cast<char*>(AGENT_NAME));
+    zstr_sendx(server, "TEST", NULL);
+    zstr_sendx(server, "PATH", DEFAULT_PATH, NULL);
+    zstr_sendx(server, "CONFIG", BENCH_DATA_DIR "hw_cap", NULL);
+    zstr_sendx(server, "CONNECT", ENDPOINT, NULL);
+    zclock_sleep(500);
+
+    // warm up caches of the server and the broker
+    std::vector<int64_t> warmup;
+    s_client(-1, command, 10, &warmup);
+
+    std::vector<std::vector<int64_t>> latencies(clients);
+    std::vector<size_t>               failed(clients, 0);
+    std::vector<std::thread>          threads;
+    int64_t                           start = zclock_usecs();
+    for (size_t i = 0; i < clients; i++) {
+        threads.emplace_back([&, i] {
+            latencies[i].reserve(requests);
+            failed[i] = s_client(int(i), command, requests, &latencies[i]);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int64_t duration = zclock_usecs() - start;
+
+    std::vector<int64_t> all;
+    size_t               all_failed = 0;
+    for (size_t i = 0; i < latencies.size(); i++) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        all_failed += failed[i];
+    }
+    std::sort(all.begin(), all.end());
+
+    printf("%s: %zu clients x %zu requests in %.3lf s, %zu failed\n", command, clients, requests,
+        double(duration) / 1000000, all_failed);
+    // timed out requests are at the end of the latencies with REPLY_TIMEOUT
+    size_t answered = size_t(std::lower_bound(all.begin(), all.end(), int64_t(REPLY_TIMEOUT) * 1000) - all.begin());
+    if (answered > 0) {
+        printf("throughput: %.1lf requests/s\n", double(answered) * 1000000 / double(duration));
+        printf("latency: p50 %" PRId64 " us, p99 %" PRId64 " us, p999 %" PRId64 " us, max %" PRId64 " us\n",
+            s_percentile(all, 50), s_percentile(all, 99), s_percentile(all, 99.9), all.back());
+
+        char name[64];
+        snprintf(name, sizeof(name), "request_%s (%zu clients)", command, clients);
+        bench_result_t result = bench_result(name);
+        result.ns_per_op      = double(duration) * 1000 / double(answered);
+        result.p50_us         = double(s_percentile(all, 50));
+        result.p99_us         = double(s_percentile(all, 99));
+        result.p999_us        = double(s_percentile(all, 99.9));
+        bench_result_add(result);
+    }
+
+    zactor_destroy(&server);
+    zactor_destroy(&broker);
+
+    int rv = all_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (results && !bench_results_write(results, bench_results()))
+        rv = EXIT_FAILURE;
+    if (baseline) {
+        std::vector<bench_result_t> base;
+        bool                        same_machine;
+        if (!bench_results_load(baseline, &base, &same_machine) ||
+            bench_results_compare(bench_results(), base, threshold, same_machine, stdout))
+            rv = EXIT_FAILURE;
+    }
+    return rv;
+}
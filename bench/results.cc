@@ -0,0 +1,263 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "results.h"
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <cstring>
+#include <cxxtools/jsondeserializer.h>
+#include <fstream>
+#include <limits>
+#include <sys/utsname.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifndef BENCH_GIT_SHA
+#define BENCH_GIT_SHA "unknown"
+#endif
+
+static std::vector<bench_result_t> s_results;
+
+static void s_print_string(FILE* file, const char* key, const std::string& value)
+{
+    fprintf(file, "\"%s\": \"", key);
+    for (char c : value) {
+        if (c == '"' || c == '\\')
+            fprintf(file, "\\%c", c);
+        else if (static_cast<unsigned char>(c) >= 0x20)
+            fputc(c, file);
+    }
+    fputc('"', file);
+}
+
+static void s_print_value(FILE* file, const char* key, double value)
+{
+    if (std::isfinite(value))
+        fprintf(file, ", \"%s\": %.10g", key, value);
+}
+
+//  Return value of "key : value" line of /proc file
+static std::string s_proc_value(const char* path, const char* key)
+{
+    std::ifstream file(path);
+    std::string   line;
+    size_t        length = strlen(key);
+    while (std::getline(file, line)) {
+        if (line.compare(0, length, key) == 0) {
+            size_t colon = line.find(':');
+            size_t start = line.find_first_not_of(" \t", colon + 1);
+            if (colon != std::string::npos && start != std::string::npos)
+                return line.substr(start);
+        }
+    }
+    return "";
+}
+
+//  Store hostname, CPU model and number of CPUs of this machine, timing is
+//  only comparable between results measured on the same one
+static void s_machine(std::string* hostname, std::string* cpu, long* cpus)
+{
+    struct utsname system;
+    uname(&system);
+    *hostname = system.nodename;
+    *cpu      = s_proc_value("/proc/cpuinfo", "model name");
+    *cpus     = sysconf(_SC_NPROCESSORS_ONLN);
+}
+
+static double s_member(const cxxtools::SerializationInfo& si, const char* name)
+{
+    double                             value  = std::numeric_limits<double>::quiet_NaN();
+    const cxxtools::SerializationInfo* member = si.findMember(name);
+    if (member)
+        *member >>= value;
+    return value;
+}
+
+//  Is value worse than base by more than threshold percent?
+static bool s_regressed(double value, double base, double threshold)
+{
+    if (!std::isfinite(value) || !std::isfinite(base))
+        return false;
+    if (base == 0)
+        return value > 0;
+    return value > base * (1 + threshold / 100);
+}
+
+//  --------------------------------------------------------------------------
+//  Return empty result
+
+bench_result_t bench_result(const std::string& name)
+{
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    return bench_result_t{name, nan, nan, nan, nan, nan, nan};
+}
+
+//  --------------------------------------------------------------------------
+//  Add result to the results of this run
+
+void bench_result_add(const bench_result_t& result)
+{
+    s_results.push_back(result);
+}
+
+//  --------------------------------------------------------------------------
+//  Return results of this run
+
+const std::vector<bench_result_t>& bench_results(void)
+{
+    return s_results;
+}
+
+//  --------------------------------------------------------------------------
+//  Write results to path
+
+bool bench_results_write(const char* path, const std::vector<bench_result_t>& results)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Could not write %s: %m\n", path);
+        return false;
+    }
+
+    char   date[32];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    struct utsname system;
+    uname(&system);
+    std::string hostname, cpu;
+    long        cpus;
+    s_machine(&hostname, &cpu, &cpus);
+
+    fprintf(file, "{\n  ");
+    s_print_string(file, "git_sha", BENCH_GIT_SHA);
+    fprintf(file, ",\n  ");
+    s_print_string(file, "date", date);
+    fprintf(file, ",\n  \"machine\": {");
+    s_print_string(file, "hostname", hostname);
+    fprintf(file, ", ");
+    s_print_string(file, "kernel", system.release);
+    fprintf(file, ", ");
+    s_print_string(file, "arch", system.machine);
+    fprintf(file, ", ");
+    s_print_string(file, "cpu", cpu);
+    fprintf(file, ", \"cpus\": %ld, \"memory_kb\": %s},\n  \"results\": [", cpus,
+        std::to_string(atol(s_proc_value("/proc/meminfo", "MemTotal").c_str())).c_str());
+    for (size_t i = 0; i < results.size(); i++) {
+        const bench_result_t& result = results[i];
+        fprintf(file, "%s\n    {", i ? "," : "");
+        s_print_string(file, "name", result.name);
+        s_print_value(file, "ns_per_op", result.ns_per_op);
+        s_print_value(file, "allocations_per_op", result.allocations_per_op);
+        s_print_value(file, "syscalls_per_op", result.syscalls_per_op);
+        s_print_value(file, "p50_us", result.p50_us);
+        s_print_value(file, "p99_us", result.p99_us);
+        s_print_value(file, "p999_us", result.p999_us);
+        fputc('}', file);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+//  --------------------------------------------------------------------------
+//  Load results from path
+
+bool bench_results_load(const char* path, std::vector<bench_result_t>* results, bool* same_machine)
+{
+    assert(results);
+    if (same_machine)
+        *same_machine = false;
+    try {
+        std::ifstream               file(path);
+        if (!file) {
+            fprintf(stderr, "Could not read %s\n", path);
+            return false;
+        }
+        cxxtools::SerializationInfo si;
+        cxxtools::JsonDeserializer  json(file);
+        json.deserialize(si);
+        const cxxtools::SerializationInfo& list    = si.getMember("results");
+        const cxxtools::SerializationInfo* machine = si.findMember("machine");
+        if (same_machine && machine) {
+            std::string hostname, cpu, base_hostname, base_cpu;
+            long        cpus;
+            s_machine(&hostname, &cpu, &cpus);
+            double base_cpus = s_member(*machine, "cpus");
+            if (machine->findMember("hostname"))
+                machine->getMember("hostname") >>= base_hostname;
+            if (machine->findMember("cpu"))
+                machine->getMember("cpu") >>= base_cpu;
+            *same_machine = base_hostname == hostname && base_cpu == cpu && base_cpus == double(cpus);
+        }
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            std::string name;
+            it->getMember("name") >>= name;
+            bench_result_t result     = bench_result(name);
+            result.ns_per_op          = s_member(*it, "ns_per_op");
+            result.allocations_per_op = s_member(*it, "allocations_per_op");
+            result.syscalls_per_op    = s_member(*it, "syscalls_per_op");
+            result.p50_us             = s_member(*it, "p50_us");
+            result.p99_us             = s_member(*it, "p99_us");
+            result.p999_us            = s_member(*it, "p999_us");
+            results->push_back(result);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Could not parse %s: %s\n", path, e.what());
+        return false;
+    }
+    return true;
+}
+
+//  --------------------------------------------------------------------------
+//  Compare results with baseline
+
+size_t bench_results_compare(const std::vector<bench_result_t>& results, const std::vector<bench_result_t>& baseline,
+    double threshold, bool timing, FILE* output)
+{
+    size_t regressions = 0;
+    if (!timing)
+        fprintf(output, "baseline is from another machine, ns/op and p99 latency are not compared\n");
+    for (const bench_result_t& base : baseline) {
+        auto result = std::find_if(results.begin(), results.end(), [&](const bench_result_t& item) {
+            return item.name == base.name;
+        });
+        if (result == results.end()) {
+            fprintf(output, "%-56s not run\n", base.name.c_str());
+            continue;
+        }
+
+        const struct
+        {
+            const char* unit;
+            double      value;
+            double      base;
+            bool        timing; // depends on the machine
+        } values[] = {{"ns/op", result->ns_per_op, base.ns_per_op, true},
+            {"allocations/op", result->allocations_per_op, base.allocations_per_op, false},
+            {"syscalls/op", result->syscalls_per_op, base.syscalls_per_op, false},
+            {"us p99", result->p99_us, base.p99_us, true}};
+        for (const auto& value : values) {
+            if (!std::isfinite(value.value) || !std::isfinite(value.base) || (value.timing && !timing))
+                continue;
+            bool regressed = s_regressed(value.value, value.base, threshold);
+            regressions += regressed;
+            fprintf(output, "%-56s %14.1lf %-14s baseline %14.1lf %+7.1lf%%%s\n", base.name.c_str(), value.value,
+                value.unit, value.base, value.base != 0 ? 100 * (value.value - value.base) / value.base : 0.0,
+                regressed ? "  REGRESSION" : "");
+        }
+    }
+    fprintf(output, "%zu regressions over %.1lf%%\n", regressions, threshold);
+    return regressions;
+}
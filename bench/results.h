@@ -0,0 +1,68 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#pragma once
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+//  Benchmark results stored as JSON together with the git SHA and the
+//  machine they were measured on, and their comparison with a baseline:
+//
+//  {
+//    "git_sha": "39a3d51", "date": "2026-10-19T10:00:00Z",
+//    "machine": {"hostname": "...", "kernel": "...", "arch": "x86_64",
+//                "cpu": "...", "cpus": 8, "memory_kb": 16318480},
+//    "results": [{"name": "linuxmetric_get_all", "ns_per_op": 41250.5,
+//                 "allocations_per_op": 630, "syscalls_per_op": 82}, ...]
+//  }
+//
+//  Values which were not measured are NaN and are left out of the file.
+
+typedef struct
+{
+    std::string name;
+    double      ns_per_op;
+    double      allocations_per_op;
+    double      syscalls_per_op;
+    double      p50_us;
+    double      p99_us;
+    double      p999_us;
+} bench_result_t;
+
+//  Return result named name with all values NaN
+bench_result_t bench_result(const std::string& name);
+
+//  Add result to the results of this run
+void bench_result_add(const bench_result_t& result);
+
+//  Return results of this run
+const std::vector<bench_result_t>& bench_results(void);
+
+//  Write results with git SHA and machine info to path, return false on error
+bool bench_results_write(const char* path, const std::vector<bench_result_t>& results);
+
+//  Load results from path written by bench_results_write, return false on
+//  error. If same_machine is given, store whether the results were measured
+//  on this machine (same hostname, CPU model and number of CPUs).
+bool bench_results_load(const char* path, std::vector<bench_result_t>* results, bool* same_machine = nullptr);
+
+//  Compare allocations/op and syscalls/op and, with timing, ns/op and p99
+//  latency of results with the results of the same name in baseline, print
+//  the comparison to output and return the number of values worse than
+//  baseline by more than threshold percent. Timing is only meaningful when
+//  the baseline was measured on the same machine.
+size_t bench_results_compare(const std::vector<bench_result_t>& results, const std::vector<bench_result_t>& baseline,
+    double threshold, bool timing, FILE* output);
@@ -0,0 +1,66 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "bench/counters.h"
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/sourcereader.h"
+#include "tests/fixturegen.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+
+#define SCALE_DIR "fixturegen-bench/"
+
+// Cost of one interval of linuxmetric and linuxsensors over generated trees
+// of growing interface and CPU count
+TEST_CASE("scale", "[benchmark]")
+{
+    for (size_t scale : {1, 10, 100, 1000}) {
+        fixturegen_config_t config = {};
+        config.interfaces          = scale;
+        config.cpus                = scale < 128 ? scale : 128;
+        config.thermal_zones       = scale < 64 ? scale : 64;
+        fixturegen_t* fixture      = fixturegen_new(SCALE_DIR, config);
+
+        sourcereader_t* reader  = sourcereader_new(SCALE_DIR);
+        linuxsensors_t* sensors = linuxsensors_new(reader);
+        zhashx_t*       history = linuxmetric_history_new();
+        zhashx_insert(history, HIST_CPU_NUMERATOR, zmalloc(sizeof(double)));
+        zhashx_insert(history, HIST_CPU_DENOMINATOR, zmalloc(sizeof(double)));
+
+        auto get_all = [&] {
+            linuxmetric_list_t* info = linuxmetric_get_all(30, history, reader, true);
+            return metriclist_destroy(&info);
+        };
+        auto sensors_all = [&] {
+            linuxmetric_list_t* info = linuxsensors_get_all(sensors, 30, history);
+            return metriclist_destroy(&info);
+        };
+
+        std::string suffix = " (" + std::to_string(config.interfaces) + " interfaces, " +
+                             std::to_string(config.cpus) + " CPUs)";
+        BENCHMARK(("linuxmetric_get_all" + suffix).c_str()) { return get_all(); };
+        BENCHMARK(("linuxsensors_get_all" + suffix).c_str()) { return sensors_all(); };
+        bench_report(("linuxmetric_get_all" + suffix).c_str(), [&] { get_all(); }, 100);
+        bench_report(("linuxsensors_get_all" + suffix).c_str(), [&] { sensors_all(); }, 100);
+
+        zhashx_destroy(&history);
+        linuxsensors_destroy(&sensors);
+        sourcereader_destroy(&reader);
+        fixturegen_remove(fixture);
+        fixturegen_destroy(&fixture);
+    }
+}
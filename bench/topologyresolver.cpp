@@ -0,0 +1,43 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "bench/counters.h"
+#include "src/topologyresolver.h"
+#include "tests/assetgen.h"
+#include <catch2/catch.hpp>
+
+// REPUBLISH of a data center through a fresh resolver (no asset agent), per
+// whole stream; divide by the number of assets for the cost of one message
+TEST_CASE("topologyresolver", "[benchmark]")
+{
+    for (size_t size : {10000, 100000}) {
+        std::vector<fty_proto_t*> assets = assetgen_datacenter(size, "rackcontroller-0", 42);
+
+        auto stream = [&] {
+            topologyresolver_t* resolver  = topologyresolver_new("rackcontroller-0");
+            size_t              announces = 0;
+            for (fty_proto_t* asset : assets) {
+                announces += topologyresolver_asset(resolver, asset);
+            }
+            topologyresolver_destroy(&resolver);
+            return announces;
+        };
+
+        std::string name = "topologyresolver_asset stream of " + std::to_string(size) + " assets";
+        BENCHMARK(name.c_str()) { return stream(); };
+        bench_report(name.c_str(), [&] { stream(); }, 3);
+        assetgen_destroy(assets);
+    }
+}
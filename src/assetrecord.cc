@@ -0,0 +1,192 @@
+/*  =========================================================================
+    assetrecord - File of recorded ASSETS stream messages
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    assetrecord - File of recorded ASSETS stream messages
+@discuss
+    The behaviour of the topology resolver and of the announces depends on
+    the shape and order of asset messages. A recording keeps them, so that
+    they can be replayed into topologyresolver_asset or a local broker.
+
+    File format (native byte order, it is not meant to be moved across
+    architectures):
+        "FTYASSET" magic
+        records:
+            int64_t  timestamp  - usec since the recording started
+            uint32_t size       - size of the frame
+            byte[]   frame      - zmsg_encode of fty_proto_encode output
+@end
+*/
+
+#include "assetrecord.h"
+#include <fty_log.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAGIC      "FTYASSET"
+#define MAGIC_SIZE 8
+#define MAX_FRAME  (16 * 1024 * 1024)
+
+//  Structure of our class
+
+struct _assetrecord_t
+{
+    FILE*  file;
+    size_t size;
+    bool   corrupted; // replay stops at a corrupted record
+};
+
+//  --------------------------------------------------------------------------
+//  Create a new assetrecord
+
+assetrecord_t* assetrecord_new(const char* path, bool write)
+{
+    assert(path);
+    FILE* file = fopen(path, write ? "wb" : "rb");
+    if (!file) {
+        log_error("Could not open '%s': %m", path);
+        return NULL;
+    }
+    if (write) {
+        if (fwrite(MAGIC, 1, MAGIC_SIZE, file) != MAGIC_SIZE) {
+            log_error("Could not write '%s'", path);
+            fclose(file);
+            return NULL;
+        }
+    } else {
+        char magic[MAGIC_SIZE];
+        if (fread(magic, 1, MAGIC_SIZE, file) != MAGIC_SIZE || memcmp(magic, MAGIC, MAGIC_SIZE) != 0) {
+            log_error("'%s' is not a recording of assets", path);
+            fclose(file);
+            return NULL;
+        }
+    }
+
+    assetrecord_t* self = static_cast<assetrecord_t*>(zmalloc(sizeof(assetrecord_t)));
+    assert(self);
+    //  Initialize class properties here
+    self->file      = file;
+    self->size      = 0;
+    self->corrupted = false;
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the assetrecord
+
+void assetrecord_destroy(assetrecord_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        assetrecord_t* self = *self_p;
+        //  Free class properties here
+        fclose(self->file);
+        //  Free object itself
+        free(self);
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Append message to the recording
+
+int assetrecord_write(assetrecord_t* self, int64_t timestamp, fty_proto_t* message)
+{
+    assert(self);
+    assert(message);
+    fty_proto_t* copy  = fty_proto_dup(message);
+    zmsg_t*      msg   = fty_proto_encode(&copy);
+    zframe_t*    frame = msg ? zmsg_encode(msg) : NULL;
+    zmsg_destroy(&msg);
+    if (!frame)
+        return -1;
+
+    uint32_t size = uint32_t(zframe_size(frame));
+    int      r    = 0;
+    if (fwrite(&timestamp, sizeof(timestamp), 1, self->file) != 1 || fwrite(&size, sizeof(size), 1, self->file) != 1 ||
+        fwrite(zframe_data(frame), 1, size, self->file) != size) {
+        log_error("Could not write asset message to the recording");
+        r = -1;
+    } else
+        self->size++;
+    zframe_destroy(&frame);
+    return r;
+}
+
+//  --------------------------------------------------------------------------
+//  Return the next message of the recording
+
+fty_proto_t* assetrecord_read(assetrecord_t* self, int64_t* timestamp)
+{
+    assert(self);
+    assert(timestamp);
+    if (self->corrupted)
+        return NULL;
+    // records are numbered from 1, all before this one were read
+    size_t number = self->size + 1;
+
+    char   header[sizeof(*timestamp) + sizeof(uint32_t)];
+    size_t read = fread(header, 1, sizeof(header), self->file);
+    if (read == 0 && feof(self->file))
+        return NULL;
+    if (read != sizeof(header)) {
+        log_error("Corrupted recording, record %zu is truncated", number);
+        self->corrupted = true;
+        return NULL;
+    }
+    uint32_t size;
+    memcpy(timestamp, header, sizeof(*timestamp));
+    memcpy(&size, header + sizeof(*timestamp), sizeof(size));
+    if (size > MAX_FRAME) {
+        log_error("Corrupted recording, record %zu has %u bytes", number, size);
+        self->corrupted = true;
+        return NULL;
+    }
+
+    zframe_t* frame = zframe_new(NULL, size);
+    if (fread(zframe_data(frame), 1, size, self->file) != size) {
+        log_error("Corrupted recording, record %zu is truncated", number);
+        zframe_destroy(&frame);
+        self->corrupted = true;
+        return NULL;
+    }
+    zmsg_t* msg = zmsg_decode(frame);
+    zframe_destroy(&frame);
+    fty_proto_t* message = msg ? fty_proto_decode(&msg) : NULL;
+    zmsg_destroy(&msg);
+    if (!message) {
+        log_error("Corrupted recording, record %zu is not fty_proto", number);
+        self->corrupted = true;
+        return NULL;
+    }
+    self->size++;
+    return message;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of messages written or read so far
+
+size_t assetrecord_size(assetrecord_t* self)
+{
+    assert(self);
+    return self->size;
+}
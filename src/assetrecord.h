@@ -0,0 +1,46 @@
+/*  =========================================================================
+    assetrecord - File of recorded ASSETS stream messages
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include <fty_proto.h>
+
+typedef struct _assetrecord_t assetrecord_t;
+
+//  Open file at path for recording (write = true, the file is truncated) or
+//  for replay. Returns NULL if the file can't be opened or is not a recording.
+assetrecord_t* assetrecord_new(const char* path, bool write);
+
+//  Destroy the assetrecord, closing its file
+void assetrecord_destroy(assetrecord_t** self_p);
+
+//  Append message received timestamp microseconds after the recording
+//  started. Message is encoded as received, the caller keeps its ownership.
+//  Returns 0 on success, -1 on error.
+int assetrecord_write(assetrecord_t* self, int64_t timestamp, fty_proto_t* message);
+
+//  Return the next message of the recording and store the time it was
+//  received at into timestamp, or NULL at the end of the recording (or on a
+//  corrupted record, which is logged with its number counted from 1; the
+//  replay ends there). Caller destroys the message.
+fty_proto_t* assetrecord_read(assetrecord_t* self, int64_t* timestamp);
+
+//  Return number of messages written or read so far
+size_t assetrecord_size(assetrecord_t* self);
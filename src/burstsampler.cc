@@ -0,0 +1,341 @@
+/*  =========================================================================
+    burstsampler - Class for detecting sub-second traffic bursts
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    burstsampler - Class for detecting sub-second traffic bursts
+@discuss
+    Average bandwidth over the publish interval hides bursts which saturate
+    a link for a few hundred milliseconds. The sampler reads only rx_bytes and
+    tx_bytes of selected interfaces, through fds kept open by the
+    sourcereader, every period (100 ms by default). All counters of a sample
+    are read in one sourcereader batch without allocation, so it can run all
+    the time.
+
+    For every publish window it reports the peak rate over one sample period,
+    the peak rate over a sliding 1 s window and the number of samples above
+    the utilization threshold (only if the link speed is known). The link
+    speed is read again whenever carrier_changes of the interface moves, so
+    a link that comes up later or renegotiates its speed is accounted for.
+
+    Samples are taken on the thread of the caller. When it was busy and a
+    sample comes more than two periods after the previous one, the sample is
+    a gap: its rate is not one over a sample period, so no rate is computed,
+    the 1 s window starts over from it and the gap is counted in infostats.
+    The period is at most 1 s, so that the ring holds the 1 s window.
+@end
+*/
+
+#include "burstsampler.h"
+#include "infostats.h"
+#include "linuxmetric.h"
+#include <cinttypes>
+#include <cmath>
+#include <fty_log.h>
+#include <limits>
+#include <vector>
+
+//  One sample of a byte counter
+
+typedef struct
+{
+    int64_t time;
+    double  bytes;
+} burstsample_t;
+
+//  Link state of one interface
+
+typedef struct
+{
+    std::string          interface;
+    int                  handle; // carrier_changes, -1 if not available
+    sourcereader_value_t value;
+    double               carrier_changes;
+    double               capacity; // link speed in Bps, 0 if unknown
+} burstlink_t;
+
+//  Byte counter of one direction of one interface
+
+typedef struct
+{
+    std::string                interface;
+    const char*                direction;
+    int                        handle;
+    sourcereader_value_t       value;
+    size_t                     link;     // index in links
+    std::vector<burstsample_t> ring;     // samples of the last second
+    size_t                     head;     // next slot to write
+    size_t                     count;    // valid samples in ring
+    double                     peak_sample;
+    double                     peak_1s;
+    size_t                     bursts;
+} burstcounter_t;
+
+//  Structure of our class
+
+struct _burstsampler_t
+{
+    sourcereader_t*             reader;
+    int                         period_ms;
+    double                      threshold;
+    int64_t                     next;
+    int64_t                     last; // time of the last sample, -1 before the first one
+    std::vector<burstlink_t>    links;
+    std::vector<burstcounter_t> counters;
+};
+
+static void s_reset_window(burstcounter_t& counter)
+{
+    counter.peak_sample = std::numeric_limits<double>::quiet_NaN();
+    counter.peak_1s     = std::numeric_limits<double>::quiet_NaN();
+    counter.bursts      = 0;
+}
+
+static double s_capacity(burstsampler_t* self, const std::string& interface)
+{
+    char        buf[32];
+    std::string path = "sys/class/net/" + interface + "/speed";
+    // speed in Mbps, -1 or unreadable without carrier or for virtual interfaces
+    if (sourcereader_read_once(self->reader, path.c_str(), buf, sizeof(buf)) > 0 && atof(buf) > 0)
+        return atof(buf) * 1000 * 1000 / 8;
+    return 0;
+}
+
+static void s_add_counters(burstsampler_t* self, const std::string& interface)
+{
+    std::string dir = "sys/class/net/" + interface + "/";
+    burstlink_t link;
+    link.interface       = interface;
+    link.handle          = sourcereader_open(self->reader, (dir + "carrier_changes").c_str());
+    link.carrier_changes = 0;
+    link.capacity        = s_capacity(self, interface);
+    link.value.size      = 0;
+    if (link.handle >= 0) {
+        link.value.size = sourcereader_read(self->reader, link.handle, link.value.data, sizeof(link.value.data));
+        if (link.value.size > 0)
+            link.carrier_changes = strtod(link.value.data, NULL);
+    }
+    size_t index = self->links.size();
+    bool   used  = false;
+
+    for (const char* direction : {"rx", "tx"}) {
+        std::string    path = dir + "statistics/" + direction + "_bytes";
+        burstcounter_t counter;
+        counter.handle = sourcereader_open(self->reader, path.c_str());
+        if (counter.handle < 0) {
+            log_warning("burstsampler: can't sample '%s'", path.c_str());
+            continue;
+        }
+        counter.interface = interface;
+        counter.direction = direction;
+        counter.link      = index;
+        // the oldest sample in a full ring is one second old
+        counter.ring.resize(size_t(1000 / self->period_ms) + 1);
+        counter.head  = 0;
+        counter.count = 0;
+        s_reset_window(counter);
+        self->counters.push_back(counter);
+        used = true;
+    }
+    if (used)
+        self->links.push_back(link);
+    else
+        sourcereader_close(self->reader, link.handle);
+}
+
+static void s_check_link(burstsampler_t* self, burstlink_t& link)
+{
+    if (link.handle < 0 || link.value.size <= 0)
+        return;
+    double carrier_changes = strtod(link.value.data, NULL);
+    if (carrier_changes != link.carrier_changes) {
+        // link went down or up, speed may have been renegotiated
+        link.carrier_changes = carrier_changes;
+        link.capacity        = s_capacity(self, link.interface);
+        log_debug("burstsampler: link of %s changed, capacity %.0lf Bps", link.interface.c_str(), link.capacity);
+    }
+}
+
+static void s_sample(burstsampler_t* self, burstcounter_t& counter, int64_t now)
+{
+    if (counter.value.size <= 0)
+        return;
+    double bytes = strtod(counter.value.data, NULL);
+
+    if (counter.count > 0) {
+        const burstsample_t& last = counter.ring[(counter.head + counter.ring.size() - 1) % counter.ring.size()];
+        if (bytes < last.bytes) {
+            // counter reset (e.g. driver reload), start over
+            counter.count = 0;
+        } else if (now > last.time) {
+            double rate = (bytes - last.bytes) * 1000 / double(now - last.time);
+            if (std::isnan(counter.peak_sample) || rate > counter.peak_sample)
+                counter.peak_sample = rate;
+            double capacity = self->links[counter.link].capacity;
+            if (capacity > 0 && 100 * rate / capacity > self->threshold)
+                counter.bursts++;
+        }
+    }
+    if (counter.count == counter.ring.size()) {
+        // slot to overwrite holds the oldest sample
+        const burstsample_t& oldest = counter.ring[counter.head];
+        if (now > oldest.time) {
+            double rate = (bytes - oldest.bytes) * 1000 / double(now - oldest.time);
+            if (std::isnan(counter.peak_1s) || rate > counter.peak_1s)
+                counter.peak_1s = rate;
+        }
+    }
+
+    counter.ring[counter.head] = {now, bytes};
+    counter.head               = (counter.head + 1) % counter.ring.size();
+    if (counter.count < counter.ring.size())
+        counter.count++;
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new burstsampler
+
+burstsampler_t* burstsampler_new(sourcereader_t* reader, const char* interfaces, int period_ms, double threshold)
+{
+    assert(reader);
+    assert(interfaces);
+    burstsampler_t* self = new burstsampler_t;
+    assert(self);
+    //  Initialize class properties here
+    self->reader    = reader;
+    self->period_ms = period_ms > 0 ? period_ms : DEFAULT_BURST_PERIOD_MS;
+    self->threshold = threshold;
+    self->next      = 0; // first sample right away
+    self->last      = -1;
+    if (self->period_ms > 1000) {
+        log_error(
+            "burstsampler: period %d ms is longer than 1 s, using %d ms", self->period_ms, DEFAULT_BURST_PERIOD_MS);
+        self->period_ms = DEFAULT_BURST_PERIOD_MS;
+    }
+
+    std::string list(interfaces);
+    size_t      start = 0;
+    while (start < list.size()) {
+        size_t end = list.find_first_of(", ", start);
+        if (end == std::string::npos)
+            end = list.size();
+        if (end > start)
+            s_add_counters(self, list.substr(start, end - start));
+        start = end + 1;
+    }
+    log_debug("burstsampler: sampling %zu counters every %d ms", self->counters.size(), self->period_ms);
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the burstsampler
+
+void burstsampler_destroy(burstsampler_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        burstsampler_t* self = *self_p;
+        //  Free class properties here
+        for (auto& counter : self->counters) {
+            sourcereader_close(self->reader, counter.handle);
+        }
+        for (auto& link : self->links) {
+            sourcereader_close(self->reader, link.handle);
+        }
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return time of the next sample
+
+int64_t burstsampler_next(burstsampler_t* self)
+{
+    assert(self);
+    return self->next;
+}
+
+//  --------------------------------------------------------------------------
+//  Read byte counters of all interfaces
+
+void burstsampler_sample(burstsampler_t* self, int64_t now)
+{
+    assert(self);
+    for (auto& link : self->links) {
+        if (link.handle >= 0)
+            sourcereader_queue(self->reader, link.handle, &link.value);
+    }
+    for (auto& counter : self->counters) {
+        sourcereader_queue(self->reader, counter.handle, &counter.value);
+    }
+    sourcereader_submit(self->reader);
+    for (auto& link : self->links) {
+        s_check_link(self, link);
+    }
+    bool gap = self->last >= 0 && now - self->last > 2 * int64_t(self->period_ms);
+    if (gap) {
+        log_debug("burstsampler: %" PRId64 " ms since the last sample", now - self->last);
+        infostats_add(INFOSTATS_BURST_GAP);
+    }
+    for (auto& counter : self->counters) {
+        // samples before the gap are not one period or one window away
+        if (gap)
+            counter.count = 0;
+        s_sample(self, counter, now);
+    }
+    self->last = now;
+    self->next += self->period_ms;
+    // don't try to catch up missed samples
+    if (self->next <= now)
+        self->next = now + self->period_ms;
+}
+
+//  --------------------------------------------------------------------------
+//  Return peaks and bursts of the publish window and start a new one
+
+linuxmetric_list_t* burstsampler_get_all(burstsampler_t* self)
+{
+    assert(self);
+    linuxmetric_list_t* info = linuxmetric_list_new();
+    for (auto& counter : self->counters) {
+        const char* direction = counter.direction;
+        const char* interface = counter.interface.c_str();
+        if (!std::isnan(counter.peak_sample))
+            linuxmetric_add(info, round(counter.peak_sample), "Bps", PEAK_BANDWIDTH_SAMPLE_TEMPLATE, direction, interface);
+        if (!std::isnan(counter.peak_1s))
+            linuxmetric_add(info, round(counter.peak_1s), "Bps", PEAK_BANDWIDTH_1S_TEMPLATE, direction, interface);
+        if (self->links[counter.link].capacity > 0)
+            linuxmetric_add(info, double(counter.bursts), "sample", BURSTS_TEMPLATE, direction, interface);
+        s_reset_window(counter);
+    }
+    return info;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of sampled counters
+
+size_t burstsampler_size(burstsampler_t* self)
+{
+    assert(self);
+    return self->counters.size();
+}
@@ -0,0 +1,55 @@
+/*  =========================================================================
+    burstsampler - Class for detecting sub-second traffic bursts
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include "sourcereader.h"
+#include <czmq.h>
+
+#define PEAK_BANDWIDTH_SAMPLE_TEMPLATE "%s_peak_bandwidth_sample.%s"
+#define PEAK_BANDWIDTH_1S_TEMPLATE     "%s_peak_bandwidth_1s.%s"
+#define BURSTS_TEMPLATE                "%s_bursts.%s"
+
+#define DEFAULT_BURST_PERIOD_MS 100
+#define DEFAULT_BURST_THRESHOLD 80
+
+typedef struct _burstsampler_t burstsampler_t;
+
+//  Create a new burstsampler reading byte counters of interfaces (separated by
+//  ',' or ' ') through reader every period_ms. Samples with utilization above
+//  threshold (%) of the link speed are counted as bursts.
+burstsampler_t* burstsampler_new(sourcereader_t* reader, const char* interfaces, int period_ms, double threshold);
+
+//  Destroy the burstsampler
+void burstsampler_destroy(burstsampler_t** self_p);
+
+//  Return zclock_mono() time of the next sample
+int64_t burstsampler_next(burstsampler_t* self);
+
+//  Read byte counters of all interfaces, now is zclock_mono() time
+void burstsampler_sample(burstsampler_t* self, int64_t now);
+
+//  Return list of metrics with peaks and burst counts seen since the
+//  previous call and start a new publish window
+linuxmetric_list_t* burstsampler_get_all(burstsampler_t* self);
+
+//  Return number of sampled counters
+size_t burstsampler_size(burstsampler_t* self);
@@ -0,0 +1,162 @@
+/*  =========================================================================
+    collectonce - Run the collectors without malamute, for profiling
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    collectonce - Run the collectors without malamute, for profiling
+@discuss
+    fty-info --collect-once runs linuxmetric, linuxsensors and syslimits over
+    a root dir in a loop and exits, so the collectors can be profiled with
+    perf, heaptrack or callgrind on a developer box or on the device itself
+    without a running malamute broker and shm. Each iteration allocates its
+    metrics from an arena, like an interval of the server.
+@end
+*/
+
+#include "collectonce.h"
+#include "ftyinfo.h"
+#include "linuxmetric.h"
+#include "linuxsensors.h"
+#include "metricarena.h"
+#include "sourcereader.h"
+#include "syslimits.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <vector>
+
+static void s_print_json_string(FILE* output, const char* string)
+{
+    fputc('"', output);
+    for (const char* c = string; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fprintf(output, "\\%c", *c);
+        else if (static_cast<unsigned char>(*c) < 0x20)
+            fprintf(output, "\\u%04x", *c);
+        else
+            fputc(*c, output);
+    }
+    fputc('"', output);
+}
+
+static void s_print_metrics(FILE* output, linuxmetric_list_t* info, bool json)
+{
+    if (json)
+        fprintf(output, "{\"metrics\":[");
+    const char*    separator = "";
+    linuxmetric_t* metric    = linuxmetric_list_first(info);
+    while (metric) {
+        if (json) {
+            fprintf(output, "%s{\"type\":", separator);
+            s_print_json_string(output, metric->type);
+            if (std::isfinite(metric->value))
+                fprintf(output, ",\"value\":%.17g,\"unit\":", metric->value);
+            else
+                fprintf(output, ",\"value\":null,\"unit\":");
+            s_print_json_string(output, metric->unit ? metric->unit : "");
+            fputc('}', output);
+            separator = ",";
+        } else
+            fprintf(output, "%-40s %16.3lf %s\n", metric->type, metric->value, metric->unit ? metric->unit : "");
+        metric = linuxmetric_list_next(info);
+    }
+    if (json)
+        fputc(']', output);
+}
+
+//  durations are in microseconds
+static void s_print_timing(FILE* output, std::vector<int64_t>& durations, size_t metrics, bool json)
+{
+    std::sort(durations.begin(), durations.end());
+    double sum = 0;
+    for (int64_t duration : durations) {
+        sum += double(duration);
+    }
+    size_t  n    = durations.size();
+    double  mean = sum / double(n);
+    int64_t p50  = durations[(n - 1) / 2];
+    int64_t p95  = durations[size_t(std::ceil(0.95 * double(n))) - 1];
+    if (json)
+        fprintf(output,
+            ",\"timing\":{\"iterations\":%zu,\"metrics\":%zu,\"min_us\":%" PRId64 ",\"mean_us\":%.1lf,\"p50_us\":%" PRId64
+            ",\"p95_us\":%" PRId64 ",\"max_us\":%" PRId64 "}",
+            n, metrics, durations[0], mean, p50, p95, durations[n - 1]);
+    else
+        fprintf(output,
+            "\n%zu iterations, %zu metrics: min %" PRId64 " us, mean %.1lf us, p50 %" PRId64 " us, p95 %" PRId64
+            " us, max %" PRId64 " us\n",
+            n, metrics, durations[0], mean, p50, p95, durations[n - 1]);
+}
+
+//  --------------------------------------------------------------------------
+//  Run collectors iterations times and print the metrics
+
+int collectonce_run(const std::string& root_dir, int interval, size_t iterations, bool json, FILE* output)
+{
+    assert(output);
+    sourcereader_t* reader = sourcereader_new(root_dir);
+    if (sourcereader_dirfd(reader) < 0) {
+        sourcereader_destroy(&reader);
+        return -1;
+    }
+    if (iterations == 0)
+        iterations = 1;
+
+    linuxsensors_t* sensors = linuxsensors_new(reader);
+    syslimits_t*    limits  = syslimits_new(reader);
+    metricarena_t*  arena   = metricarena_new(METRICARENA_SIZE);
+    zhashx_t*       history = linuxmetric_history_new();
+    // storage metrics are real only for the running system
+    bool metrics_test = !linuxmetric_live_root(reader);
+
+    std::vector<int64_t> durations;
+    durations.reserve(iterations);
+    size_t metrics = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        linuxmetric_set_arena(arena);
+        int64_t   start        = zclock_usecs();
+        linuxmetric_list_t* info         = linuxmetric_get_all(interval, history, reader, metrics_test);
+        linuxmetric_list_t* sensors_info = linuxsensors_get_all(sensors, interval, history);
+        linuxmetric_list_append(info, &sensors_info);
+        linuxmetric_list_t* limits_info = syslimits_get_all(limits);
+        linuxmetric_list_append(info, &limits_info);
+        durations.push_back(zclock_usecs() - start);
+
+        metrics = linuxmetric_list_size(info);
+        if (i == iterations - 1)
+            s_print_metrics(output, info, json);
+        linuxmetric_list_destroy(&info);
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+    }
+    if (iterations > 1)
+        s_print_timing(output, durations, metrics, json);
+    if (json)
+        fprintf(output, "}\n");
+    fflush(output);
+
+    zhashx_destroy(&history);
+    metricarena_destroy(&arena);
+    syslimits_destroy(&limits);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+    return 0;
+}
@@ -0,0 +1,31 @@
+/*  =========================================================================
+    collectonce - Run the collectors without malamute, for profiling
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include <stdio.h>
+#include <string>
+
+//  Collect metrics of root_dir iterations times, the same way the server does
+//  every interval but without the broker and shm, and print the metrics of
+//  the last iteration to output, as "type value unit" lines or as JSON. With
+//  more than one iteration, timing statistics of the iterations are printed
+//  as well. Returns 0 on success, -1 if root_dir can't be opened.
+int collectonce_run(const std::string& root_dir, int interval, size_t iterations, bool json, FILE* output);
@@ -0,0 +1,151 @@
+/*  =========================================================================
+    collecttarget - Class for collecting metrics of another root filesystem
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+
+/*
+@header
+    collecttarget - Class for collecting metrics of another root filesystem
+@discuss
+    One fty-info can collect metrics of several root filesystems, e.g. of
+    LXC guests, and publish them under the guest's asset iname. Each target
+    keeps its own sourcereader and history, so counters of different
+    targets never mix, while all targets share the collectors and are
+    collected in the same interval as the host.
+
+    Hardware sensors and processes belong to the host and are not collected
+    for targets.
+@end
+*/
+
+#include "collecttarget.h"
+#include "ftyinfo.h"
+#include "linuxmetric.h"
+#include "sourcereader.h"
+#include "syslimits.h"
+
+//  Structure of our class
+
+struct _collecttarget_t
+{
+    char*           iname;
+    zhashx_t*       history;
+    sourcereader_t* reader;
+    syslimits_t*    limits;
+    int64_t         duration; // usec of the last collection
+};
+
+//  --------------------------------------------------------------------------
+//  Create a new collecttarget
+
+collecttarget_t* collecttarget_new(const char* iname, const std::string& root_dir)
+{
+    assert(iname);
+    collecttarget_t* self = new collecttarget_t;
+    assert(self);
+    //  Initialize class properties here
+    self->iname    = strdup(iname);
+    self->history  = linuxmetric_history_new();
+    self->reader   = sourcereader_new(root_dir);
+    self->limits   = syslimits_new(self->reader);
+    self->duration = 0;
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the collecttarget
+
+void collecttarget_destroy(collecttarget_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        collecttarget_t* self = *self_p;
+        //  Free class properties here
+        syslimits_destroy(&self->limits);
+        sourcereader_destroy(&self->reader);
+        zhashx_destroy(&self->history);
+        zstr_free(&self->iname);
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return iname of the asset the metrics belong to
+
+const char* collecttarget_iname(collecttarget_t* self)
+{
+    assert(self);
+    return self->iname;
+}
+
+//  --------------------------------------------------------------------------
+//  Return root dir of the target
+
+const std::string& collecttarget_root_dir(collecttarget_t* self)
+{
+    assert(self);
+    return sourcereader_root_dir(self->reader);
+}
+
+//  --------------------------------------------------------------------------
+//  Collect metrics of the target
+
+linuxmetric_list_t* collecttarget_get_all(
+    collecttarget_t* self, int interval, bool metrics_test, ifacefilter_t* filter)
+{
+    assert(self);
+    int64_t             start = zclock_usecs();
+    linuxmetric_list_t* info  = linuxmetric_get_all(interval, self->history, self->reader, metrics_test, filter);
+
+    linuxmetric_list_t* limits_info = syslimits_get_all(self->limits);
+    linuxmetric_list_append(info, &limits_info);
+
+    self->duration = zclock_usecs() - start;
+    return info;
+}
+
+//  --------------------------------------------------------------------------
+//  Return duration of the last collection in microseconds
+
+int64_t collecttarget_duration(collecttarget_t* self)
+{
+    assert(self);
+    return self->duration;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of values kept in history of the target
+
+size_t collecttarget_history_size(collecttarget_t* self)
+{
+    assert(self);
+    return zhashx_size(self->history);
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of files kept open for the target
+
+size_t collecttarget_open_files(collecttarget_t* self)
+{
+    assert(self);
+    return sourcereader_size(self->reader);
+}
@@ -0,0 +1,55 @@
+/*  =========================================================================
+    collecttarget - Class for collecting metrics of another root filesystem
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "ifacefilter.h"
+#include "linuxmetric.h"
+#include <czmq.h>
+#include <string>
+
+typedef struct _collecttarget_t collecttarget_t;
+
+//  Create a new collecttarget reading files under root_dir, its metrics are
+//  published under asset iname
+collecttarget_t* collecttarget_new(const char* iname, const std::string& root_dir);
+
+//  Destroy the collecttarget
+void collecttarget_destroy(collecttarget_t** self_p);
+
+//  Return iname of the asset the metrics belong to
+const char* collecttarget_iname(collecttarget_t* self);
+
+//  Return root dir of the target
+const std::string& collecttarget_root_dir(collecttarget_t* self);
+
+//  Return list of system, network and limits metrics of the target. Network
+//  interfaces are published only if they pass the filter (all if NULL).
+linuxmetric_list_t* collecttarget_get_all(
+    collecttarget_t* self, int interval, bool metrics_test, ifacefilter_t* filter);
+
+//  Return duration of the last collection in microseconds
+int64_t collecttarget_duration(collecttarget_t* self);
+
+//  Return number of values kept in history of the target
+size_t collecttarget_history_size(collecttarget_t* self);
+
+//  Return number of files kept open for the target
+size_t collecttarget_open_files(collecttarget_t* self);
@@ -22,17 +22,38 @@
 /// fty_info - Agent which returns rack controller information
 
 #include "fty_info.h"
+#include "collectonce.h"
 #include <fty_log.h>
 #include <fty_proto.h>
 #include "fty_info_server.h"
 #include "fty_info_rc0_runonce.h"
+#include <pthread.h>
+#include <signal.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
 
 #define RC0_RUNONCE_ACTOR  "fty-info-rc0-runonce"
 #define DEFAULT_LOG_CONFIG "/etc/fty/ftylog.cfg"
 
+static const char* s_trace_file = DEFAULT_TRACE_FILE;
+
 static int s_linuxmetrics_event(zloop_t* /*loop*/, int /*timer_id*/, void* output)
 {
-    zstr_send(output, "LINUXMETRICS");
+    // the server measures how late it handles the interval
+    zstr_sendx(output, "LINUXMETRICS", std::to_string(zclock_usecs()).c_str(), NULL);
+    return 0;
+}
+
+// SIGUSR2 asks for a dump of the tracing spans, it is read from signalfd
+static int s_trace_event(zloop_t* /*loop*/, zmq_pollitem_t* item, void* output)
+{
+    struct signalfd_siginfo info;
+    bool                    dump = false;
+    while (read(item->fd, &info, sizeof(info)) == sizeof(info)) {
+        dump = true;
+    }
+    if (dump)
+        zstr_sendx(output, "TRACE", "DUMP", s_trace_file, NULL);
     return 0;
 }
 
@@ -43,6 +64,10 @@ void usage()
     puts("  -h|--help           this information");
     puts("  -c|--config         path to config file\n");
     puts("  -e|--endpoint       malamute endpoint [ipc://@/malamute]");
+    puts("  --collect-once      collect metrics without malamute, print them and exit");
+    puts("  --root-dir          root dir of the collected system, with --collect-once [/]");
+    puts("  --iterations        collect N times and print timing statistics, with --collect-once [1]");
+    puts("  --json              print metrics as JSON, with --collect-once");
 }
 
 int main(int argc, char* argv[])
@@ -54,10 +79,34 @@ int main(int argc, char* argv[])
     char*       actor_name                = NULL;
     char*       endpoint                  = NULL;
     char*       path                      = NULL;
+    char*       processes_top             = NULL;
+    char*       processes_batch           = NULL;
+    char*       burst_interfaces          = NULL;
+    char*       interfaces_include        = NULL;
+    char*       interfaces_exclude        = NULL;
+    char*       interfaces_max            = NULL;
+    char*       burst_period              = NULL;
+    char*       burst_threshold           = NULL;
+    char*       trace_file                = NULL;
+    zmsg_t*     targets                   = NULL;
+    bool        trace                     = false;
+    bool        stats_metrics             = false;
     bool        verbose                   = false;
+    bool        collect_once              = false;
+    bool        collect_json              = false;
+    const char* collect_root_dir          = "/";
+    size_t      collect_iterations        = 1;
     int         argn;
     const char* hw_cap_path = "/usr/share/fty";
 
+    // SIGUSR2 is taken from signalfd in the main loop: block it before any
+    // thread is started (all threads inherit the mask), so that it neither
+    // interrupts zmq_poll() of the main loop nor of an actor
+    sigset_t trace_signals;
+    sigemptyset(&trace_signals);
+    sigaddset(&trace_signals, SIGUSR2);
+    pthread_sigmask(SIG_BLOCK, &trace_signals, NULL);
+
     ManageFtyLog::setInstanceFtylog(FTY_INFO_AGENT, FTY_COMMON_LOGGING_DEFAULT_CFG);
 
     // Parse command line
@@ -79,6 +128,23 @@ int main(int argc, char* argv[])
             if (param)
                 endpoint = strdup(param);
             ++argn;
+        } else if (streq(argv[argn], "--collect-once")) {
+            collect_once = true;
+        } else if (streq(argv[argn], "--root-dir")) {
+            if (!param || streq(param, "")) {
+                printf("Option --root-dir needs a directory\n");
+                usage();
+                zstr_free(&endpoint);
+                return 1;
+            }
+            collect_root_dir = param;
+            ++argn;
+        } else if (streq(argv[argn], "--iterations")) {
+            if (param)
+                collect_iterations = size_t(strtoul(param, NULL, 10));
+            ++argn;
+        } else if (streq(argv[argn], "--json")) {
+            collect_json = true;
         } else {
             // FIXME: as per the systemd service file, the config file
             // is provided as the default arg without '-c'!
@@ -113,6 +179,43 @@ int main(int argc, char* argv[])
         actor_name = strdup(s_get(config, "malamute/address", NULL));
         path       = strdup(s_get(config, "parameters/path", NULL));
 
+        // Top processes collector (disabled by default)
+        processes_top   = strdup(s_get(config, "metrics/processes_top", "0"));
+        processes_batch = strdup(s_get(config, "metrics/processes_batch", STR_DEFAULT_PROCSCAN_BATCH));
+
+        // Network interfaces to publish (all by default)
+        interfaces_include = strdup(s_get(config, "metrics/interfaces_include", ""));
+        interfaces_exclude = strdup(s_get(config, "metrics/interfaces_exclude", ""));
+        interfaces_max     = strdup(s_get(config, "metrics/interfaces_max", "0"));
+
+        // Sub-second bandwidth sampling (disabled by default)
+        burst_interfaces = strdup(s_get(config, "metrics/burst_interfaces", ""));
+        burst_period     = strdup(s_get(config, "metrics/burst_period", STR_DEFAULT_BURST_PERIOD_MS));
+        burst_threshold  = strdup(s_get(config, "metrics/burst_threshold", STR_DEFAULT_BURST_THRESHOLD));
+
+        // Statistics of the agent published as self metrics (disabled by default)
+        stats_metrics = streq(s_get(config, "server/stats_metrics", "0"), "1");
+
+        // Tracing spans (disabled by default), dumped to trace_file on SIGUSR2
+        trace      = streq(s_get(config, "server/trace", "0"), "1");
+        trace_file = strdup(s_get(config, "server/trace_file", DEFAULT_TRACE_FILE));
+
+        // Other root filesystems (e.g. of containers) collected by this agent, iname = root_dir
+        zconfig_t* target = zconfig_locate(config, "metrics/targets");
+        if (target) {
+            targets = zmsg_new();
+            zmsg_addstr(targets, "TARGETS");
+            for (target = zconfig_child(target); target; target = zconfig_next(target)) {
+                const char* root_dir = zconfig_value(target);
+                if (!root_dir || streq(root_dir, "")) {
+                    log_error("fty_info: root dir of target '%s' is missing", zconfig_name(target));
+                    continue;
+                }
+                zmsg_addstr(targets, zconfig_name(target));
+                zmsg_addstr(targets, root_dir);
+            }
+        }
+
         // ignore "log/config"
     }
 
@@ -120,6 +223,32 @@ int main(int argc, char* argv[])
         ManageFtyLog::getInstanceFtylog()->setVerboseMode();
     }
 
+    // Profiling mode: run the collectors directly, no broker nor shm needed
+    if (collect_once) {
+        std::string root_dir = collect_root_dir;
+        if (root_dir.back() != '/')
+            root_dir += '/';
+        int r = collectonce_run(root_dir, linuxmetrics_interval, collect_iterations, collect_json, stdout);
+        if (r != 0)
+            fprintf(stderr, "Could not open root dir %s\n", root_dir.c_str());
+        zstr_free(&endpoint);
+        zstr_free(&actor_name);
+        zstr_free(&path);
+        zstr_free(&str_linuxmetrics_interval);
+        zstr_free(&processes_top);
+        zstr_free(&processes_batch);
+        zstr_free(&burst_interfaces);
+        zstr_free(&interfaces_include);
+        zstr_free(&interfaces_exclude);
+        zstr_free(&interfaces_max);
+        zstr_free(&burst_period);
+        zstr_free(&burst_threshold);
+        zstr_free(&trace_file);
+        zmsg_destroy(&targets);
+        zconfig_destroy(&config);
+        return r == 0 ? 0 : 1;
+    }
+
     // Sanity checks
     if (actor_name == NULL)
         actor_name = strdup(FTY_INFO_AGENT);
@@ -140,6 +269,20 @@ int main(int argc, char* argv[])
     zstr_sendx(server, "PRODUCER", "ANNOUNCE", NULL);
     zstr_sendx(server, "ROOT_DIR", "/", NULL);
     zstr_sendx(server, "LINUXMETRICSINTERVAL", str_linuxmetrics_interval, NULL);
+    if (processes_top && !streq(processes_top, "0"))
+        zstr_sendx(server, "PROCESSES", processes_top, processes_batch, NULL);
+    if (interfaces_include)
+        zstr_sendx(server, "INTERFACES", interfaces_include, interfaces_exclude, interfaces_max, NULL);
+    if (burst_interfaces && !streq(burst_interfaces, ""))
+        zstr_sendx(server, "BURST", burst_interfaces, burst_period, burst_threshold, NULL);
+    if (targets)
+        zmsg_send(&targets, server);
+    if (stats_metrics)
+        zstr_sendx(server, "STATSMETRICS", "ON", NULL);
+    if (trace)
+        zstr_sendx(server, "TRACE", "ON", NULL);
+    if (trace_file)
+        s_trace_file = trace_file;
 
     // Run once actor to fill data about rackcontroller-0
     zactor_t* rc0_runonce = zactor_new(fty_info_rc0_runonce, const_cast<char*>(RC0_RUNONCE_ACTOR));
@@ -148,16 +291,34 @@ int main(int argc, char* argv[])
 
     zloop_t* timer_loop = zloop_new();
     zloop_timer(timer_loop, size_t(linuxmetrics_interval * 1000), 0, s_linuxmetrics_event, server);
+    int            trace_fd   = signalfd(-1, &trace_signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    zmq_pollitem_t trace_item = {NULL, trace_fd, ZMQ_POLLIN, 0};
+    if (trace_fd == -1)
+        log_error("fty_info: SIGUSR2 won't dump tracing spans, signalfd failed: %m");
+    else
+        zloop_poller(timer_loop, &trace_item, s_trace_event, server);
     zloop_start(timer_loop);
 
     // Cleanup
     zloop_destroy(&timer_loop);
+    if (trace_fd != -1)
+        close(trace_fd);
     zactor_destroy(&server);
     zactor_destroy(&rc0_runonce);
     zstr_free(&actor_name);
     zstr_free(&endpoint);
     zstr_free(&path);
     zstr_free(&str_linuxmetrics_interval);
+    zstr_free(&processes_top);
+    zstr_free(&processes_batch);
+    zstr_free(&burst_interfaces);
+    zstr_free(&interfaces_include);
+    zstr_free(&interfaces_exclude);
+    zstr_free(&interfaces_max);
+    zstr_free(&burst_period);
+    zstr_free(&burst_threshold);
+    zstr_free(&trace_file);
+    zmsg_destroy(&targets);
     zconfig_destroy(&config);
 
     return 0;
@@ -31,6 +31,10 @@
 #define DEFAULT_ANNOUNCE_INTERVAL_SEC         60
 #define DEFAULT_LINUXMETRICS_INTERVAL_SEC     30
 #define STR_DEFAULT_LINUXMETRICS_INTERVAL_SEC "30"
+#define STR_DEFAULT_PROCSCAN_BATCH            "256"
+#define STR_DEFAULT_BURST_PERIOD_MS           "100"
+#define STR_DEFAULT_BURST_THRESHOLD           "80"
+#define DEFAULT_TRACE_FILE                    "/tmp/fty-info-trace.json"
 
 // TODO: get from config
 #define TIMEOUT_MS            -1                                     // wait infinitely
@@ -25,10 +25,22 @@
 @discuss
 @end
 */
+#include "burstsampler.h"
+#include "collecttarget.h"
 #include "fty_info.h"
+#include "fty_info_server_internal.h"
+#include "ifacefilter.h"
+#include "infostats.h"
 #include "ftyinfo.h"
 #include "linuxmetric.h"
+#include "linuxsensors.h"
+#include "metricarena.h"
+#include "procscan.h"
+#include "selfmetric.h"
+#include "sourcereader.h"
+#include "syslimits.h"
 #include "topologyresolver.h"
+#include "tracespan.h"
 #include <bits/local_lim.h>
 #include <cxxtools/jsondeserializer.h>
 #include <fstream>
@@ -60,6 +72,20 @@ struct _fty_info_server_t
     std::string         root_dir; // directory to be considered / - used for testing
     zhashx_t*           history;
     char*               hw_cap_path;
+    sourcereader_t*     reader;   // cached fds of files under root_dir
+    linuxsensors_t*     sensors;  // thermal and hwmon sensors
+    syslimits_t*        limits;   // file handle, inode and pid usage
+    procscan_t*         procscan; // top processes collector, NULL if disabled
+    size_t              procscan_top;
+    size_t              procscan_batch;
+    ifacefilter_t*      ifacefilter; // network interfaces to publish
+    burstsampler_t*     burst;    // sub-second bandwidth sampler, NULL if disabled
+    std::string         burst_interfaces;
+    int                 burst_period_ms;
+    double              burst_threshold;
+    zlistx_t*           targets;  // collecttarget_t of other root filesystems
+    metricarena_t*      arena;    // metrics of the current interval
+    bool                stats_metrics; // publish infostats as self metrics
 };
 
 typedef struct _fty_info_server_t fty_info_server_t;
@@ -75,21 +101,12 @@ const char* s_get(zconfig_t* config, const char* key, const char* dfl)
     return ret;
 }
 
-//  --------------------------------------------------------------------------
-//  Free wrapper for zhashx destructor
-static void history_destructor(void** item)
-{
-    free(*item);
-}
-
 //  --------------------------------------------------------------------------
 //  Create a new fty_info_server
 
 fty_info_server_t* info_server_new(char* name)
 {
-    double*            numerator_ptr   = reinterpret_cast<double*>(zmalloc(sizeof(double)));
-    double*            denominator_ptr = reinterpret_cast<double*>(zmalloc(sizeof(double)));
-    fty_info_server_t* self            = new fty_info_server_t;
+    fty_info_server_t* self = new fty_info_server_t;
     assert(self);
     //  Initialize class properties here
     self->name            = strdup(name);
@@ -97,12 +114,23 @@ fty_info_server_t* info_server_new(char* name)
     self->announce_client = mlm_client_new();
     self->first_announce  = true;
     self->test            = false;
-    self->history         = zhashx_new();
+    self->history         = linuxmetric_history_new();
     self->hw_cap_path     = NULL;
     self->resolver        = topologyresolver_new(DEFAULT_RC_INAME);
-    zhashx_set_destructor(self->history, history_destructor);
-    zhashx_insert(self->history, HIST_CPU_NUMERATOR, numerator_ptr);
-    zhashx_insert(self->history, HIST_CPU_DENOMINATOR, denominator_ptr);
+    self->reader          = NULL;
+    self->sensors         = NULL;
+    self->limits          = NULL;
+    self->procscan        = NULL;
+    self->procscan_top    = 0;
+    self->procscan_batch  = DEFAULT_PROCSCAN_BATCH;
+    self->ifacefilter     = ifacefilter_new("", "", 0);
+    self->burst           = NULL;
+    self->burst_period_ms = DEFAULT_BURST_PERIOD_MS;
+    self->burst_threshold = DEFAULT_BURST_THRESHOLD;
+    self->targets         = zlistx_new();
+    self->arena           = metricarena_new(METRICARENA_SIZE);
+    self->stats_metrics   = false;
+    zlistx_set_destructor(self->targets, reinterpret_cast<czmq_destructor*>(collecttarget_destroy));
     return self;
 }
 //  --------------------------------------------------------------------------
@@ -122,6 +150,14 @@ void info_server_destroy(fty_info_server_t** self_p)
         topologyresolver_destroy(&self->resolver);
         zhashx_destroy(&self->history);
         zstr_free(&self->hw_cap_path);
+        procscan_destroy(&self->procscan);
+        burstsampler_destroy(&self->burst);
+        syslimits_destroy(&self->limits);
+        linuxsensors_destroy(&self->sensors);
+        sourcereader_destroy(&self->reader);
+        ifacefilter_destroy(&self->ifacefilter);
+        zlistx_destroy(&self->targets);
+        metricarena_destroy(&self->arena);
         //  Free object itself
         delete self;
         *self_p = NULL;
@@ -181,7 +217,7 @@ static char* s_get_name(ftyinfo_t* info)
 //          type (meaning device type)
 //          hostname
 //          txtvers
-static zmsg_t* s_create_info(ftyinfo_t* info)
+zmsg_t* fty_info_server_info_msg(ftyinfo_t* info)
 {
     zmsg_t* msg = zmsg_new();
     zmsg_addstr(msg, FTY_INFO_CMD);
@@ -209,71 +245,177 @@ static zmsg_t* s_create_info(ftyinfo_t* info)
 //  subject : CREATE/UPDATE
 static void s_publish_announce(fty_info_server_t* self)
 {
-
+    TRACESPAN("s_publish_announce");
     if (!mlm_client_connected(self->announce_client))
         return;
+    int64_t    start = zclock_usecs();
     ftyinfo_t* info;
     if (!self->test) {
         info = ftyinfo_new(self->resolver, self->path);
     } else
         info = ftyinfo_test_new();
 
-    zmsg_t* msg = s_create_info(info);
+    zmsg_t* msg = fty_info_server_info_msg(info);
 
     if (self->first_announce) {
         if (mlm_client_send(self->announce_client, "CREATE", &msg) != -1) {
             log_info("publish CREATE msg on ANNOUNCE STREAM");
             self->first_announce = false;
-        } else
+            infostats_add(INFOSTATS_ANNOUNCE_SENT);
+        } else {
             log_error("cant publish CREATE msg on ANNOUNCE STREAM");
+            infostats_add(INFOSTATS_ANNOUNCE_FAILED);
+        }
     } else {
-        if (mlm_client_send(self->announce_client, "UPDATE", &msg) != -1)
+        if (mlm_client_send(self->announce_client, "UPDATE", &msg) != -1) {
             log_info("publish UPDATE msg on ANNOUNCE STREAM");
-        else
+            infostats_add(INFOSTATS_ANNOUNCE_SENT);
+        } else {
             log_error("cant publish UPDATE msg on ANNOUNCE STREAM");
+            infostats_add(INFOSTATS_ANNOUNCE_FAILED);
+        }
     }
     ftyinfo_destroy(&info);
+    infostats_record(INFOSTATS_ANNOUNCE, zclock_usecs() - start);
+}
+
+//  --------------------------------------------------------------------------
+//  Create collectors reading files under root_dir through cached fds
+static void s_open_reader(fty_info_server_t* self)
+{
+    if (!self->reader) {
+        self->reader  = sourcereader_new(self->root_dir);
+        self->sensors = linuxsensors_new(self->reader);
+        self->limits  = syslimits_new(self->reader);
+    }
+    if (!self->burst && !self->burst_interfaces.empty())
+        self->burst = burstsampler_new(
+            self->reader, self->burst_interfaces.c_str(), self->burst_period_ms, self->burst_threshold);
+}
+
+//  --------------------------------------------------------------------------
+//  Return poller timeout, short enough not to miss the next burst sample
+static int s_poll_timeout(fty_info_server_t* self)
+{
+    if (!self->burst)
+        return TIMEOUT_MS;
+    int64_t wait = burstsampler_next(self->burst) - zclock_mono();
+    return wait > 0 ? int(wait) : 0;
+}
+
+//  --------------------------------------------------------------------------
+//  publish metrics of asset iname, metrics are destroyed
+static void s_write_metrics(fty_info_server_t* self, const char* iname, linuxmetric_list_t** info_p)
+{
+    TRACESPAN("s_write_metrics");
+    linuxmetric_list_t* info = *info_p;
+    log_debug("s_publish_linuxmetrics for '%s' (info size: %zu)", iname, linuxmetric_list_size(info));
+
+    int ttl = 3 * self->linuxmetrics_interval; // in seconds
+    linuxmetric_t* metric = linuxmetric_list_first(info);
+    while (metric) {
+        char value[64];
+        snprintf(value, sizeof(value), "%lf", metric->value);
+        log_debug("Publishing metric %s, value %lf, unit %s", metric->type, metric->value, metric->unit);
+
+        int r = fty::shm::write_metric(iname, metric->type, value, metric->unit, ttl);
+        if (r == 0) {
+            log_trace("Metric %s published", metric->type);
+        } else {
+            log_error("Can't publish metric %s (r: %d)", metric->type, r);
+            infostats_add(INFOSTATS_METRIC_FAILED);
+        }
+        metric = linuxmetric_list_next(info);
+    }
+
+    linuxmetric_list_destroy(info_p);
 }
 
 //  --------------------------------------------------------------------------
 //  publish Linux system info on STREAM METRICS
 static void s_publish_linuxmetrics(fty_info_server_t* self)
 {
-    char* rc_iname = topologyresolver_id(self->resolver);
+    TRACESPAN("s_publish_linuxmetrics");
+    int64_t start    = zclock_usecs();
+    char*   rc_iname = topologyresolver_id(self->resolver);
     if (!rc_iname) {
         log_error("rc_iname is NULL");
         return;
     }
+    // all metrics of this interval are released at once after publishing
+    linuxmetric_set_arena(self->arena);
+
+    // other root filesystems first, so that the interface filter ends up
+    // with the count of the host
+    linuxmetric_list_t* targets_info = linuxmetric_list_new();
+    collecttarget_t*    target       = static_cast<collecttarget_t*>(zlistx_first(self->targets));
+    while (target) {
+        TRACESPAN("collecttarget");
+        linuxmetric_list_t* target_info =
+            collecttarget_get_all(target, self->linuxmetrics_interval, self->test, self->ifacefilter);
+        s_write_metrics(self, collecttarget_iname(target), &target_info);
+        linuxmetric_list_t* cost_info = selfmetric_target(collecttarget_iname(target),
+            collecttarget_duration(target), collecttarget_history_size(target), collecttarget_open_files(target));
+        linuxmetric_list_append(targets_info, &cost_info);
+        target = static_cast<collecttarget_t*>(zlistx_next(self->targets));
+    }
 
-    zlistx_t* info = linuxmetric_get_all(self->linuxmetrics_interval, self->history, self->root_dir, self->test);
+    s_open_reader(self);
+    linuxmetric_list_t* info;
+    {
+        TRACESPAN("linuxmetric_get_all");
+        info = linuxmetric_get_all(
+            self->linuxmetrics_interval, self->history, self->reader, self->test, self->ifacefilter);
+    }
     if (!info) {
        log_error("info is NULL");
+       linuxmetric_list_destroy(&targets_info);
+       linuxmetric_set_arena(NULL);
+       metricarena_reset(self->arena);
        free(rc_iname);
        return;
     }
 
-    log_debug("s_publish_linuxmetrics for '%s' (info size: %zu)", rc_iname, (info ? zlistx_size(info) : 0));
+    {
+        TRACESPAN("linuxsensors_get_all");
+        linuxmetric_list_t* sensors_info =
+            linuxsensors_get_all(self->sensors, self->linuxmetrics_interval, self->history);
+        linuxmetric_list_append(info, &sensors_info);
+    }
+    {
+        TRACESPAN("syslimits_get_all");
+        linuxmetric_list_t* limits_info = syslimits_get_all(self->limits);
+        linuxmetric_list_append(info, &limits_info);
+    }
 
-    int ttl = 3 * self->linuxmetrics_interval; // in seconds
-    linuxmetric_t* metric = static_cast<linuxmetric_t*>(zlistx_first(info));
-    while (metric) {
-        char* value = zsys_sprintf("%lf", metric->value);
-        log_debug("Publishing metric %s, value %lf, unit %s", metric->type, metric->value, metric->unit);
+    if (self->procscan_top > 0) {
+        TRACESPAN("procscan_get_all");
+        if (!self->procscan)
+            self->procscan = procscan_new(self->root_dir, self->procscan_top, self->procscan_batch);
+        linuxmetric_list_t* processes_info = procscan_get_all(self->procscan);
+        linuxmetric_list_append(info, &processes_info);
+    }
 
-        int r = fty::shm::write_metric(rc_iname, metric->type, value, metric->unit, ttl);
-        if (r == 0) {
-            log_trace("Metric %s published", metric->type);
-        } else {
-            log_error("Can't publish metric %s (r: %d)", metric->type, r);
-        }
-        linuxmetric_destroy(&metric);
+    if (self->burst) {
+        linuxmetric_list_t* burst_info = burstsampler_get_all(self->burst);
+        linuxmetric_list_append(info, &burst_info);
+    }
 
-        metric = static_cast<linuxmetric_t*>(zlistx_next(info));
-        zstr_free(&value);
+    // resource usage of the agent itself, published along with the system metrics
+    linuxmetric_list_t* self_info = selfmetric_get_all(self->linuxmetrics_interval, self->history,
+        topologyresolver_assets_size(self->resolver), ifacefilter_dropped(self->ifacefilter));
+    linuxmetric_list_append(info, &self_info);
+    linuxmetric_list_append(info, &targets_info);
+    if (self->stats_metrics) {
+        linuxmetric_list_t* stats_info = infostats_metrics();
+        linuxmetric_list_append(info, &stats_info);
     }
 
+    s_write_metrics(self, rc_iname, &info);
+    linuxmetric_set_arena(NULL);
+    metricarena_reset(self->arena);
     free(rc_iname);
-    zlistx_destroy(&info);
+    infostats_record(INFOSTATS_METRICS, zclock_usecs() - start);
 }
 
 //  --------------------------------------------------------------------------
@@ -367,17 +509,118 @@ bool static s_handle_pipe(fty_info_server_t* self, zmsg_t* message)
         char* root_dir = zmsg_popstr(message);
         log_info("Will be using %s as root dir for finding out Linux metrics", root_dir);
         self->root_dir.assign(root_dir);
+        if (!self->root_dir.empty() && self->root_dir.back() != '/')
+            self->root_dir += '/';
+        // collectors with cached state are recreated for the new root dir
+        procscan_destroy(&self->procscan);
+        burstsampler_destroy(&self->burst);
+        syslimits_destroy(&self->limits);
+        linuxsensors_destroy(&self->sensors);
+        sourcereader_destroy(&self->reader);
+        if (!self->burst_interfaces.empty())
+            s_open_reader(self);
         zstr_free(&root_dir);
+    } else if (streq(command, "PROCESSES")) {
+        char* top   = zmsg_popstr(message);
+        char* batch = zmsg_popstr(message);
+        if (top) {
+            self->procscan_top = size_t(strtoul(top, NULL, 10));
+            if (batch)
+                self->procscan_batch = size_t(strtoul(batch, NULL, 10));
+            log_info("Will be publishing top %zu processes, scanning %zu processes per interval", self->procscan_top,
+                self->procscan_batch);
+            procscan_destroy(&self->procscan);
+        } else
+            log_error("%s: top count missing", command);
+        zstr_free(&batch);
+        zstr_free(&top);
+    } else if (streq(command, "INTERFACES")) {
+        char* include = zmsg_popstr(message);
+        char* exclude = zmsg_popstr(message);
+        char* max     = zmsg_popstr(message);
+        log_info("Will be publishing interfaces matching '%s', except '%s', at most %s", include ? include : "",
+            exclude ? exclude : "", max ? max : "0");
+        ifacefilter_destroy(&self->ifacefilter);
+        self->ifacefilter = ifacefilter_new(include, exclude, max ? size_t(strtoul(max, NULL, 10)) : 0);
+        zstr_free(&max);
+        zstr_free(&exclude);
+        zstr_free(&include);
+    } else if (streq(command, "BURST")) {
+        char* interfaces = zmsg_popstr(message);
+        char* period     = zmsg_popstr(message);
+        char* threshold  = zmsg_popstr(message);
+        if (interfaces) {
+            self->burst_interfaces.assign(interfaces);
+            if (period)
+                self->burst_period_ms = int(strtol(period, NULL, 10));
+            if (threshold)
+                self->burst_threshold = strtod(threshold, NULL);
+            log_info("Will be sampling bandwidth of '%s' each %d ms", interfaces, self->burst_period_ms);
+            burstsampler_destroy(&self->burst);
+            s_open_reader(self);
+        } else
+            log_error("%s: interfaces missing", command);
+        zstr_free(&threshold);
+        zstr_free(&period);
+        zstr_free(&interfaces);
+    } else if (streq(command, "TARGETS")) {
+        // pairs of iname and root_dir, replacing the current targets
+        zlistx_purge(self->targets);
+        char* iname = zmsg_popstr(message);
+        while (iname) {
+            char* root_dir = zmsg_popstr(message);
+            if (!root_dir) {
+                log_error("%s: root dir of '%s' missing", command, iname);
+                zstr_free(&iname);
+                break;
+            }
+            log_info("Will be publishing metrics of %s for %s", root_dir, iname);
+            zlistx_add_end(self->targets, collecttarget_new(iname, root_dir));
+            zstr_free(&root_dir);
+            zstr_free(&iname);
+            iname = zmsg_popstr(message);
+        }
     } else if (streq(command, "TEST")) {
         self->test = true;
     } else if (streq(command, "ANNOUNCE")) {
         s_publish_announce(self);
     } else if (streq(command, "LINUXMETRICS")) {
+        // zclock_usecs() when the interval was due, if the sender knows it
+        char* due = zmsg_popstr(message);
+        if (due)
+            infostats_record(INFOSTATS_POLL_LAG, zclock_usecs() - strtoll(due, NULL, 10));
+        zstr_free(&due);
         s_publish_linuxmetrics(self);
     } else if (streq(command, "CONFIG")) {
         self->hw_cap_path = zmsg_popstr(message);
         if (!self->hw_cap_path)
             log_error("%s: hw_cap_path missing", command);
+    } else if (streq(command, "STATSMETRICS")) {
+        // ON or OFF
+        char* action = zmsg_popstr(message);
+        if (action && (streq(action, "ON") || streq(action, "OFF"))) {
+            log_info("Publishing of statistics as self metrics %s", action);
+            self->stats_metrics = streq(action, "ON");
+        } else
+            log_error("%s: expected ON or OFF", command);
+        zstr_free(&action);
+    } else if (streq(command, "TRACE")) {
+        // ON, OFF or DUMP <file>
+        char* action = zmsg_popstr(message);
+        char* file   = zmsg_popstr(message);
+        if (action && (streq(action, "ON") || streq(action, "OFF"))) {
+            log_info("Tracing %s", action);
+            tracespan_enable(streq(action, "ON"));
+        } else if (action && streq(action, "DUMP") && file) {
+            size_t size = tracespan_size();
+            if (tracespan_dump_file(file))
+                log_info("Trace of %zu spans written to %s", size, file);
+            else
+                log_error("Can't write trace to %s: %m", file);
+        } else
+            log_error("%s: expected ON, OFF or DUMP <file>", command);
+        zstr_free(&file);
+        zstr_free(&action);
     } else
         log_error("fty-info: Unknown actor command: %s.\n", command);
 
@@ -398,15 +641,15 @@ void fty_msg_free_fn(void* data)
 
 //  --------------------------------------------------------------------------
 // return zmsg_t with hw capability info or NULL if info cannot be retrieved
-static zmsg_t* s_hw_cap(fty_info_server_t* self, const char* type, char* zuuid)
+zmsg_t* fty_info_server_hw_cap_msg(const char* hw_cap_path, const char* type, const char* zuuid)
 {
     zmsg_t*    msg = zmsg_new();
-    char*      tmp = zsys_sprintf("%s/%s", self->hw_cap_path, HW_CAP_FILE);
+    char*      tmp = zsys_sprintf("%s/%s", hw_cap_path, HW_CAP_FILE);
     zconfig_t* cap = zconfig_load(tmp);
     zstr_free(&tmp);
 
     if (!cap) {
-        log_debug("s_hw_cap: cannot load capability file from %s", self->hw_cap_path);
+        log_debug("hw_cap: cannot load capability file from %s", hw_cap_path);
         return msg;
     }
 
@@ -454,7 +697,7 @@ static zmsg_t* s_hw_cap(fty_info_server_t* self, const char* type, char* zuuid)
         zmsg_addstr(msg, type);
         zmsg_addstr(msg, s_get(cap, "hardware/type", ""));
     } else {
-        log_info("s_hw_cap: unsuported request for '%s'", type);
+        log_info("hw_cap: unsuported request for '%s'", type);
 
         zmsg_addstr(msg, zuuid);
         zmsg_addstr(msg, "ERROR");
@@ -471,58 +714,78 @@ out:
 //  process message from FTY_PROTO_ASSET stream
 void static s_handle_stream(fty_info_server_t* self, zmsg_t* message)
 {
+    TRACESPAN("s_handle_stream");
     if (!fty_proto_is(message)) {
+        infostats_add(INFOSTATS_STREAM_IGNORED);
         return;
     }
+    int64_t start = zclock_usecs();
 
     zmsg_t* aux = zmsg_dup(message);
     fty_proto_t* fproto = fty_proto_decode(&aux);
     zmsg_destroy(&aux);
     if (!fproto) {
         log_error("can't decode message with subject %s, ignoring", mlm_client_subject(self->client));
+        infostats_add(INFOSTATS_STREAM_IGNORED);
         return;
     }
     if (fty_proto_id(fproto) != FTY_PROTO_ASSET) {
         fty_proto_destroy(&fproto);
+        infostats_add(INFOSTATS_STREAM_IGNORED);
         return;
     }
-    if (topologyresolver_asset(self->resolver, fproto)) {
+    infostats_add(INFOSTATS_STREAM_PROCESSED);
+    bool changed;
+    {
+        TRACESPAN("topologyresolver_asset");
+        changed = topologyresolver_asset(self->resolver, fproto);
+    }
+    if (changed) {
         s_publish_announce(self);
     }
 
     fty_proto_destroy(&fproto);
+    infostats_record(INFOSTATS_STREAM, zclock_usecs() - start);
 }
 
 //  --------------------------------------------------------------------------
 //  process message from MAILBOX DELIVER
 void static s_handle_mailbox(fty_info_server_t* self, zmsg_t* message)
 {
+    TRACESPAN("s_handle_mailbox");
     char* command = zmsg_popstr(message);
     if (!command) {
         log_warning("Empty command.");
         return;
     }
 
-    char*   zuuid = zmsg_popstr(message);
-    zmsg_t* reply = NULL;
+    char*   zuuid     = zmsg_popstr(message);
+    zmsg_t* reply     = NULL;
+    int64_t start     = zclock_usecs();
+    int     histogram = -1; // infostats_histogram_t of the command
 
     // we assume all request command are MAILBOX DELIVER, and with any subject"
     if (streq(command, "INFO")) {
+        TRACESPAN("INFO");
+        histogram       = INFOSTATS_INFO;
         ftyinfo_t* info = ftyinfo_new(self->resolver, self->path);
 
-        reply = s_create_info(info);
+        reply = fty_info_server_info_msg(info);
         zmsg_pushstrf(reply, "%s", zuuid);
         ftyinfo_destroy(&info);
     } else if (streq(command, "INFO-TEST")) {
+        histogram       = INFOSTATS_INFO_TEST;
         ftyinfo_t* info = ftyinfo_test_new();
 
-        reply = s_create_info(info);
+        reply = fty_info_server_info_msg(info);
         zmsg_pushstrf(reply, "%s", zuuid);
         ftyinfo_destroy(&info);
     } else if (streq(command, "HW_CAP")) {
+        TRACESPAN("HW_CAP");
+        histogram  = INFOSTATS_HW_CAP;
         char* type = zmsg_popstr(message);
         if (type)
-            reply = s_hw_cap(self, type, zuuid);
+            reply = fty_info_server_hw_cap_msg(self->hw_cap_path, type, zuuid);
 
         if (zmsg_size(reply) == 0) {
             zmsg_pushstrf(reply, "%s", zuuid);
@@ -530,11 +793,19 @@ void static s_handle_mailbox(fty_info_server_t* self, zmsg_t* message)
             zmsg_addstr(reply, "cap does not exist");
         }
         zstr_free(&type);
+    } else if (streq(command, "STATS")) {
+        histogram = INFOSTATS_STATS;
+        reply     = zmsg_new();
+        zmsg_addstr(reply, zuuid ? zuuid : "");
+        zmsg_addstr(reply, "OK");
+        infostats_to_msg(reply);
     } else if (streq(command, "ERROR")) {
         // Don't reply to ERROR messages
+        infostats_add(INFOSTATS_MAILBOX_ERROR);
         log_warning("%s: Received ERROR command from '%s', ignoring", self->name, mlm_client_sender(self->client));
     } else {
         log_warning("%s: Received unexpected command '%s' from '%s'", self->name, command, mlm_client_sender(self->client));
+        infostats_add(INFOSTATS_MAILBOX_UNEXPECTED);
 
         reply = zmsg_new();
         if (NULL != zuuid)
@@ -545,10 +816,15 @@ void static s_handle_mailbox(fty_info_server_t* self, zmsg_t* message)
     }
 
     if (reply) {
+        TRACESPAN("mailbox reply");
         int rv = mlm_client_sendto(self->client, mlm_client_sender(self->client), "info", NULL, 1000, &reply);
-        if (rv != 0)
+        if (rv != 0) {
             log_error("s_handle_mailbox: failed to send reply to %s ", mlm_client_sender(self->client));
+            infostats_add(INFOSTATS_REPLY_FAILED);
+        }
     }
+    if (histogram >= 0)
+        infostats_record(infostats_histogram_t(histogram), zclock_usecs() - start);
 
     zmsg_destroy(&reply);
     zstr_free(&zuuid);
@@ -573,7 +849,12 @@ void fty_info_server(zsock_t* pipe, void* args)
     log_info("fty-info: Started");
 
     while (!zsys_interrupted) {
-        void* which = zpoller_wait(poller, TIMEOUT_MS);
+        void* which = zpoller_wait(poller, s_poll_timeout(self));
+        if (self->burst && zclock_mono() >= burstsampler_next(self->burst)) {
+            // both clocks are monotonic
+            infostats_record(INFOSTATS_POLL_LAG, zclock_usecs() - burstsampler_next(self->burst) * 1000);
+            burstsampler_sample(self->burst, zclock_mono());
+        }
         if (which == NULL) {
             if (zpoller_terminated(poller) || zsys_interrupted) {
                 break;
@@ -0,0 +1,34 @@
+/*  =========================================================================
+    fty_info_server_internal - message builders of the info server
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "ftyinfo.h"
+#include <czmq.h>
+
+//  Not part of the actor interface, the replies are built here so that the
+//  tests can measure them without a broker.
+
+//  Create INFO reply/announce message of info
+zmsg_t* fty_info_server_info_msg(ftyinfo_t* info);
+
+//  Create HW_CAP reply with zuuid for capability type from the capability
+//  file in hw_cap_path, empty message if the file can't be loaded
+zmsg_t* fty_info_server_hw_cap_msg(const char* hw_cap_path, const char* type, const char* zuuid);
@@ -28,6 +28,7 @@
 
 #include "ftyinfo.h"
 #include "fty_info.h"
+#include "tracespan.h"
 #include <cxxtools/jsondeserializer.h>
 #include <fstream>
 #include <fty_log.h>
@@ -85,6 +86,7 @@ static const char* BRANDING_INFO   = "/etc/etn-ipm2-branding.conf";
 
 static cxxtools::SerializationInfo* s_load_release_details()
 {
+    TRACESPAN("s_load_release_details");
     cxxtools::SerializationInfo* si = new cxxtools::SerializationInfo();
     try {
         std::ifstream              f(RELEASE_DETAILS);
@@ -120,6 +122,7 @@ static char* s_get_release_details(cxxtools::SerializationInfo& si, const char*
 
 static cxxtools::SerializationInfo* s_load_branding_info()
 {
+    TRACESPAN("s_load_branding_info");
     cxxtools::SerializationInfo* si = new cxxtools::SerializationInfo();
     try {
         std::ifstream              f(BRANDING_INFO);
@@ -158,6 +161,7 @@ static char* s_get_branding_info(cxxtools::SerializationInfo& si, const char* ke
 
 ftyinfo_t* ftyinfo_new(topologyresolver_t* resolver, const char* path)
 {
+    TRACESPAN("ftyinfo_new");
     ftyinfo_t* self = static_cast<ftyinfo_t*>(zmalloc(sizeof(ftyinfo_t)));
     self->infos     = zhash_new();
 
@@ -186,7 +190,10 @@ ftyinfo_t* ftyinfo_new(topologyresolver_t* resolver, const char* path)
     log_info("fty-info:name_uri  = '%s'", self->name_uri);
 
     // set location
-    self->location = topologyresolver_to_string(resolver, ">");
+    {
+        TRACESPAN("topologyresolver_to_string");
+        self->location = topologyresolver_to_string(resolver, ">");
+    }
     log_info("fty-info:location  = '%s'", self->location);
 
     // set parent_uri
@@ -261,22 +268,26 @@ ftyinfo_t* ftyinfo_new(topologyresolver_t* resolver, const char* path)
     }
     counter = 0;
     struct ifaddrs *interfaces, *iface;
-    if (getifaddrs(&interfaces) != -1) {
-        char            host[NI_MAXHOST];
-        for (iface = interfaces; iface != NULL; iface = iface->ifa_next) {
-            if (iface->ifa_addr == NULL)
-                continue;
-            // here we support IPv4 only, only get first 3 addresses
-            if (iface->ifa_addr->sa_family == AF_INET && 0 == getnameinfo(iface->ifa_addr, sizeof(struct sockaddr_in),
-                                                                  host, NI_MAXHOST, NULL, 0, NI_NUMERICHOST)) {
-                self->ip[counter] = strdup(host);
-                ++counter;
-            }
-            if (counter == 3) {
-                break;
+    {
+        TRACESPAN("getifaddrs");
+        if (getifaddrs(&interfaces) != -1) {
+            char            host[NI_MAXHOST];
+            for (iface = interfaces; iface != NULL; iface = iface->ifa_next) {
+                if (iface->ifa_addr == NULL)
+                    continue;
+                // here we support IPv4 only, only get first 3 addresses
+                if (iface->ifa_addr->sa_family == AF_INET &&
+                    0 == getnameinfo(iface->ifa_addr, sizeof(struct sockaddr_in), host, NI_MAXHOST, NULL, 0,
+                             NI_NUMERICHOST)) {
+                    self->ip[counter] = strdup(host);
+                    ++counter;
+                }
+                if (counter == 3) {
+                    break;
+                }
             }
+            freeifaddrs(interfaces);
         }
-        freeifaddrs(interfaces);
     }
 
     if (si)
@@ -63,6 +63,10 @@
 #define HIST_CPU_NUMERATOR     "cpu_usage_numerator"
 #define HIST_CPU_DENOMINATOR   "cpu_usage_denominator"
 #define NETWORK_HISTORY_PREFIX "network_history"
+#define VMSTAT_HISTORY_PREFIX  "vmstat_history"
+#define NETSTAT_HISTORY_PREFIX "netstat_history"
+#define HIST_CPU_CORE_THROTTLE "cpu_core_throttle"
+#define HIST_CPU_PKG_THROTTLE  "cpu_package_throttle"
 
 //  Structure of our class
 
@@ -0,0 +1,136 @@
+/*  =========================================================================
+    ifacefilter - Class for selecting network interfaces to publish
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    ifacefilter - Class for selecting network interfaces to publish
+@discuss
+    Hosts with container bridges, veth pairs or VLAN sub-interfaces have
+    hundreds of interfaces nobody is interested in. The filter is applied
+    to interface names only, so no file of a rejected interface is read.
+@end
+*/
+
+#include "ifacefilter.h"
+#include <assert.h>
+#include <fnmatch.h>
+#include <string>
+#include <vector>
+
+//  Structure of our class
+
+struct _ifacefilter_t
+{
+    std::vector<std::string> include;
+    std::vector<std::string> exclude;
+    size_t                   max;
+    size_t                   dropped;
+};
+
+static void s_split(const char* list, std::vector<std::string>& patterns)
+{
+    if (!list)
+        return;
+    std::string str(list);
+    size_t      start = 0;
+    while (start < str.size()) {
+        size_t end = str.find_first_of(", ", start);
+        if (end == std::string::npos)
+            end = str.size();
+        if (end > start)
+            patterns.push_back(str.substr(start, end - start));
+        start = end + 1;
+    }
+}
+
+static bool s_match_any(const std::vector<std::string>& patterns, const char* name)
+{
+    for (const auto& pattern : patterns) {
+        if (fnmatch(pattern.c_str(), name, 0) == 0)
+            return true;
+    }
+    return false;
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new ifacefilter
+
+ifacefilter_t* ifacefilter_new(const char* include, const char* exclude, size_t max)
+{
+    ifacefilter_t* self = new ifacefilter_t;
+    assert(self);
+    //  Initialize class properties here
+    s_split(include, self->include);
+    s_split(exclude, self->exclude);
+    self->max     = max;
+    self->dropped = 0;
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the ifacefilter
+
+void ifacefilter_destroy(ifacefilter_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        ifacefilter_t* self = *self_p;
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return true if interface should be published
+
+bool ifacefilter_match(ifacefilter_t* self, const char* name)
+{
+    assert(self);
+    assert(name);
+    if (!self->include.empty() && !s_match_any(self->include, name))
+        return false;
+    return !s_match_any(self->exclude, name);
+}
+
+//  --------------------------------------------------------------------------
+//  Return maximal number of interfaces
+
+size_t ifacefilter_max(ifacefilter_t* self)
+{
+    assert(self);
+    return self->max;
+}
+
+//  --------------------------------------------------------------------------
+//  Set/return number of dropped interfaces
+
+void ifacefilter_set_dropped(ifacefilter_t* self, size_t dropped)
+{
+    assert(self);
+    self->dropped = dropped;
+}
+
+size_t ifacefilter_dropped(ifacefilter_t* self)
+{
+    assert(self);
+    return self->dropped;
+}
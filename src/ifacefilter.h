@@ -0,0 +1,43 @@
+/*  =========================================================================
+    ifacefilter - Class for selecting network interfaces to publish
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include <stddef.h>
+
+typedef struct _ifacefilter_t ifacefilter_t;
+
+//  Create a new ifacefilter. include and exclude are lists of glob patterns
+//  (e.g. "eth*,LAN?") separated by ',' or ' '; empty include matches all
+//  interfaces. At most max interfaces pass the filter, 0 means no limit.
+ifacefilter_t* ifacefilter_new(const char* include, const char* exclude, size_t max);
+
+//  Destroy the ifacefilter
+void ifacefilter_destroy(ifacefilter_t** self_p);
+
+//  Return true if interface name matches include and not exclude patterns
+bool ifacefilter_match(ifacefilter_t* self, const char* name);
+
+//  Return maximal number of interfaces, 0 if unlimited
+size_t ifacefilter_max(ifacefilter_t* self);
+
+//  Set/return number of interfaces dropped by the last listing
+void   ifacefilter_set_dropped(ifacefilter_t* self, size_t dropped);
+size_t ifacefilter_dropped(ifacefilter_t* self);
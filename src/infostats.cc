@@ -0,0 +1,310 @@
+/*  =========================================================================
+    infostats - Counters and latency histograms of the agent
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    infostats - Counters and latency histograms of the agent
+@discuss
+    Counters and histograms are kept per thread and summed when read, so
+    the hot path does a relaxed fetch_add on memory of its own thread, whose
+    cache line is not shared, and never takes a lock. The atomic add is what
+    lets infostats_reset zero the values from another thread without losing
+    or undoing updates. The block of a thread is created on its first update
+    and kept until exit.
+
+    Histograms are log-linear (as HdrHistogram): values below 32 us have
+    their own bucket, larger ones are split into 16 buckets per power of
+    two, so a bucket is at most 1/16 of its value wide. Values of 2^40 us
+    and above fall into the last 16 buckets, those of 2^41 us and above all
+    into the very last one.
+@end
+*/
+
+#include "infostats.h"
+#include "linuxmetric.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctype.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define SUB_BUCKETS 16 // per power of two
+#define MAX_MSB     40
+#define BUCKETS     ((MAX_MSB - 2) * SUB_BUCKETS) // values of msb 0 .. MAX_MSB
+
+typedef struct
+{
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+} infostats_histogram_data_t;
+
+typedef struct
+{
+    std::atomic<uint64_t>      counters[INFOSTATS_COUNTERS];
+    infostats_histogram_data_t histograms[INFOSTATS_HISTOGRAMS];
+} infostats_block_t;
+
+static const char* s_counter_names[INFOSTATS_COUNTERS] = {"mailbox.ERROR", "mailbox.unexpected",
+    "mailbox.reply_failed", "stream.processed", "stream.ignored", "announce.sent", "announce.failed",
+    "metrics.publish_failed", "topology.fetch_failed", "topology.fetch_timeout", "topology.fetch_late", "burst.gap"};
+
+static const char* s_histogram_names[INFOSTATS_HISTOGRAMS] = {"mailbox.INFO", "mailbox.INFO-TEST",
+    "mailbox.HW_CAP", "mailbox.STATS", "stream.ASSETS", "announce", "metrics.interval", "topology.fetch",
+    "poll.lag"};
+
+static std::mutex                                      s_blocks_mutex; // taken once per thread and by reads
+static std::vector<std::unique_ptr<infostats_block_t>> s_blocks;
+static thread_local infostats_block_t*                 s_block = nullptr;
+
+static infostats_block_t* s_thread_block(void)
+{
+    if (!s_block) {
+        // value initialization zeroes all counters
+        std::unique_ptr<infostats_block_t> block(new infostats_block_t());
+        s_block = block.get();
+        std::lock_guard<std::mutex> lock(s_blocks_mutex);
+        s_blocks.push_back(std::move(block));
+    }
+    return s_block;
+}
+
+//  Add to value of the calling thread, which infostats_reset may zero meanwhile
+static void s_add(std::atomic<uint64_t>& value, uint64_t n)
+{
+    value.fetch_add(n, std::memory_order_relaxed);
+}
+
+static size_t s_bucket(uint64_t value)
+{
+    if (value < 2 * SUB_BUCKETS)
+        return size_t(value);
+    int msb = 63 - __builtin_clzll(value);
+    if (msb > MAX_MSB)
+        return BUCKETS - 1;
+    int shift = msb - 4;
+    return size_t(shift + 1) * SUB_BUCKETS + size_t(value >> shift) - SUB_BUCKETS;
+}
+
+//  Return the highest value of bucket
+static uint64_t s_bucket_max(size_t bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+        return bucket;
+    size_t   shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub   = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return ((sub + 1) << shift) - 1;
+}
+
+static int64_t s_percentile(const std::vector<uint64_t>& buckets, uint64_t count, uint64_t max, double percentile)
+{
+    if (count == 0)
+        return 0;
+    uint64_t rank = std::max(uint64_t(std::ceil(percentile / 100 * double(count))), uint64_t(1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return int64_t(std::min(s_bucket_max(i), max));
+    }
+    return int64_t(max);
+}
+
+//  Store name as metric name into buffer: lower case, '_' for '-', as the
+//  other metrics of the agent
+static const char* s_metric_name(const char* name, char* buffer, size_t size)
+{
+    size_t i = 0;
+    for (; name[i] && i < size - 1; i++) {
+        buffer[i] = name[i] == '-' ? '_' : char(tolower(static_cast<unsigned char>(name[i])));
+    }
+    buffer[i] = 0;
+    return buffer;
+}
+
+static void s_add_frame(zmsg_t* msg, const char* name, const char* suffix, double value)
+{
+    zmsg_addstrf(msg, "%s%s", name, suffix);
+    zmsg_addstrf(msg, "%.15g", value);
+}
+
+//  --------------------------------------------------------------------------
+//  Add n to counter of the calling thread
+
+void infostats_add(infostats_counter_t counter, uint64_t n)
+{
+    assert(counter < INFOSTATS_COUNTERS);
+    s_add(s_thread_block()->counters[counter], n);
+}
+
+//  --------------------------------------------------------------------------
+//  Record value into histogram of the calling thread
+
+void infostats_record(infostats_histogram_t histogram, int64_t value)
+{
+    assert(histogram < INFOSTATS_HISTOGRAMS);
+    infostats_histogram_data_t& data = s_thread_block()->histograms[histogram];
+    uint64_t                    v    = value > 0 ? uint64_t(value) : 0;
+    s_add(data.buckets[s_bucket(v)], 1);
+    s_add(data.count, 1);
+    s_add(data.sum, v);
+    uint64_t max = data.max.load(std::memory_order_relaxed);
+    while (v > max && !data.max.compare_exchange_weak(max, v, std::memory_order_relaxed)) {
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return counter summed over all threads
+
+uint64_t infostats_counter(infostats_counter_t counter)
+{
+    assert(counter < INFOSTATS_COUNTERS);
+    std::lock_guard<std::mutex> lock(s_blocks_mutex);
+    uint64_t                    sum = 0;
+    for (const auto& block : s_blocks) {
+        sum += block->counters[counter].load(std::memory_order_relaxed);
+    }
+    return sum;
+}
+
+//  --------------------------------------------------------------------------
+//  Return summary of histogram merged over all threads
+
+infostats_summary_t infostats_histogram(infostats_histogram_t histogram)
+{
+    assert(histogram < INFOSTATS_HISTOGRAMS);
+    std::vector<uint64_t> buckets(BUCKETS, 0);
+    uint64_t              count = 0, sum = 0, max = 0;
+    {
+        std::lock_guard<std::mutex> lock(s_blocks_mutex);
+        for (const auto& block : s_blocks) {
+            const infostats_histogram_data_t& data = block->histograms[histogram];
+            for (size_t i = 0; i < BUCKETS; i++) {
+                buckets[i] += data.buckets[i].load(std::memory_order_relaxed);
+            }
+            count += data.count.load(std::memory_order_relaxed);
+            sum += data.sum.load(std::memory_order_relaxed);
+            max = std::max(max, data.max.load(std::memory_order_relaxed));
+        }
+    }
+    // buckets were read one by one, rank against their own total
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    infostats_summary_t summary;
+    summary.count = count;
+    summary.mean  = count ? double(sum) / double(count) : 0;
+    summary.p50   = s_percentile(buckets, total, max, 50);
+    summary.p90   = s_percentile(buckets, total, max, 90);
+    summary.p99   = s_percentile(buckets, total, max, 99);
+    summary.p999  = s_percentile(buckets, total, max, 99.9);
+    summary.max   = int64_t(max);
+    return summary;
+}
+
+//  --------------------------------------------------------------------------
+//  Return name of counter
+
+const char* infostats_counter_name(infostats_counter_t counter)
+{
+    assert(counter < INFOSTATS_COUNTERS);
+    return s_counter_names[counter];
+}
+
+//  --------------------------------------------------------------------------
+//  Return name of histogram
+
+const char* infostats_histogram_name(infostats_histogram_t histogram)
+{
+    assert(histogram < INFOSTATS_HISTOGRAMS);
+    return s_histogram_names[histogram];
+}
+
+//  --------------------------------------------------------------------------
+//  Append name/value frames of all counters and histograms to msg
+
+void infostats_to_msg(zmsg_t* msg)
+{
+    assert(msg);
+    for (int i = 0; i < INFOSTATS_COUNTERS; i++) {
+        infostats_counter_t counter = infostats_counter_t(i);
+        s_add_frame(msg, infostats_counter_name(counter), "", double(infostats_counter(counter)));
+    }
+    for (int i = 0; i < INFOSTATS_HISTOGRAMS; i++) {
+        infostats_histogram_t histogram = infostats_histogram_t(i);
+        infostats_summary_t   summary   = infostats_histogram(histogram);
+        const char*           name      = infostats_histogram_name(histogram);
+        s_add_frame(msg, name, ".count", double(summary.count));
+        s_add_frame(msg, name, ".mean_us", summary.mean);
+        s_add_frame(msg, name, ".p50_us", double(summary.p50));
+        s_add_frame(msg, name, ".p90_us", double(summary.p90));
+        s_add_frame(msg, name, ".p99_us", double(summary.p99));
+        s_add_frame(msg, name, ".p999_us", double(summary.p999));
+        s_add_frame(msg, name, ".max_us", double(summary.max));
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return counters and histograms as self metrics
+
+linuxmetric_list_t* infostats_metrics(void)
+{
+    linuxmetric_list_t* info = linuxmetric_list_new();
+    char                name[64];
+    for (int i = 0; i < INFOSTATS_COUNTERS; i++) {
+        infostats_counter_t counter = infostats_counter_t(i);
+        linuxmetric_add(info, double(infostats_counter(counter)), "item", INFOSTATS_METRIC_COUNT_TEMPLATE,
+            s_metric_name(infostats_counter_name(counter), name, sizeof(name)));
+    }
+    for (int i = 0; i < INFOSTATS_HISTOGRAMS; i++) {
+        infostats_histogram_t histogram = infostats_histogram_t(i);
+        infostats_summary_t   summary   = infostats_histogram(histogram);
+        s_metric_name(infostats_histogram_name(histogram), name, sizeof(name));
+        linuxmetric_add(info, double(summary.count), "item", INFOSTATS_METRIC_COUNT_TEMPLATE, name);
+        linuxmetric_add(info, double(summary.p99) / 1000, "ms", INFOSTATS_METRIC_P99_TEMPLATE, name);
+    }
+    return info;
+}
+
+//  --------------------------------------------------------------------------
+//  Set all counters and histograms to zero
+
+void infostats_reset(void)
+{
+    std::lock_guard<std::mutex> lock(s_blocks_mutex);
+    for (const auto& block : s_blocks) {
+        for (auto& counter : block->counters) {
+            counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto& histogram : block->histograms) {
+            for (auto& bucket : histogram.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+            histogram.count.store(0, std::memory_order_relaxed);
+            histogram.sum.store(0, std::memory_order_relaxed);
+            histogram.max.store(0, std::memory_order_relaxed);
+        }
+    }
+}
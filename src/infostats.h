@@ -0,0 +1,104 @@
+/*  =========================================================================
+    infostats - Counters and latency histograms of the agent
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include <czmq.h>
+#include <stdint.h>
+
+//  Latency histograms, values in microseconds
+typedef enum
+{
+    INFOSTATS_INFO = 0,       // INFO request, until the reply is sent
+    INFOSTATS_INFO_TEST,      // INFO-TEST request
+    INFOSTATS_HW_CAP,         // HW_CAP request
+    INFOSTATS_STATS,          // STATS request
+    INFOSTATS_STREAM,         // ASSETS stream message passed to the topology resolver
+    INFOSTATS_ANNOUNCE,       // announce on ANNOUNCE stream
+    INFOSTATS_METRICS,        // collection and publishing of one metrics interval
+    INFOSTATS_TOPOLOGY_FETCH, // ASSET_DETAIL request to asset-agent
+    INFOSTATS_POLL_LAG,       // how late metrics intervals and burst samples are handled after they are due
+    INFOSTATS_HISTOGRAMS
+} infostats_histogram_t;
+
+//  Counters
+typedef enum
+{
+    INFOSTATS_MAILBOX_ERROR = 0,      // ERROR messages received
+    INFOSTATS_MAILBOX_UNEXPECTED,     // unknown mailbox commands
+    INFOSTATS_REPLY_FAILED,           // mailbox replies which could not be sent
+    INFOSTATS_STREAM_PROCESSED,       // ASSETS messages passed to the topology resolver
+    INFOSTATS_STREAM_IGNORED,         // stream messages which are not (valid) assets
+    INFOSTATS_ANNOUNCE_SENT,          // announces sent
+    INFOSTATS_ANNOUNCE_FAILED,        // announces which could not be sent
+    INFOSTATS_METRIC_FAILED,          // metrics which could not be written to shm
+    INFOSTATS_TOPOLOGY_FETCH_FAILED,  // ASSET_DETAIL requests answered without valid asset
+    INFOSTATS_TOPOLOGY_FETCH_TIMEOUT, // ASSET_DETAIL requests not answered in time
+    INFOSTATS_TOPOLOGY_FETCH_LATE,    // ASSET_DETAIL replies received after the timeout, dropped
+    INFOSTATS_BURST_GAP,              // burst samples taken more than two periods after the previous one
+    INFOSTATS_COUNTERS
+} infostats_counter_t;
+
+//  Summary of a histogram, percentiles are upper bounds of their buckets
+//  (at most 1/16 above the recorded value)
+typedef struct
+{
+    uint64_t count;
+    double   mean;
+    int64_t  p50;
+    int64_t  p90;
+    int64_t  p99;
+    int64_t  p999;
+    int64_t  max;
+} infostats_summary_t;
+
+//  Self metrics of counters and histograms, names in lower case with '_' for '-'
+#define INFOSTATS_METRIC_COUNT_TEMPLATE "fty-info.count.%s"
+#define INFOSTATS_METRIC_P99_TEMPLATE   "fty-info.p99.%s"
+
+//  Add n to counter of the calling thread
+void infostats_add(infostats_counter_t counter, uint64_t n = 1);
+
+//  Record value (usec) into histogram of the calling thread
+void infostats_record(infostats_histogram_t histogram, int64_t value);
+
+//  Return counter summed over all threads
+uint64_t infostats_counter(infostats_counter_t counter);
+
+//  Return summary of histogram merged over all threads
+infostats_summary_t infostats_histogram(infostats_histogram_t histogram);
+
+//  Return name of counter, e.g. "stream.processed"
+const char* infostats_counter_name(infostats_counter_t counter);
+
+//  Return name of histogram, e.g. "mailbox.INFO"
+const char* infostats_histogram_name(infostats_histogram_t histogram);
+
+//  Append name/value frames of all counters and histograms to msg, see the
+//  STATS request in README.md
+void infostats_to_msg(zmsg_t* msg);
+
+//  Return list of metrics with all counters and the count and p99
+//  (in ms) of all histograms
+linuxmetric_list_t* infostats_metrics(void);
+
+//  Set all counters and histograms of all threads to zero
+void infostats_reset(void);
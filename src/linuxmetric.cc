@@ -28,96 +28,50 @@
 
 #include "linuxmetric.h"
 #include "ftyinfo.h"
-#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <fcntl.h>
 #include <fty_log.h>
-#include <iostream>
 #include <limits>
-#include <sstream>
 #include <sys/statvfs.h>
-#include <filesystem>
+#include <sys/sysinfo.h>
+#include <time.h>
+#include <unistd.h>
 
 
-///////////////////////////////////////////
-// Static functions which parse /proc files
-//////////////////////////////////////////
+// arena of the current interval, NULL to allocate metrics on the heap
+static thread_local metricarena_t* s_arena = NULL;
 
-// Get n-th field of the string (counted from 1), which can be parsed as double
-static double s_get_field(std::string line, int index)
-{
-    std::istringstream stream(line);
-    std::string        field;
-    stream.exceptions(std::istringstream::failbit | std::istringstream::badbit);
-    try {
-        int i = 1;
-        while (!stream.eof() && i <= index) {
-            stream >> field;
-            i++;
-        }
-        return std::stod(field);
-    } catch (std::istringstream::failure& e) {
-        log_error("Error while parsing string %s", line.c_str());
-        return std::numeric_limits<double>::quiet_NaN();
-    } catch (std::invalid_argument& e) {
-        log_error("Requested field %s is not a double", field.c_str());
-        return std::numeric_limits<double>::quiet_NaN();
-    } catch (std::out_of_range& e) {
-        log_error("Requested field %s is out of range", field.c_str());
-        return std::numeric_limits<double>::quiet_NaN();
-    }
-}
-
-
-// Get line number n (counted from 1)
-static std::string s_getline_by_number(std::string filename, int index)
+//  Structure of list of metrics
+struct _linuxmetric_list_t
 {
-    std::ifstream file(filename, std::ifstream::in);
-    if (!file) {
-        log_error("Could not open '%s'", filename.c_str());
-        return "";
-    }
+    linuxmetric_t* head;
+    linuxmetric_t* tail;
+    linuxmetric_t* cursor; // of linuxmetric_list_first/next
+    size_t         size;
+    metricarena_t* arena; // owner of the list, NULL if on the heap
+};
 
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-        int         i = 1;
-        std::string line;
-        // ignore first (n-1) lines
-        while (!file.eof() && i < index) {
-            file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-            i++;
-        }
-        std::getline(file, line);
-        return line;
-    } catch (std::ifstream::failure& e) {
-        log_error("Error while reading file %s", filename.c_str());
-        return "";
-    }
-}
+///////////////////////////////////////////
+// Static functions which parse /proc files
+//////////////////////////////////////////
 
-// Get line starting with <name>
-static std::string s_getline_by_name(std::string filename, const char* name)
+// Parse n numbers following the name at the beginning of line, false if the
+// line has fewer of them
+static bool s_get_fields(const char* line, const char* name, double* values, size_t n)
 {
-    std::ifstream file(filename, std::ifstream::in);
-    if (!file) {
-        log_error("Could not open '%s'", filename.c_str());
-        return "";
-    }
-
-    file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-    try {
-        std::string line;
-        do {
-            std::getline(file, line);
-        } while (!file.eof() && strncmp(line.c_str(), name, strlen(name)) != 0);
-        return line;
-    } catch (std::ifstream::failure& e) {
-        log_error("Error while reading file %s", filename.c_str());
-        return "";
+    size_t length = strlen(name);
+    if (strncmp(line, name, length) != 0 || (line[length] != ' ' && line[length] != '\t'))
+        return false;
+    const char* field = line + length;
+    for (size_t i = 0; i < n; i++) {
+        char* end;
+        values[i] = strtod(field, &end);
+        if (end == field)
+            return false;
+        field = end;
     }
-}
-
-static double s_round(double d)
-{
-    return (d - floor(d) > 0.5) ? ceil(d) : floor(d);
+    return true;
 }
 
 ////////////////////////////////////////////////////////////
@@ -125,36 +79,41 @@ static double s_round(double d)
 // All magical constants can be found in /proc and /sys documentation.
 ////////////////////////////////////////////////////////////
 
-static linuxmetric_t* s_uptime(const std::string& root_dir)
+static linuxmetric_t* s_uptime(sourcereader_t* reader)
 {
-    std::string line   = s_getline_by_number(root_dir + "proc/uptime", 1);
-    double      uptime = s_get_field(line, 1);
-
     linuxmetric_t* uptime_info = linuxmetric_new();
-    uptime_info->type          = strdup(LINUXMETRIC_UPTIME);
-    uptime_info->value         = s_round(uptime);
+    uptime_info->type          = linuxmetric_strdup(LINUXMETRIC_UPTIME);
+    uptime_info->value         = linuxmetric_round(linuxmetric_uptime(reader, linuxmetric_live_root(reader)));
     uptime_info->unit          = "sec";
 
     return uptime_info;
 }
 
-static linuxmetric_t* s_cpu_usage(const std::string& root_dir, zhashx_t* history)
-{
-    std::string line_cpu                = s_getline_by_name(root_dir + "proc/stat", "cpu");
-    double      user                    = s_get_field(line_cpu, 2);
-    double      nice                    = s_get_field(line_cpu, 3);
-    double      system                  = s_get_field(line_cpu, 4);
-    double      idle                    = s_get_field(line_cpu, 5);
-    double      iowait                  = s_get_field(line_cpu, 6);
-    double      irq                     = s_get_field(line_cpu, 7);
-    double      softirq                 = s_get_field(line_cpu, 8);
-    double      steal                   = s_get_field(line_cpu, 9);
-    double      numerator               = idle + iowait;
-    double      denominator             = user + nice + system + idle + iowait + irq + softirq + steal;
-    double*     history_numerator_ptr   = static_cast<double*>(zhashx_lookup(history, HIST_CPU_NUMERATOR));
-    double*     history_denominator_ptr = static_cast<double*>(zhashx_lookup(history, HIST_CPU_DENOMINATOR));
-    double      history_numerator       = 0;
-    double      history_denominator     = 0;
+static linuxmetric_t* s_cpu_usage(sourcereader_t* reader, zhashx_t* history)
+{
+    // aggregated cpu line is the first one, the rest of the file (per cpu
+    // lines and interrupt counters) can be truncated
+    char   buf[256];
+    double fields[8];
+    if (sourcereader_read_cached(reader, "proc/stat", buf, sizeof(buf)) <= 0 ||
+        !s_get_fields(buf, "cpu", fields, 8)) {
+        log_error("Could not parse '%sproc/stat'", sourcereader_root_dir(reader).c_str());
+        std::fill(fields, fields + 8, std::numeric_limits<double>::quiet_NaN());
+    }
+    double  user                    = fields[0];
+    double  nice                    = fields[1];
+    double  system                  = fields[2];
+    double  idle                    = fields[3];
+    double  iowait                  = fields[4];
+    double  irq                     = fields[5];
+    double  softirq                 = fields[6];
+    double  steal                   = fields[7];
+    double  numerator               = idle + iowait;
+    double  denominator             = user + nice + system + idle + iowait + irq + softirq + steal;
+    double* history_numerator_ptr   = static_cast<double*>(zhashx_lookup(history, HIST_CPU_NUMERATOR));
+    double* history_denominator_ptr = static_cast<double*>(zhashx_lookup(history, HIST_CPU_DENOMINATOR));
+    double  history_numerator       = 0;
+    double  history_denominator     = 0;
 
     if (history_numerator_ptr && history_denominator_ptr) {
         history_numerator   = *history_numerator_ptr;
@@ -162,9 +121,9 @@ static linuxmetric_t* s_cpu_usage(const std::string& root_dir, zhashx_t* history
     }
 
     linuxmetric_t* cpu_usage_info = linuxmetric_new();
-    cpu_usage_info->type          = strdup(LINUXMETRIC_CPU_USAGE);
+    cpu_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_CPU_USAGE);
     cpu_usage_info->value =
-        s_round(100 - 100 * ((numerator - history_numerator) / (denominator - history_denominator)));
+        linuxmetric_round(100 - 100 * ((numerator - history_numerator) / (denominator - history_denominator)));
     cpu_usage_info->unit = "%";
     /* update or insert numerator and denominator to history */
     if (history_numerator_ptr)
@@ -175,246 +134,863 @@ static linuxmetric_t* s_cpu_usage(const std::string& root_dir, zhashx_t* history
     return cpu_usage_info;
 }
 
-static linuxmetric_t* s_cpu_temperature(const std::string& root_dir)
+// Field of proc/meminfo and its place in linuxmetric_memory_t
+typedef struct
+{
+    const char* name;
+    size_t      offset;
+} meminfo_field_t;
+
+// Parse fields from proc/meminfo content in one pass
+static void s_meminfo_parse(const char* buf, const meminfo_field_t* fields, size_t n, linuxmetric_memory_t* memory)
 {
-    std::string line = s_getline_by_number(root_dir + "sys/class/thermal/thermal_zone0/temp", 1);
-    if (!line.empty()) {
-        double temperature = s_get_field(line, 1);
+    for (const char* line = buf; line && *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+        for (size_t i = 0; i < n; i++) {
+            size_t length = strlen(fields[i].name);
+            if (strncmp(line, fields[i].name, length) == 0) {
+                *reinterpret_cast<double*>(reinterpret_cast<char*>(memory) + fields[i].offset) =
+                    strtod(line + length, NULL);
+                break;
+            }
+        }
+    }
+}
 
-        linuxmetric_t* cpu_temperature_info = linuxmetric_new();
-        cpu_temperature_info->type          = strdup(LINUXMETRIC_CPU_TEMPERATURE);
-        cpu_temperature_info->value         = s_round(temperature / 1000);
-        cpu_temperature_info->unit          = "C";
-        return cpu_temperature_info;
+// Read all memory and swap values in one pass of proc/meminfo
+static bool s_meminfo_read(sourcereader_t* reader, linuxmetric_memory_t* memory)
+{
+    char buf[8192];
+    if (sourcereader_read_cached(reader, "proc/meminfo", buf, sizeof(buf)) <= 0) {
+        log_error("Could not read '%sproc/meminfo'", sourcereader_root_dir(reader).c_str());
+        return false;
     }
-    return NULL;
+
+    static const meminfo_field_t fields[] = {
+        {"MemTotal:", offsetof(linuxmetric_memory_t, total)},
+        {"MemFree:", offsetof(linuxmetric_memory_t, free)},
+        {"Buffers:", offsetof(linuxmetric_memory_t, buffers)},
+        {"Cached:", offsetof(linuxmetric_memory_t, cached)},
+        {"SReclaimable:", offsetof(linuxmetric_memory_t, reclaimable)},
+        {"Shmem:", offsetof(linuxmetric_memory_t, shmem)},
+        {"SwapTotal:", offsetof(linuxmetric_memory_t, swap_total)},
+        {"SwapFree:", offsetof(linuxmetric_memory_t, swap_free)},
+    };
+    s_meminfo_parse(buf, fields, sizeof(fields) / sizeof(fields[0]), memory);
+    return true;
 }
 
-static zlistx_t* s_meminfo(const std::string& root_dir)
+// Memory values of the running kernel when proc/meminfo can't be read.
+// sysinfo(2) reports host values even when meminfo is virtualized (e.g. by
+// lxcfs), so values of both sources are never mixed. It does not report page
+// cache, cached and reclaimable are left NaN.
+static bool s_sysinfo_read(linuxmetric_memory_t* memory)
 {
-    zlistx_t* meminfo = zlistx_new();
+    struct sysinfo info;
+    if (sysinfo(&info) != 0) {
+        log_error("sysinfo failed: %s", strerror(errno));
+        return false;
+    }
+    double unit        = double(info.mem_unit) / 1024; // kB
+    memory->total      = double(info.totalram) * unit;
+    memory->free       = double(info.freeram) * unit;
+    memory->buffers    = double(info.bufferram) * unit;
+    memory->shmem      = double(info.sharedram) * unit;
+    memory->swap_total = double(info.totalswap) * unit;
+    memory->swap_free  = double(info.freeswap) * unit;
+    return true;
+}
 
-    std::string line_total   = s_getline_by_name(root_dir + "proc/meminfo", "MemTotal:");
-    double      memory_total = s_get_field(line_total, 2);
+static linuxmetric_list_t* s_meminfo(const linuxmetric_memory_t& memory)
+{
+    linuxmetric_list_t* meminfo = linuxmetric_list_new();
 
     linuxmetric_t* memory_total_info = linuxmetric_new();
-    memory_total_info->type          = strdup(LINUXMETRIC_MEMORY_TOTAL);
-    memory_total_info->value         = memory_total;
+    memory_total_info->type          = linuxmetric_strdup(LINUXMETRIC_MEMORY_TOTAL);
+    memory_total_info->value         = memory.total;
     memory_total_info->unit          = "kB";
-    zlistx_add_end(meminfo, memory_total_info);
+    linuxmetric_list_add_end(meminfo, memory_total_info);
 
-    std::string line_free      = s_getline_by_name(root_dir + "proc/meminfo", "MemFree:");
-    double      memory_free    = s_get_field(line_free, 2);
-    std::string line_buffers   = s_getline_by_name(root_dir + "proc/meminfo", "Buffers:");
-    double      memory_buffers = s_get_field(line_buffers, 2);
-    std::string line_cached    = s_getline_by_name(root_dir + "proc/meminfo", "Cached:");
-    double      memory_cached  = s_get_field(line_cached, 2);
-    std::string line_reclaim   = s_getline_by_name(root_dir + "proc/meminfo", "SReclaimable:");
-    double      memory_reclaim = s_get_field(line_reclaim, 2);
-    std::string line_shmem     = s_getline_by_name(root_dir + "proc/meminfo", "Shmem:");
-    double      memory_shmem   = s_get_field(line_shmem, 2);
-
-    double memory_used = memory_total - memory_free - (memory_buffers + memory_cached + memory_reclaim - memory_shmem);
+    double memory_used =
+        memory.total - memory.free - (memory.buffers + memory.cached + memory.reclaimable - memory.shmem);
 
     linuxmetric_t* memory_used_info = linuxmetric_new();
-    memory_used_info->type          = strdup(LINUXMETRIC_MEMORY_USED);
+    memory_used_info->type          = linuxmetric_strdup(LINUXMETRIC_MEMORY_USED);
     memory_used_info->value         = memory_used;
     memory_used_info->unit          = "kB";
-    zlistx_add_end(meminfo, memory_used_info);
+    linuxmetric_list_add_end(meminfo, memory_used_info);
 
     linuxmetric_t* memory_usage_info = linuxmetric_new();
-    memory_usage_info->type          = strdup(LINUXMETRIC_MEMORY_USAGE);
-    memory_usage_info->value         = s_round(100 * (memory_used / memory_total));
+    memory_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_MEMORY_USAGE);
+    memory_usage_info->value         = linuxmetric_round(100 * (memory_used / memory.total));
     memory_usage_info->unit          = "%";
-    zlistx_add_end(meminfo, memory_usage_info);
+    linuxmetric_list_add_end(meminfo, memory_usage_info);
 
     return meminfo;
 }
 
-static zlistx_t* s_sdcard_info(const std::string& root_dir)
+static linuxmetric_list_t* s_swapinfo(const linuxmetric_memory_t& memory)
+{
+    linuxmetric_list_t* swapinfo = linuxmetric_list_new();
+
+    double swap_total = memory.swap_total;
+    double swap_free  = memory.swap_free;
+    if (std::isnan(swap_total) || std::isnan(swap_free))
+        return swapinfo;
+
+    double swap_used = swap_total - swap_free;
+
+    linuxmetric_t* swap_total_info = linuxmetric_new();
+    swap_total_info->type          = linuxmetric_strdup(LINUXMETRIC_SWAP_TOTAL);
+    swap_total_info->value         = swap_total;
+    swap_total_info->unit          = "kB";
+    linuxmetric_list_add_end(swapinfo, swap_total_info);
+
+    linuxmetric_t* swap_used_info = linuxmetric_new();
+    swap_used_info->type          = linuxmetric_strdup(LINUXMETRIC_SWAP_USED);
+    swap_used_info->value         = swap_used;
+    swap_used_info->unit          = "kB";
+    linuxmetric_list_add_end(swapinfo, swap_used_info);
+
+    linuxmetric_t* swap_usage_info = linuxmetric_new();
+    swap_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_SWAP_USAGE);
+    swap_usage_info->value         = (swap_total > 0) ? linuxmetric_round(100 * (swap_used / swap_total)) : 0;
+    swap_usage_info->unit          = "%";
+    linuxmetric_list_add_end(swapinfo, swap_usage_info);
+
+    return swapinfo;
+}
+
+// Add rate of counter to the list, nothing is added for the first sample
+static void s_counter_rate(linuxmetric_list_t* list, const char* prefix, const char* counter, double value,
+    const char* type, const char* unit, int interval, zhashx_t* history)
+{
+    if (std::isnan(value))
+        return;
+
+    char   key[128];
+    double rate;
+    snprintf(key, sizeof(key), "%s_%s", prefix, counter);
+    if (linuxmetric_counter_rate(history, key, value, interval, &rate)) {
+        linuxmetric_t* rate_info = linuxmetric_new();
+        rate_info->type          = linuxmetric_strdup(type);
+        rate_info->value         = rate;
+        rate_info->unit          = unit;
+        linuxmetric_list_add_end(list, rate_info);
+    }
+}
+
+static void s_vmstat_rate(linuxmetric_list_t* vmstat_info, const char* counter, double value, const char* type,
+    const char* unit, int interval, zhashx_t* history)
+{
+    s_counter_rate(vmstat_info, VMSTAT_HISTORY_PREFIX, counter, value, type, unit, interval, history);
+}
+
+static bool s_starts_with(const char* name, const char* prefix)
+{
+    return strncmp(name, prefix, strlen(prefix)) == 0;
+}
+
+static linuxmetric_list_t* s_vmstat(sourcereader_t* reader, int interval, zhashx_t* history)
+{
+    linuxmetric_list_t* vmstat_info = linuxmetric_list_new();
+
+    char buf[16384];
+    if (sourcereader_read_cached(reader, "proc/vmstat", buf, sizeof(buf)) <= 0) {
+        log_error("Could not read '%sproc/vmstat'", sourcereader_root_dir(reader).c_str());
+        return vmstat_info;
+    }
+
+    double nan        = std::numeric_limits<double>::quiet_NaN();
+    double pgmajfault = nan, pswpin = nan, pswpout = nan, pgscan = nan, pgsteal = nan, oom_kill = nan;
+
+    // "<name> <value>" lines
+    for (char* name = buf; name && *name; name = strchr(name, '\n') ? strchr(name, '\n') + 1 : NULL) {
+        char* separator = strchr(name, ' ');
+        if (!separator)
+            break;
+        *separator   = '\0';
+        double value = strtod(separator + 1, NULL);
+        if (streq(name, "pgmajfault"))
+            pgmajfault = value;
+        else if (streq(name, "pswpin"))
+            pswpin = value;
+        else if (streq(name, "pswpout"))
+            pswpout = value;
+        else if (streq(name, "oom_kill"))
+            oom_kill = value;
+        // sum per reclaimer (and per zone on old kernels) counters, pgscan_anon/file
+        // on new kernels are the same pages counted once more
+        else if ((s_starts_with(name, "pgscan_kswapd") || s_starts_with(name, "pgscan_direct") ||
+                     s_starts_with(name, "pgscan_khugepaged")) &&
+                 !streq(name, "pgscan_direct_throttle"))
+            pgscan = (std::isnan(pgscan) ? 0 : pgscan) + value;
+        else if (s_starts_with(name, "pgsteal_kswapd") || s_starts_with(name, "pgsteal_direct") ||
+                 s_starts_with(name, "pgsteal_khugepaged"))
+            pgsteal = (std::isnan(pgsteal) ? 0 : pgsteal) + value;
+        name = separator + 1;
+    }
+
+    s_vmstat_rate(vmstat_info, "pgmajfault", pgmajfault, LINUXMETRIC_MAJFAULT_RATE, "/s", interval, history);
+    s_vmstat_rate(vmstat_info, "pswpin", pswpin, LINUXMETRIC_SWAPIN_RATE, "pages/s", interval, history);
+    s_vmstat_rate(vmstat_info, "pswpout", pswpout, LINUXMETRIC_SWAPOUT_RATE, "pages/s", interval, history);
+    s_vmstat_rate(vmstat_info, "pgscan", pgscan, LINUXMETRIC_PGSCAN_RATE, "pages/s", interval, history);
+    s_vmstat_rate(vmstat_info, "pgsteal", pgsteal, LINUXMETRIC_PGSTEAL_RATE, "pages/s", interval, history);
+    s_vmstat_rate(vmstat_info, "oom_kill", oom_kill, LINUXMETRIC_OOM_KILL_RATE, "/s", interval, history);
+
+    return vmstat_info;
+}
+
+// Find "<Proto>.<Name>" counter in content of proc/net/snmp or proc/net/netstat,
+// where each protocol has a line with counter names followed by a line with
+// their values. NaN if there is no such counter.
+static double s_snmp_counter(const char* content, const char* counter)
+{
+    const char* dot           = strchr(counter, '.');
+    size_t      proto_length  = size_t(dot - counter);
+    const char* wanted        = dot + 1;
+    size_t      wanted_length = strlen(wanted);
+
+    const char* names = content;
+    while (names && *names) {
+        const char* values = strchr(names, '\n');
+        if (!values)
+            break;
+        values++;
+        const char* next = strchr(values, '\n');
+        if (strncmp(names, counter, proto_length) == 0 && names[proto_length] == ':' &&
+            strncmp(values, counter, proto_length) == 0 && values[proto_length] == ':') {
+            const char* name  = names + proto_length + 1;
+            const char* value = values + proto_length + 1;
+            for (;;) {
+                name += strspn(name, " ");
+                size_t length = strcspn(name, " \n");
+                char*  end;
+                double number = strtod(value, &end);
+                if (length == 0 || end == value)
+                    break;
+                if (length == wanted_length && strncmp(name, wanted, length) == 0)
+                    return number;
+                name += length;
+                value = end;
+            }
+            break;
+        }
+        names = next ? next + 1 : NULL;
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+static linuxmetric_list_t* s_netstat(sourcereader_t* reader, int interval, zhashx_t* history)
 {
-    zlistx_t* sdcard_info = zlistx_new();
+    linuxmetric_list_t* netstat_info = linuxmetric_list_new();
+
+    // Tcp and Udp counters are in snmp, TcpExt ones in netstat
+    char snmp[8192];
+    char netstat[8192];
+    sourcereader_read_cached(reader, "proc/net/snmp", snmp, sizeof(snmp));
+    sourcereader_read_cached(reader, "proc/net/netstat", netstat, sizeof(netstat));
+
+    double established = s_snmp_counter(snmp, "Tcp.CurrEstab");
+    if (!std::isnan(established)) {
+        linuxmetric_t* established_info = linuxmetric_new();
+        established_info->type          = linuxmetric_strdup(LINUXMETRIC_TCP_ESTABLISHED);
+        established_info->value         = established;
+        established_info->unit          = "connection";
+        linuxmetric_list_add_end(netstat_info, established_info);
+    }
+
+    static const struct
+    {
+        const char* counter;
+        const char* type;
+    } rates[] = {
+        {"Tcp.RetransSegs", LINUXMETRIC_TCP_RETRANS_RATE},
+        {"Tcp.ActiveOpens", LINUXMETRIC_TCP_ACTIVE_OPEN_RATE},
+        {"Tcp.PassiveOpens", LINUXMETRIC_TCP_PASSIVE_OPEN_RATE},
+        {"TcpExt.ListenOverflows", LINUXMETRIC_TCP_LISTEN_OVERFLOW_RATE},
+        {"TcpExt.ListenDrops", LINUXMETRIC_TCP_LISTEN_DROP_RATE},
+        {"Udp.RcvbufErrors", LINUXMETRIC_UDP_RCVBUF_ERROR_RATE},
+    };
+    for (const auto& rate : rates) {
+        double value = s_snmp_counter(snmp, rate.counter);
+        if (std::isnan(value))
+            value = s_snmp_counter(netstat, rate.counter);
+        s_counter_rate(netstat_info, NETSTAT_HISTORY_PREFIX, rate.counter, value, rate.type, "/s", interval, history);
+    }
+
+    return netstat_info;
+}
+
+// statvfs of directory path relative to root_dir of reader ("" for root_dir
+// itself), through the root_dir fd so that no path is concatenated
+static bool s_statvfs(sourcereader_t* reader, const char* path, struct statvfs* buf)
+{
+    int dirfd = sourcereader_dirfd(reader);
+    int fd    = (*path && dirfd >= 0) ? openat(dirfd, path, O_PATH | O_DIRECTORY | O_CLOEXEC) : dirfd;
+    int r     = (fd >= 0) ? fstatvfs(fd, buf) : -1;
+    if (fd >= 0 && fd != dirfd)
+        close(fd);
+    if (r != 0) {
+        log_error("Could not get file system statistics of '%s%s'", sourcereader_root_dir(reader).c_str(), path);
+        return false;
+    }
+    return true;
+}
+
+static linuxmetric_list_t* s_sdcard_info(sourcereader_t* reader)
+{
+    linuxmetric_list_t* sdcard_info = linuxmetric_list_new();
 
     struct statvfs buf;
-    std::string    path(root_dir + "var/");
-    statvfs(path.c_str(), &buf);
+    if (!s_statvfs(reader, "var/", &buf))
+        return sdcard_info;
     int to_MB = 1024 * 1024;
 
     double         sdcard_total      = double(buf.f_blocks * buf.f_frsize);
     linuxmetric_t* sdcard_total_info = linuxmetric_new();
-    sdcard_total_info->type          = strdup(LINUXMETRIC_DATA0_TOTAL);
-    sdcard_total_info->value         = s_round(sdcard_total / to_MB);
+    sdcard_total_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_TOTAL);
+    sdcard_total_info->value         = linuxmetric_round(sdcard_total / to_MB);
     sdcard_total_info->unit          = "MB";
-    zlistx_add_end(sdcard_info, sdcard_total_info);
+    linuxmetric_list_add_end(sdcard_info, sdcard_total_info);
 
     double         sdcard_used      = sdcard_total - double(buf.f_bsize * buf.f_bfree);
     linuxmetric_t* sdcard_used_info = linuxmetric_new();
-    sdcard_used_info->type          = strdup(LINUXMETRIC_DATA0_USED);
-    sdcard_used_info->value         = s_round(sdcard_used / to_MB);
+    sdcard_used_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_USED);
+    sdcard_used_info->value         = linuxmetric_round(sdcard_used / to_MB);
     sdcard_used_info->unit          = "MB";
-    zlistx_add_end(sdcard_info, sdcard_used_info);
+    linuxmetric_list_add_end(sdcard_info, sdcard_used_info);
 
     linuxmetric_t* sdcard_usage_info = linuxmetric_new();
-    sdcard_usage_info->type          = strdup(LINUXMETRIC_DATA0_USAGE);
-    sdcard_usage_info->value         = s_round(100 * (sdcard_used / sdcard_total));
+    sdcard_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_USAGE);
+    sdcard_usage_info->value         = linuxmetric_round(100 * (sdcard_used / sdcard_total));
     sdcard_usage_info->unit          = "%";
-    zlistx_add_end(sdcard_info, sdcard_usage_info);
+    linuxmetric_list_add_end(sdcard_info, sdcard_usage_info);
 
     return sdcard_info;
 }
 
-static zlistx_t* s_flash_info(const std::string& root_dir)
+static linuxmetric_list_t* s_flash_info(sourcereader_t* reader)
 {
-    zlistx_t* flash_info = zlistx_new();
+    linuxmetric_list_t* flash_info = linuxmetric_list_new();
 
     struct statvfs buf;
-    statvfs(root_dir.c_str(), &buf);
+    if (!s_statvfs(reader, "", &buf))
+        return flash_info;
     int to_MB = 1024 * 1024;
 
     double         flash_total      = double(buf.f_blocks * buf.f_frsize);
     linuxmetric_t* flash_total_info = linuxmetric_new();
-    flash_total_info->type          = strdup(LINUXMETRIC_SYSTEM_TOTAL);
-    flash_total_info->value         = s_round(flash_total / to_MB);
+    flash_total_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_TOTAL);
+    flash_total_info->value         = linuxmetric_round(flash_total / to_MB);
     flash_total_info->unit          = "MB";
-    zlistx_add_end(flash_info, flash_total_info);
+    linuxmetric_list_add_end(flash_info, flash_total_info);
 
     // df -h computes "/" usage from f_bavail, let's do the same
     double         flash_used      = flash_total - double(buf.f_bsize * buf.f_bavail);
     linuxmetric_t* flash_used_info = linuxmetric_new();
-    flash_used_info->type          = strdup(LINUXMETRIC_SYSTEM_USED);
-    flash_used_info->value         = s_round(flash_used / to_MB);
+    flash_used_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_USED);
+    flash_used_info->value         = linuxmetric_round(flash_used / to_MB);
     flash_used_info->unit          = "MB";
-    zlistx_add_end(flash_info, flash_used_info);
+    linuxmetric_list_add_end(flash_info, flash_used_info);
 
     linuxmetric_t* flash_usage_info = linuxmetric_new();
-    flash_usage_info->type          = strdup(LINUXMETRIC_SYSTEM_USAGE);
-    flash_usage_info->value         = s_round(100 * (flash_used / flash_total));
+    flash_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_USAGE);
+    flash_usage_info->value         = linuxmetric_round(100 * (flash_used / flash_total));
     flash_usage_info->unit          = "%";
-    zlistx_add_end(flash_info, flash_usage_info);
+    linuxmetric_list_add_end(flash_info, flash_usage_info);
 
     return flash_info;
 }
 
-static bool is_interface_online(const char* interface, const std::string& root_dir)
+// Per interface files are opened relative to the root_dir fd of the reader,
+// paths and history keys are formatted into stack buffers
+
+// Read number from one line sysfs attribute, missing or unsupported (virtual
+// interfaces do not report speed) attributes are not an error
+static bool s_read_number(sourcereader_t* reader, const char* path, double* value)
 {
-    std::string format(root_dir + "sys/class/net/%s");
-    char*       interface_dir = zsys_sprintf(format.c_str(), interface);
-    // is the interface up?
-    char*       interface_state = zsys_sprintf("%s/operstate", interface_dir);
-    std::string state           = s_getline_by_number(interface_state, 1);
-    zstr_free(&interface_state);
-    zstr_free(&interface_dir);
-    return (state == "up");
+    char buf[64];
+    if (sourcereader_read_once(reader, path, buf, sizeof(buf)) <= 0)
+        return false;
+    char*  end;
+    double number = strtod(buf, &end);
+    if (end == buf)
+        return false;
+    *value = number;
+    return true;
 }
 
+// Counters of one interface, read in one sourcereader batch. Index 0 is rx,
+// 1 is tx.
+typedef struct
+{
+    sourcereader_value_t bytes[2];
+    sourcereader_value_t packets[2];
+    sourcereader_value_t errors[2];
+    sourcereader_value_t dropped[2];
+    sourcereader_value_t carrier_changes;
+} interface_counters_t;
+
+static const char* s_directions[] = {"rx", "tx"};
 
-static zlistx_t* s_network_usage(
-    const char* interface, const char* direction, int interval, zhashx_t* history, const std::string& root_dir)
+static void s_queue_statistics(
+    sourcereader_t* reader, const char* interface, const char* direction, const char* name, sourcereader_value_t* value)
 {
-    char*   last_key       = zsys_sprintf("%s_%s_%s", NETWORK_HISTORY_PREFIX, direction, interface);
-    double* value_last_ptr = static_cast<double*>(zhashx_lookup(history, last_key));
-    double  value_last     = 0;
-    if (NULL != value_last_ptr) {
-        value_last = *value_last_ptr;
-        log_trace("%s:key found, value %lf", last_key, value_last);
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "sys/class/net/%s/statistics/%s_%s", interface, direction, name);
+    sourcereader_queue(reader, sourcereader_lookup(reader, path), value);
+}
+
+// Read all counters of interface through files kept open by the reader
+static void s_read_interface(sourcereader_t* reader, const char* interface, interface_counters_t* counters)
+{
+    char path[PATH_MAX];
+    for (size_t i = 0; i < 2; i++) {
+        s_queue_statistics(reader, interface, s_directions[i], "bytes", &counters->bytes[i]);
+        s_queue_statistics(reader, interface, s_directions[i], "packets", &counters->packets[i]);
+        s_queue_statistics(reader, interface, s_directions[i], "errors", &counters->errors[i]);
+        s_queue_statistics(reader, interface, s_directions[i], "dropped", &counters->dropped[i]);
+    }
+    snprintf(path, sizeof(path), "sys/class/net/%s/carrier_changes", interface);
+    sourcereader_queue(reader, sourcereader_lookup(reader, path), &counters->carrier_changes);
+    sourcereader_submit(reader);
+}
+
+// Number read by the batch, NaN if the file was not readable
+static double s_value(const sourcereader_value_t& value)
+{
+    if (value.size <= 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    char*  end;
+    double number = strtod(value.data, &end);
+    return end == value.data ? std::numeric_limits<double>::quiet_NaN() : number;
+}
+
+// Interface statistics counter, NaN on error
+static double s_statistics(
+    const sourcereader_value_t& value, const char* interface, const char* direction, const char* name)
+{
+    double number = s_value(value);
+    if (std::isnan(number))
+        log_error("Could not read 'sys/class/net/%s/statistics/%s_%s'", interface, direction, name);
+    return number;
+}
+
+// Store value under key in history, return the previous one (0 if there is none)
+static double s_history_exchange(zhashx_t* history, const char* key, double value)
+{
+    double* value_ptr  = static_cast<double*>(zhashx_lookup(history, key));
+    double  value_last = 0;
+    if (NULL == value_ptr) {
+        value_ptr = static_cast<double*>(zmalloc(sizeof(double)));
+        zhashx_insert(history, key, value_ptr);
+    } else {
+        value_last = *value_ptr;
+        log_trace("%s:key found, value %lf", key, value_last);
     }
+    *value_ptr = value;
+    return value_last;
+}
+
+static bool is_interface_online(const char* interface, sourcereader_t* reader)
+{
+    char path[PATH_MAX];
+    char state[16];
+    snprintf(path, sizeof(path), "sys/class/net/%s/operstate", interface);
+    // is the interface up?
+    if (sourcereader_read_cached(reader, path, state, sizeof(state)) <= 0)
+        return false;
+    return strncmp(state, "up", 2) == 0 && (state[2] == '\n' || state[2] == '\0');
+}
 
-    zlistx_t* network_usage_info = zlistx_new();
+static linuxmetric_list_t* s_network_usage(
+    const char* interface, const char* direction, double bytes, int interval, zhashx_t* history)
+{
+    linuxmetric_list_t* network_usage_info = linuxmetric_list_new();
 
-    std::string format(root_dir + "sys/class/net/%s/statistics/%s_bytes");
-    char*       path  = zsys_sprintf(format.c_str(), interface, direction);
-    std::string line  = s_getline_by_number(path, 1);
-    double      bytes = s_get_field(line, 1);
+    char key[128];
+    snprintf(key, sizeof(key), "%s_%s_%s", NETWORK_HISTORY_PREFIX, direction, interface);
+    double value_last = s_history_exchange(history, key, bytes);
 
     linuxmetric_t* bandwidth_info = linuxmetric_new();
-    char*          bandwidth_type = zsys_sprintf(BANDWIDTH_TEMPLATE, direction, interface);
-    bandwidth_info->type          = strdup(bandwidth_type);
-    bandwidth_info->value         = s_round((bytes - value_last) / interval);
+    bandwidth_info->type          = linuxmetric_sprintf(BANDWIDTH_TEMPLATE, direction, interface);
+    bandwidth_info->value         = linuxmetric_round((bytes - value_last) / interval);
     bandwidth_info->unit          = "Bps";
-    zlistx_add_end(network_usage_info, bandwidth_info);
+    linuxmetric_list_add_end(network_usage_info, bandwidth_info);
 
     linuxmetric_t* bytes_info = linuxmetric_new();
-    char*          bytes_type = zsys_sprintf(BYTES_TEMPLATE, direction, interface);
-    bytes_info->type          = strdup(bytes_type);
+    bytes_info->type          = linuxmetric_sprintf(BYTES_TEMPLATE, direction, interface);
     bytes_info->value         = bytes;
     bytes_info->unit          = "B";
-    zlistx_add_end(network_usage_info, bytes_info);
+    linuxmetric_list_add_end(network_usage_info, bytes_info);
 
-    // store last value
-    if (NULL == value_last_ptr) {
-        value_last_ptr  = reinterpret_cast<double*>(zmalloc(sizeof(double)));
-        *value_last_ptr = bytes;
-        zhashx_insert(history, last_key, value_last_ptr);
-    } else {
-        *value_last_ptr = bytes;
+    return network_usage_info;
+}
+
+static linuxmetric_t* s_network_error_ratio(
+    const char* interface, const char* direction, double errors, double packets, zhashx_t* history)
+{
+    char key[128];
+    snprintf(key, sizeof(key), "%s_%s_%s_errors", NETWORK_HISTORY_PREFIX, direction, interface);
+    double value_last_errors = s_history_exchange(history, key, errors);
+
+    snprintf(key, sizeof(key), "%s_%s_%s_packets", NETWORK_HISTORY_PREFIX, direction, interface);
+    double value_last_packets = s_history_exchange(history, key, packets);
+
+    linuxmetric_t* error_info = linuxmetric_new();
+    error_info->type          = linuxmetric_sprintf(ERROR_RATIO_TEMPLATE, direction, interface);
+    error_info->value         = linuxmetric_round(100 * (errors - value_last_errors) / (packets - value_last_packets));
+    error_info->unit          = "%";
+    return error_info;
+}
+
+// Link speed (Mbps) and duplex of interface are cached in history and re-read
+// only on link events, i.e. when carrier_changes counter moved since they were
+// read. The counter value of the last read has its own key, the one of the
+// link flaps rate is updated every interval.
+static bool s_link_speed(
+    const char* interface, double carrier_changes, zhashx_t* history, sourcereader_t* reader, double* speed, bool* full_duplex)
+{
+    char speed_key[128], duplex_key[128], carrier_key[128];
+    snprintf(speed_key, sizeof(speed_key), "%s_speed_%s", NETWORK_HISTORY_PREFIX, interface);
+    snprintf(duplex_key, sizeof(duplex_key), "%s_duplex_%s", NETWORK_HISTORY_PREFIX, interface);
+    snprintf(carrier_key, sizeof(carrier_key), "%s_link_carrier_%s", NETWORK_HISTORY_PREFIX, interface);
+    double* speed_ptr   = static_cast<double*>(zhashx_lookup(history, speed_key));
+    double* duplex_ptr  = static_cast<double*>(zhashx_lookup(history, duplex_key));
+    double* carrier_ptr = static_cast<double*>(zhashx_lookup(history, carrier_key));
+    bool    cached      = speed_ptr && duplex_ptr;
+    // unreadable counter is no link event
+    bool link_event = !std::isnan(carrier_changes) && (!carrier_ptr || *carrier_ptr != carrier_changes);
+
+    if (!cached || link_event) {
+        char   path[PATH_MAX];
+        char   duplex[16] = "";
+        double link_speed = 0;
+        snprintf(path, sizeof(path), "sys/class/net/%s/speed", interface);
+        // speed is -1 for link without carrier
+        if (!s_read_number(reader, path, &link_speed) || link_speed < 0)
+            link_speed = 0;
+        snprintf(path, sizeof(path), "sys/class/net/%s/duplex", interface);
+        sourcereader_read_once(reader, path, duplex, sizeof(duplex));
+        log_debug("link of %s: speed %.0lf Mbps, duplex '%s'", interface, link_speed, duplex);
+
+        if (!speed_ptr) {
+            speed_ptr = static_cast<double*>(zmalloc(sizeof(double)));
+            zhashx_insert(history, speed_key, speed_ptr);
+        }
+        if (!duplex_ptr) {
+            duplex_ptr = static_cast<double*>(zmalloc(sizeof(double)));
+            zhashx_insert(history, duplex_key, duplex_ptr);
+        }
+        *speed_ptr  = link_speed;
+        *duplex_ptr = (strncmp(duplex, "half", 4) == 0) ? 0 : 1;
+        if (!std::isnan(carrier_changes)) {
+            if (!carrier_ptr) {
+                carrier_ptr = static_cast<double*>(zmalloc(sizeof(double)));
+                zhashx_insert(history, carrier_key, carrier_ptr);
+            }
+            *carrier_ptr = carrier_changes;
+        }
+    }
+
+    *speed       = *speed_ptr;
+    *full_duplex = *duplex_ptr != 0;
+    return cached;
+}
+
+// Utilization of link, drop rates and link flaps of the interface
+static linuxmetric_list_t* s_network_link(const char* interface, double rx_bandwidth, double tx_bandwidth,
+    const interface_counters_t& counters, int interval, zhashx_t* history, sourcereader_t* reader)
+{
+    linuxmetric_list_t* link_info = linuxmetric_list_new();
+    char      key[128];
+    char      type[128];
+
+    double carrier_changes = s_value(counters.carrier_changes);
+
+    double speed;
+    bool   full_duplex;
+    // bandwidth of the first interval is not a rate, so neither is utilization
+    if (s_link_speed(interface, carrier_changes, history, reader, &speed, &full_duplex) && speed > 0) {
+        double capacity = speed * 1000 * 1000 / 8; // Bps
+        // half duplex link is shared by both directions
+        if (!full_duplex) {
+            rx_bandwidth += tx_bandwidth;
+            tx_bandwidth = rx_bandwidth;
+        }
+        double bandwidths[] = {rx_bandwidth, tx_bandwidth};
+        for (size_t i = 0; i < 2; i++) {
+            linuxmetric_t* utilization_info = linuxmetric_new();
+            utilization_info->type          = linuxmetric_sprintf(UTILIZATION_TEMPLATE, s_directions[i], interface);
+            utilization_info->value         = linuxmetric_round(100 * bandwidths[i] / capacity);
+            utilization_info->unit          = "%";
+            linuxmetric_list_add_end(link_info, utilization_info);
+        }
     }
 
-    zstr_free(&bytes_type);
-    zstr_free(&bandwidth_type);
-    zstr_free(&path);
-    zstr_free(&last_key);
+    for (size_t i = 0; i < 2; i++) {
+        double dropped = s_value(counters.dropped[i]);
+        snprintf(key, sizeof(key), "%s_dropped_%s", s_directions[i], interface);
+        snprintf(type, sizeof(type), DROP_RATE_TEMPLATE, s_directions[i], interface);
+        s_counter_rate(link_info, NETWORK_HISTORY_PREFIX, key, dropped, type, "/s", interval, history);
+    }
 
-    return network_usage_info;
+    if (!std::isnan(carrier_changes)) {
+        snprintf(key, sizeof(key), "%s_carrier_%s", NETWORK_HISTORY_PREFIX, interface);
+        double rate;
+        if (linuxmetric_counter_rate(history, key, carrier_changes, interval, &rate)) {
+            linuxmetric_t* flaps_info = linuxmetric_new();
+            flaps_info->type          = linuxmetric_sprintf(LINK_FLAPS_TEMPLATE, interface);
+            flaps_info->value         = linuxmetric_round(rate * interval);
+            flaps_info->unit          = "change";
+            linuxmetric_list_add_end(link_info, flaps_info);
+        }
+    }
+
+    return link_info;
 }
 
-static linuxmetric_t* s_network_error_ratio(
-    const char* interface, const char* direction, zhashx_t* history, const std::string& root_dir)
-{
-    char*   last_errors_key       = zsys_sprintf("%s_%s_%s_errors", NETWORK_HISTORY_PREFIX, direction, interface);
-    double* value_last_errors_ptr = reinterpret_cast<double*>(zhashx_lookup(history, last_errors_key));
-    double  value_last_errors     = 0;
-    if (NULL != value_last_errors_ptr) {
-        value_last_errors = *value_last_errors_ptr;
-        log_trace("%s:key found, value %lf", last_errors_key, value_last_errors);
+// Call fn(interface, up) for network interfaces passing the filter (all if
+// NULL) in name order, loopback excluded. Number of rejected interfaces is
+// stored in the filter. Interface names are valid only during the call.
+template <typename Fn>
+static void s_each_interface(sourcereader_t* reader, ifacefilter_t* filter, Fn fn)
+{
+    size_t       size;
+    const char** names = sourcereader_list(reader, "sys/class/net", &size);
+    if (!names) {
+        log_error("Could not list network interfaces");
+        return;
     }
+    // stable choice of interfaces when the cap is reached
+    std::sort(names, names + size, [](const char* a, const char* b) { return strcmp(a, b) < 0; });
 
-    char*   last_packets_key       = zsys_sprintf("%s_%s_%s_packets", NETWORK_HISTORY_PREFIX, direction, interface);
-    double* value_last_packets_ptr = reinterpret_cast<double*>(zhashx_lookup(history, last_packets_key));
-    double  value_last_packets     = 0;
-    if (NULL != value_last_packets_ptr) {
-        value_last_packets = *value_last_packets_ptr;
-        log_trace("%s:key found, value %lf", last_packets_key, value_last_packets);
+    size_t up      = 0;
+    size_t dropped = 0;
+    for (size_t i = 0; i < size; i++) {
+        const char* iface = names[i];
+        // we are not interested in loopback
+        if (iface[0] == '.' || streq(iface, "lo"))
+            continue;
+        // filter by name before reading any file of the interface
+        if (filter && !ifacefilter_match(filter, iface)) {
+            dropped++;
+            continue;
+        }
+        bool online = is_interface_online(iface, reader);
+        if (online) {
+            if (filter && ifacefilter_max(filter) > 0 && up >= ifacefilter_max(filter)) {
+                dropped++;
+                continue;
+            }
+            up++;
+        }
+        fn(iface, online);
     }
+    if (filter) {
+        if (dropped != ifacefilter_dropped(filter))
+            log_debug("%zu interfaces are not published", dropped);
+        ifacefilter_set_dropped(filter, dropped);
+    }
+}
 
-    std::string format_errors(root_dir + "sys/class/net/%s/statistics/%s_errors");
-    char*       errors_path = zsys_sprintf(format_errors.c_str(), interface, direction);
-    std::string errors_line = s_getline_by_number(errors_path, 1);
-    double      errors      = s_get_field(errors_line, 1);
+// Network metrics of interface which is up
+static void s_interface_metrics(
+    linuxmetric_list_t* info, const char* iface, int interval, zhashx_t* history, sourcereader_t* reader)
+{
+    interface_counters_t counters;
+    s_read_interface(reader, iface, &counters);
+
+    double rx_bytes = s_statistics(counters.bytes[0], iface, "rx", "bytes");
+    double tx_bytes = s_statistics(counters.bytes[1], iface, "tx", "bytes");
+
+    linuxmetric_list_t* rx = s_network_usage(iface, "rx", rx_bytes, interval, history);
+    linuxmetric_list_t* tx = s_network_usage(iface, "tx", tx_bytes, interval, history);
+    // bandwidth is the first one
+    double rx_bandwidth = linuxmetric_list_first(rx)->value;
+    double tx_bandwidth = linuxmetric_list_first(tx)->value;
+    linuxmetric_list_append(info, &rx);
+    linuxmetric_list_append(info, &tx);
+
+    linuxmetric_list_t* link = s_network_link(iface, rx_bandwidth, tx_bandwidth, counters, interval, history, reader);
+    linuxmetric_list_append(info, &link);
+
+    for (size_t i = 0; i < 2; i++) {
+        linuxmetric_t* error = s_network_error_ratio(iface, s_directions[i],
+            s_statistics(counters.errors[i], iface, s_directions[i], "errors"),
+            s_statistics(counters.packets[i], iface, s_directions[i], "packets"), history);
+        linuxmetric_list_add_end(info, error);
+    }
+}
 
-    std::string format_packets(root_dir + "sys/class/net/%s/statistics/%s_packets");
-    char*       packets_path = zsys_sprintf(format_packets.c_str(), interface, direction);
-    std::string packets_line = s_getline_by_number(packets_path, 1);
-    double      packets      = s_get_field(packets_line, 1);
+//  --------------------------------------------------------------------------
+//  Select arena for new metrics
 
-    linuxmetric_t* error_info = linuxmetric_new();
-    char*          error_type = zsys_sprintf(ERROR_RATIO_TEMPLATE, direction, interface);
-    error_info->type          = strdup(error_type);
-    error_info->value         = s_round(100 * (errors - value_last_errors) / (packets - value_last_packets));
-    error_info->unit          = "%";
+void linuxmetric_set_arena(metricarena_t* arena)
+{
+    s_arena = arena;
+}
 
-    // store last value
-    if (NULL == value_last_errors_ptr) {
-        value_last_errors_ptr  = reinterpret_cast<double*>(zmalloc(sizeof(double)));
-        *value_last_errors_ptr = errors;
-        zhashx_insert(history, last_errors_key, value_last_errors_ptr);
-    } else {
-        *value_last_errors_ptr = errors;
+//  --------------------------------------------------------------------------
+//  Copy metric type
+
+char* linuxmetric_strdup(const char* type)
+{
+    return s_arena ? metricarena_strdup(s_arena, type) : strdup(type);
+}
+
+//  --------------------------------------------------------------------------
+//  Format metric type
+
+char* linuxmetric_sprintf(const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    char* type = s_arena ? metricarena_vprintf(s_arena, format, args) : zsys_vprintf(format, args);
+    va_end(args);
+    return type;
+}
+
+//  --------------------------------------------------------------------------
+//  Add metric at the end of info
+
+void linuxmetric_add(linuxmetric_list_t* info, double value, const char* unit, const char* format, ...)
+{
+    linuxmetric_t* metric = linuxmetric_new();
+    va_list        args;
+    va_start(args, format);
+    metric->type = s_arena ? metricarena_vprintf(s_arena, format, args) : zsys_vprintf(format, args);
+    va_end(args);
+    metric->value = value;
+    metric->unit  = unit;
+    linuxmetric_list_add_end(info, metric);
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new empty list of metrics
+
+linuxmetric_list_t* linuxmetric_list_new(void)
+{
+    linuxmetric_list_t* self;
+    if (s_arena) {
+        self        = static_cast<linuxmetric_list_t*>(metricarena_alloc(s_arena, sizeof(linuxmetric_list_t)));
+        self->arena = s_arena;
+    } else
+        self = static_cast<linuxmetric_list_t*>(zmalloc(sizeof(linuxmetric_list_t)));
+    assert(self);
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy list of metrics
+
+void linuxmetric_list_destroy(linuxmetric_list_t** info_p)
+{
+    assert(info_p);
+    if (*info_p) {
+        linuxmetric_list_t* self   = *info_p;
+        linuxmetric_t*      metric = self->head;
+        while (metric) {
+            linuxmetric_t* next = metric->next;
+            linuxmetric_destroy(&metric);
+            metric = next;
+        }
+        //  lists from arena are released by metricarena_reset
+        if (!self->arena)
+            free(self);
+        *info_p = NULL;
     }
-    // store last value
-    if (NULL == value_last_packets_ptr) {
-        value_last_packets_ptr  = reinterpret_cast<double*>(zmalloc(sizeof(double)));
-        *value_last_packets_ptr = packets;
-        zhashx_insert(history, last_packets_key, value_last_packets_ptr);
-    } else {
-        *value_last_packets_ptr = packets;
+}
+
+//  --------------------------------------------------------------------------
+//  Add metric at the end of list
+
+void linuxmetric_list_add_end(linuxmetric_list_t* info, linuxmetric_t* metric)
+{
+    assert(info);
+    assert(metric);
+    metric->next = NULL;
+    if (info->tail)
+        info->tail->next = metric;
+    else
+        info->head = metric;
+    info->tail = metric;
+    info->size++;
+}
+
+//  --------------------------------------------------------------------------
+//  Move all metrics of other_p at the end of info
+
+void linuxmetric_list_append(linuxmetric_list_t* info, linuxmetric_list_t** other_p)
+{
+    assert(info);
+    assert(other_p);
+    linuxmetric_list_t* other = *other_p;
+    if (other && other->head) {
+        if (info->tail)
+            info->tail->next = other->head;
+        else
+            info->head = other->head;
+        info->tail = other->tail;
+        info->size += other->size;
+        other->head = other->tail = NULL;
     }
+    linuxmetric_list_destroy(other_p);
+}
 
-    zstr_free(&error_type);
-    zstr_free(&packets_path);
-    zstr_free(&errors_path);
-    zstr_free(&last_errors_key);
-    zstr_free(&last_packets_key);
-    return error_info;
+//  --------------------------------------------------------------------------
+//  Return first metric of list
+
+linuxmetric_t* linuxmetric_list_first(linuxmetric_list_t* info)
+{
+    assert(info);
+    info->cursor = info->head;
+    return info->cursor;
+}
+
+//  --------------------------------------------------------------------------
+//  Return next metric of list
+
+linuxmetric_t* linuxmetric_list_next(linuxmetric_list_t* info)
+{
+    assert(info);
+    if (info->cursor)
+        info->cursor = info->cursor->next;
+    return info->cursor;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of metrics in list
+
+size_t linuxmetric_list_size(linuxmetric_list_t* info)
+{
+    assert(info);
+    return info->size;
+}
+
+static void s_history_destructor(void** item)
+{
+    free(*item);
+}
+
+//  --------------------------------------------------------------------------
+//  Create history of collectors
+
+zhashx_t* linuxmetric_history_new(void)
+{
+    zhashx_t* history = zhashx_new();
+    zhashx_set_destructor(history, s_history_destructor);
+    zhashx_insert(history, HIST_CPU_NUMERATOR, zmalloc(sizeof(double)));
+    zhashx_insert(history, HIST_CPU_DENOMINATOR, zmalloc(sizeof(double)));
+    return history;
+}
+
+//  --------------------------------------------------------------------------
+//  Round to the nearest integer, halves down
+
+double linuxmetric_round(double d)
+{
+    return (d - floor(d) > 0.5) ? ceil(d) : floor(d);
 }
 
 //  --------------------------------------------------------------------------
@@ -422,7 +998,12 @@ static linuxmetric_t* s_network_error_ratio(
 
 linuxmetric_t* linuxmetric_new(void)
 {
-    linuxmetric_t* self = static_cast<linuxmetric_t*>(zmalloc(sizeof(linuxmetric_t)));
+    linuxmetric_t* self;
+    if (s_arena) {
+        self        = static_cast<linuxmetric_t*>(metricarena_alloc(s_arena, sizeof(linuxmetric_t)));
+        self->arena = s_arena;
+    } else
+        self = static_cast<linuxmetric_t*>(zmalloc(sizeof(linuxmetric_t)));
     assert(self);
     //  Initialize class properties here
     return self;
@@ -436,150 +1017,177 @@ void linuxmetric_destroy(linuxmetric_t** self_p)
     assert(self_p);
     if (*self_p) {
         linuxmetric_t* self = *self_p;
-        //  Free class properties here
-        zstr_free(&self->type);
-        //  Free object itself
-        free(self);
+        //  metrics from arena are released by metricarena_reset
+        if (!self->arena) {
+            //  Free class properties here
+            zstr_free(&self->type);
+            //  Free object itself
+            free(self);
+        }
         *self_p = NULL;
     }
 }
 
-zhashx_t* linuxmetric_list_interfaces(const std::string& root_dir)
+//  --------------------------------------------------------------------------
+//  Return hash of interfaces passing the filter and their state
+
+zhashx_t* linuxmetric_list_interfaces(sourcereader_t* reader, ifacefilter_t* filter)
 {
-    zhashx_t*           interfaces = zhashx_new();
-    std::filesystem::path dir(root_dir + "sys/class/net/");
+    zhashx_t* interfaces = zhashx_new();
+    s_each_interface(reader, filter, [interfaces](const char* iface, bool up) {
+        zhashx_update(interfaces, iface, const_cast<char*>(up ? "up" : "down"));
+    });
+    return interfaces;
+}
 
-    for (const auto & entry : std::filesystem::directory_iterator(dir)) {
-        std::string iface = entry.path();
-        auto pos = iface.find_last_of("/");
-        if (pos != std::string::npos) {
-            iface = iface.substr(pos + 1);
-        }
+//  --------------------------------------------------------------------------
+//  Return true if reader reads the live host
 
-        // we are not interested in loopback
-        if (iface != "lo") {
-            if (is_interface_online(iface.c_str(), root_dir))
-                zhashx_update(interfaces, iface.c_str(), const_cast<char*>("up"));
-            else
-                zhashx_update(interfaces, iface.c_str(), const_cast<char*>("down"));
-        }
+bool linuxmetric_live_root(sourcereader_t* reader)
+{
+    assert(reader);
+    return sourcereader_root_dir(reader) == "/";
+}
+
+//  --------------------------------------------------------------------------
+//  Return uptime in seconds
+
+double linuxmetric_uptime(sourcereader_t* reader, bool syscalls)
+{
+    assert(reader);
+    if (syscalls) {
+        struct timespec ts;
+        if (clock_gettime(CLOCK_BOOTTIME, &ts) == 0)
+            return double(ts.tv_sec) + double(ts.tv_nsec) / 1e9;
+        log_error("clock_gettime(CLOCK_BOOTTIME) failed: %s", strerror(errno));
     }
+    char buf[64];
+    if (sourcereader_read_cached(reader, "proc/uptime", buf, sizeof(buf)) <= 0) {
+        log_error("Could not read '%sproc/uptime'", sourcereader_root_dir(reader).c_str());
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return strtod(buf, NULL);
+}
 
-    return interfaces;
+//  --------------------------------------------------------------------------
+//  Read memory and swap values in kB
+
+bool linuxmetric_memory(sourcereader_t* reader, bool syscalls, linuxmetric_memory_t* memory)
+{
+    assert(reader);
+    assert(memory);
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    *memory    = {nan, nan, nan, nan, nan, nan, nan, nan};
+    if (s_meminfo_read(reader, memory))
+        return true;
+    return syscalls && s_sysinfo_read(memory);
+}
+
+//  --------------------------------------------------------------------------
+//  Compute rate of a monotonic counter kept in history
+
+bool linuxmetric_counter_rate(zhashx_t* history, const char* key, double value, int interval, double* rate)
+{
+    assert(history);
+    assert(key);
+    double* value_last_ptr = static_cast<double*>(zhashx_lookup(history, key));
+    if (NULL == value_last_ptr) {
+        value_last_ptr  = reinterpret_cast<double*>(zmalloc(sizeof(double)));
+        *value_last_ptr = value;
+        zhashx_insert(history, key, value_last_ptr);
+        return false;
+    }
+
+    double value_last = *value_last_ptr;
+    *value_last_ptr   = value;
+    if (value < value_last || interval <= 0) {
+        log_debug("%s: counter reset (%lf -> %lf)", key, value_last, value);
+        return false;
+    }
+    if (rate)
+        *rate = (value - value_last) / interval;
+    return true;
 }
 
 //--------------------------------------------------------------------------
-//// Create zlistx containing all Linux system info
+//// Create list containing all Linux system info
 
-zlistx_t* linuxmetric_get_all(int interval, zhashx_t* history, const std::string& root_dir, bool metrics_test)
+linuxmetric_list_t* linuxmetric_get_all(
+    int interval, zhashx_t* history, sourcereader_t* reader, bool metrics_test, ifacefilter_t* filter)
 {
-    zlistx_t* info = zlistx_new();
+    linuxmetric_list_t* info = linuxmetric_list_new();
 
-    linuxmetric_t* uptime = s_uptime(root_dir);
-    zlistx_add_end(info, uptime);
-    linuxmetric_t* cpu_usage = s_cpu_usage(root_dir, history);
-    zlistx_add_end(info, cpu_usage);
-    linuxmetric_t* cpu_temperature = s_cpu_temperature(root_dir);
-    if (cpu_temperature != NULL)
-        zlistx_add_end(info, cpu_temperature);
+    linuxmetric_t* uptime = s_uptime(reader);
+    linuxmetric_list_add_end(info, uptime);
+    linuxmetric_t* cpu_usage = s_cpu_usage(reader, history);
+    linuxmetric_list_add_end(info, cpu_usage);
 
-    zlistx_t*      meminfo    = s_meminfo(root_dir);
-    linuxmetric_t* mem_metric = static_cast<linuxmetric_t*>(zlistx_first(meminfo));
-    while (mem_metric) {
-        zlistx_add_end(info, mem_metric);
-        mem_metric = static_cast<linuxmetric_t*>(zlistx_next(meminfo));
-    }
-    zlistx_destroy(&meminfo);
+    linuxmetric_memory_t memory;
+    linuxmetric_memory(reader, linuxmetric_live_root(reader), &memory);
+
+    linuxmetric_list_t* meminfo = s_meminfo(memory);
+    linuxmetric_list_append(info, &meminfo);
+
+    linuxmetric_list_t* swapinfo = s_swapinfo(memory);
+    linuxmetric_list_append(info, &swapinfo);
+
+    linuxmetric_list_t* vmstat_info = s_vmstat(reader, interval, history);
+    linuxmetric_list_append(info, &vmstat_info);
+
+    linuxmetric_list_t* netstat_info = s_netstat(reader, interval, history);
+    linuxmetric_list_append(info, &netstat_info);
 
     if (!metrics_test) {
-        zlistx_t*      sdcard_info   = s_sdcard_info(root_dir);
-        linuxmetric_t* sdcard_metric = static_cast<linuxmetric_t*>(zlistx_first(sdcard_info));
-        while (sdcard_metric) {
-            zlistx_add_end(info, sdcard_metric);
-            sdcard_metric = static_cast<linuxmetric_t*>(zlistx_next(sdcard_info));
-        }
-        zlistx_destroy(&sdcard_info);
+        linuxmetric_list_t* sdcard_info = s_sdcard_info(reader);
+        linuxmetric_list_append(info, &sdcard_info);
 
-        zlistx_t*      flash_info   = s_flash_info(root_dir);
-        linuxmetric_t* flash_metric = static_cast<linuxmetric_t*>(zlistx_first(flash_info));
-        while (flash_metric) {
-            zlistx_add_end(info, flash_metric);
-            flash_metric = static_cast<linuxmetric_t*>(zlistx_next(flash_info));
-        }
-        zlistx_destroy(&flash_info);
+        linuxmetric_list_t* flash_info = s_flash_info(reader);
+        linuxmetric_list_append(info, &flash_info);
     } else {
         linuxmetric_t* sdcard_total_info = linuxmetric_new();
-        sdcard_total_info->type          = strdup(LINUXMETRIC_DATA0_TOTAL);
+        sdcard_total_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_TOTAL);
         sdcard_total_info->value         = 10;
         sdcard_total_info->unit          = "MB";
-        zlistx_add_end(info, sdcard_total_info);
+        linuxmetric_list_add_end(info, sdcard_total_info);
 
         linuxmetric_t* sdcard_used_info = linuxmetric_new();
-        sdcard_used_info->type          = strdup(LINUXMETRIC_DATA0_USED);
+        sdcard_used_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_USED);
         sdcard_used_info->value         = 1;
         sdcard_used_info->unit          = "MB";
-        zlistx_add_end(info, sdcard_used_info);
+        linuxmetric_list_add_end(info, sdcard_used_info);
 
         linuxmetric_t* sdcard_usage_info = linuxmetric_new();
-        sdcard_usage_info->type          = strdup(LINUXMETRIC_DATA0_USAGE);
+        sdcard_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_DATA0_USAGE);
         sdcard_usage_info->value         = 100 * (sdcard_used_info->value / sdcard_total_info->value);
         sdcard_usage_info->unit          = "%";
-        zlistx_add_end(info, sdcard_usage_info);
+        linuxmetric_list_add_end(info, sdcard_usage_info);
 
         linuxmetric_t* flash_total_info = linuxmetric_new();
-        flash_total_info->type          = strdup(LINUXMETRIC_SYSTEM_TOTAL);
+        flash_total_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_TOTAL);
         flash_total_info->value         = 10;
         flash_total_info->unit          = "MB";
-        zlistx_add_end(info, flash_total_info);
+        linuxmetric_list_add_end(info, flash_total_info);
 
         linuxmetric_t* flash_used_info = linuxmetric_new();
-        flash_used_info->type          = strdup(LINUXMETRIC_SYSTEM_USED);
+        flash_used_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_USED);
         flash_used_info->value         = 5;
         flash_used_info->unit          = "MB";
-        zlistx_add_end(info, flash_used_info);
+        linuxmetric_list_add_end(info, flash_used_info);
 
         linuxmetric_t* flash_usage_info = linuxmetric_new();
-        flash_usage_info->type          = strdup(LINUXMETRIC_SYSTEM_USAGE);
+        flash_usage_info->type          = linuxmetric_strdup(LINUXMETRIC_SYSTEM_USAGE);
         flash_usage_info->value         = 100 * (flash_used_info->value / flash_total_info->value);
         flash_usage_info->unit          = "%";
-        zlistx_add_end(info, flash_usage_info);
+        linuxmetric_list_add_end(info, flash_usage_info);
     }
 
     // loop over all network interfaces
-    zhashx_t* interfaces = linuxmetric_list_interfaces(root_dir);
-
-    const char* state = reinterpret_cast<const char*>(zhashx_first(interfaces));
-    while (state != NULL) {
-        const char* iface = reinterpret_cast<const char*>(zhashx_cursor(interfaces));
-        log_trace("interface %s = %s", iface, state);
-
-        if (streq(state, "up")) {
-            zlistx_t*      rx                   = s_network_usage(iface, "rx", interval, history, root_dir);
-            linuxmetric_t* network_usage_metric = static_cast<linuxmetric_t*>(zlistx_first(rx));
-            while (network_usage_metric) {
-                zlistx_add_end(info, network_usage_metric);
-                network_usage_metric = static_cast<linuxmetric_t*>(zlistx_next(rx));
-            }
-            zlistx_destroy(&rx);
-
-            zlistx_t* tx         = s_network_usage(iface, "tx", interval, history, root_dir);
-            network_usage_metric = static_cast<linuxmetric_t*>(zlistx_first(tx));
-            while (network_usage_metric) {
-                zlistx_add_end(info, network_usage_metric);
-                network_usage_metric = static_cast<linuxmetric_t*>(zlistx_next(tx));
-            }
-            zlistx_destroy(&tx);
-
-            linuxmetric_t* rx_error = s_network_error_ratio(iface, "rx", history, root_dir);
-            if (rx_error != NULL)
-                zlistx_add_end(info, rx_error);
-
-            linuxmetric_t* tx_error = s_network_error_ratio(iface, "tx", history, root_dir);
-            if (tx_error != NULL)
-                zlistx_add_end(info, tx_error);
-        }
-        state = reinterpret_cast<const char*>(zhashx_next(interfaces));
-    }
-    zhashx_destroy(&interfaces);
+    s_each_interface(reader, filter, [&](const char* iface, bool up) {
+        log_trace("interface %s = %s", iface, up ? "up" : "down");
+        if (up)
+            s_interface_metrics(info, iface, interval, history, reader);
+    });
+    // counters of interfaces which went down or disappeared are not kept open
+    sourcereader_sweep(reader);
     return info;
 }
@@ -20,6 +20,9 @@
 */
 
 #pragma once
+#include "ifacefilter.h"
+#include "metricarena.h"
+#include "sourcereader.h"
 #include <czmq.h>
 #include <string>
 
@@ -35,30 +38,135 @@
 #define LINUXMETRIC_SYSTEM_TOTAL    "total.system"
 #define LINUXMETRIC_SYSTEM_USED     "used.system"
 #define LINUXMETRIC_SYSTEM_USAGE    "usage.system"
+#define LINUXMETRIC_SWAP_TOTAL      "total.swap"
+#define LINUXMETRIC_SWAP_USED       "used.swap"
+#define LINUXMETRIC_SWAP_USAGE      "usage.swap"
+#define LINUXMETRIC_MAJFAULT_RATE   "majfault_rate.memory"
+#define LINUXMETRIC_SWAPIN_RATE     "swapin_rate.swap"
+#define LINUXMETRIC_SWAPOUT_RATE    "swapout_rate.swap"
+#define LINUXMETRIC_PGSCAN_RATE     "scan_rate.memory"
+#define LINUXMETRIC_PGSTEAL_RATE    "steal_rate.memory"
+#define LINUXMETRIC_OOM_KILL_RATE   "oom_kill_rate.memory"
+
+#define LINUXMETRIC_TCP_ESTABLISHED          "established.tcp"
+#define LINUXMETRIC_TCP_RETRANS_RATE         "retrans_rate.tcp"
+#define LINUXMETRIC_TCP_ACTIVE_OPEN_RATE     "active_open_rate.tcp"
+#define LINUXMETRIC_TCP_PASSIVE_OPEN_RATE    "passive_open_rate.tcp"
+#define LINUXMETRIC_TCP_LISTEN_OVERFLOW_RATE "listen_overflow_rate.tcp"
+#define LINUXMETRIC_TCP_LISTEN_DROP_RATE     "listen_drop_rate.tcp"
+#define LINUXMETRIC_UDP_RCVBUF_ERROR_RATE    "rcvbuf_error_rate.udp"
 
 #define BANDWIDTH_TEMPLATE   "%s_bandwidth.%s"
 #define BYTES_TEMPLATE       "%s_bytes.%s"
 #define ERROR_RATIO_TEMPLATE "%s_error_ratio.%s"
+#define UTILIZATION_TEMPLATE "%s_utilization.%s"
+#define DROP_RATE_TEMPLATE   "%s_drop_rate.%s"
+#define LINK_FLAPS_TEMPLATE  "link_flaps.%s"
 
 struct _linuxmetric_t
 {
-    char*       type;
-    double      value;
-    const char* unit;
+    char*                  type;
+    double                 value;
+    const char*            unit;
+    metricarena_t*         arena; // owner of the metric and its type, NULL if on the heap
+    struct _linuxmetric_t* next;  // next metric of the list holding it
 };
 
 typedef struct _linuxmetric_t linuxmetric_t;
 
+//  List of metrics. Metrics are linked through their next member, so that
+//  adding one does not allocate; a metric is in one list at most.
+typedef struct _linuxmetric_list_t linuxmetric_list_t;
+
+//  Memory and swap values in kB, NaN if not available
+typedef struct
+{
+    double total;
+    double free;
+    double buffers;
+    double cached;
+    double reclaimable;
+    double shmem;
+    double swap_total;
+    double swap_free;
+} linuxmetric_memory_t;
+
 //  Create a new linuxmetric
 linuxmetric_t* linuxmetric_new(void);
 
-//  Destroy the linuxmetric
+//  Destroy the linuxmetric, metrics allocated from arena are only released
+//  by metricarena_reset
 void linuxmetric_destroy(linuxmetric_t** self_p);
 
-// Create zlistx containing all Linux system info
-zlistx_t* linuxmetric_get_all(int interval, zhashx_t* history, const std::string& root_dir, bool metrics_test);
+//  Allocate metrics and their types created by this thread from arena until
+//  it is set to NULL again. Metrics must be destroyed (or forgotten) before
+//  the arena is reset.
+void linuxmetric_set_arena(metricarena_t* arena);
+
+//  Copy metric type, from the arena if one is set, otherwise on the heap
+char* linuxmetric_strdup(const char* type);
+
+//  Format metric type, from the arena if one is set, otherwise on the heap
+char* linuxmetric_sprintf(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+//  Add metric at the end of info, its type is formatted as by linuxmetric_sprintf
+void linuxmetric_add(linuxmetric_list_t* info, double value, const char* unit, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+//  Create a new empty list of metrics, from the arena if one is set
+linuxmetric_list_t* linuxmetric_list_new(void);
+
+//  Destroy list of metrics together with its metrics
+void linuxmetric_list_destroy(linuxmetric_list_t** info_p);
+
+//  Add metric at the end of info, info takes ownership of it
+void linuxmetric_list_add_end(linuxmetric_list_t* info, linuxmetric_t* metric);
+
+//  Move all metrics of other_p at the end of info and destroy other_p
+void linuxmetric_list_append(linuxmetric_list_t* info, linuxmetric_list_t** other_p);
+
+//  Return first metric of info and set cursor to it, NULL if info is empty
+linuxmetric_t* linuxmetric_list_first(linuxmetric_list_t* info);
+
+//  Return metric following the cursor and move the cursor to it, NULL at the end
+linuxmetric_t* linuxmetric_list_next(linuxmetric_list_t* info);
+
+//  Return number of metrics in info
+size_t linuxmetric_list_size(linuxmetric_list_t* info);
+
+//  Create history for linuxmetric_get_all and other collectors, values are
+//  freed with it. CPU usage is computed only when its history is present.
+zhashx_t* linuxmetric_history_new(void);
+
+//  Round to the nearest integer, halves down
+double linuxmetric_round(double d);
+
+// Create list containing all Linux system info read from root_dir of reader,
+// network metrics are published only for interfaces passing the filter (all if NULL)
+linuxmetric_list_t* linuxmetric_get_all(
+    int interval, zhashx_t* history, sourcereader_t* reader, bool metrics_test, ifacefilter_t* filter = NULL);
+
+// Return hash of interface name -> "up"/"down" of interfaces passing the filter
+// (all if NULL), loopback excluded. Number of rejected interfaces is stored in the filter.
+zhashx_t* linuxmetric_list_interfaces(sourcereader_t* reader, ifacefilter_t* filter = NULL);
+
+// Return true if reader reads the live host (root_dir is "/"). Uptime of the
+// live host is then read by a syscall instead of proc/uptime.
+bool linuxmetric_live_root(sourcereader_t* reader);
+
+// Return uptime in seconds, from clock_gettime(CLOCK_BOOTTIME) if syscalls is
+// true, otherwise from proc/uptime under root_dir of reader
+double linuxmetric_uptime(sourcereader_t* reader, bool syscalls);
+
+// Read memory and swap values from one read of proc/meminfo under root_dir of
+// reader. Only if it can't be read and syscalls is true, they come from
+// sysinfo(2), which does not report page cache (cached and reclaimable are NaN).
+bool linuxmetric_memory(sourcereader_t* reader, bool syscalls, linuxmetric_memory_t* memory);
 
-zhashx_t* linuxmetric_list_interfaces(const std::string& root_dir);
+// Store counter value under key in history and compute its change per second
+// since the previous sample. Returns false (and leaves rate untouched) when there
+// is no previous sample yet or when the counter went backwards.
+bool linuxmetric_counter_rate(zhashx_t* history, const char* key, double value, int interval, double* rate);
 
 struct Metric
 {
@@ -0,0 +1,460 @@
+/*  =========================================================================
+    linuxsensors - Class for finding out hardware sensors values
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    linuxsensors - Class for finding out hardware sensors values
+@discuss
+    Discovers all sys/class/thermal/thermal_zone* and sys/class/hwmon/hwmon*
+    temperature and fan inputs once and keeps their files open. Discovery
+    runs again only when a sensor can't be read any more, the number of
+    entries in the class directories changes or the list of online CPUs
+    (sys/devices/system/cpu/online) changes (hotplug).
+
+    CPU frequency (sys/devices/system/cpu/cpuN/cpufreq) and thermal throttle
+    counters (cpuN/thermal_throttle) are discovered the same way and
+    published aggregated over all cores: average frequency, its ratio to the
+    maximal frequency and throttle events per second. Package counters are
+    counted once per physical package. Throttle counters keep one history
+    entry per core and package, the published rate is the sum of their
+    rates, so a core going offline and back does not skew it.
+
+    Metric names are stable: temperature.<zone type> for thermal zones,
+    temperature.<chip>_<label> and fan.<chip>_<label> for hwmon. Duplicate
+    names get the zone/hwmon number as suffix. The CPU zone is also published
+    as temperature.cpu, as it was before.
+@end
+*/
+
+#include "linuxsensors.h"
+#include "ftyinfo.h"
+#include "linuxmetric.h"
+#include <algorithm>
+#include <cmath>
+#include <dirent.h>
+#include <fty_log.h>
+#include <limits>
+#include <map>
+#include <set>
+#include <vector>
+
+#define THERMAL_DIR "sys/class/thermal/"
+#define HWMON_DIR   "sys/class/hwmon/"
+#define CPU_DIR     "sys/devices/system/cpu/"
+
+//  One sensor input
+
+struct linuxsensor_t
+{
+    std::string name;   // part of the metric type
+    const char* type;   // metric type template
+    const char* unit;
+    double      scale;  // raw value is divided by scale
+    int         index;  // number of thermal zone or hwmon, for duplicates
+    bool                 cpu;    // also published as temperature.cpu
+    int                  handle; // sourcereader handle
+    sourcereader_value_t value;  // content read by the last sourcereader_submit
+};
+
+//  Frequency and throttle counters of one CPU core
+
+struct linuxcpu_t
+{
+    int    freq_handle;             // cpufreq/scaling_cur_freq
+    double max_freq;                // cpufreq/cpuinfo_max_freq, 0 if unknown
+    int    core_throttle_handle;    // thermal_throttle/core_throttle_count
+    int    package_throttle_handle; // first core of each package only
+    char   core_key[32];            // history of core_throttle_count
+    char   package_key[32];         // history of package_throttle_count
+
+    sourcereader_value_t freq;
+    sourcereader_value_t core_throttle;
+    sourcereader_value_t package_throttle;
+};
+
+//  Structure of our class
+
+struct _linuxsensors_t
+{
+    sourcereader_t*            reader;
+    std::vector<linuxsensor_t> sensors;
+    std::vector<linuxcpu_t>    cpus;
+    bool                       discovered;
+    bool                       rescan;          // a sensor disappeared
+    size_t                     thermal_entries; // for hotplug detection
+    size_t                     hwmon_entries;
+    int                        online_handle; // CPU_DIR "online"
+    char                       online[SOURCEREADER_VALUE_SIZE]; // its content at discovery
+};
+
+// Replace characters which don't fit into metric type
+static std::string s_sanitize(const char* name)
+{
+    std::string result(name);
+    result.erase(result.find_last_not_of(" \n") + 1);
+    for (char& c : result) {
+        if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '-')
+            c = '_';
+    }
+    return result;
+}
+
+// Return sorted numbers of directory entries "<prefix><number><suffix>"
+static std::vector<int> s_list_numbered(
+    linuxsensors_t* self, const std::string& path, const char* prefix, const char* suffix)
+{
+    std::vector<int> result;
+    const char**     names = sourcereader_list(self->reader, path.c_str(), NULL);
+    if (!names)
+        return result;
+    size_t prefix_len = strlen(prefix);
+    for (; *names; names++) {
+        if (strncmp(*names, prefix, prefix_len) != 0)
+            continue;
+        char* end;
+        long  number = strtol(*names + prefix_len, &end, 10);
+        if (end != *names + prefix_len && streq(end, suffix))
+            result.push_back(int(number));
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static size_t s_count_entries(linuxsensors_t* self, const char* path)
+{
+    size_t count = 0;
+    sourcereader_list(self->reader, path, &count);
+    return count;
+}
+
+// Read one line file (name, type, label), empty string on error
+static std::string s_read_name(linuxsensors_t* self, const std::string& path)
+{
+    char buf[64];
+    if (sourcereader_read_once(self->reader, path.c_str(), buf, sizeof(buf)) <= 0)
+        return "";
+    return s_sanitize(buf);
+}
+
+static void s_add_sensor(linuxsensors_t* self, const std::string& path, const std::string& name, const char* type,
+    const char* unit, double scale, int index, bool cpu)
+{
+    int handle = sourcereader_open(self->reader, path.c_str());
+    if (handle < 0)
+        return;
+    self->sensors.push_back({name, type, unit, scale, index, cpu, handle, {}});
+}
+
+static bool s_is_cpu_zone(const std::string& type)
+{
+    std::string lower(type);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower == "x86_pkg_temp" || lower.find("cpu") != std::string::npos ||
+           lower.find("soc") != std::string::npos;
+}
+
+static void s_discover_thermal(linuxsensors_t* self)
+{
+    std::vector<int> zones    = s_list_numbered(self, THERMAL_DIR, "thermal_zone", "");
+    size_t           first    = self->sensors.size();
+    bool             have_cpu = false;
+    for (int zone : zones) {
+        std::string dir  = std::string(THERMAL_DIR) + "thermal_zone" + std::to_string(zone) + "/";
+        std::string name = s_read_name(self, dir + "type");
+        if (name.empty())
+            name = "thermal_zone" + std::to_string(zone);
+        bool cpu = !have_cpu && s_is_cpu_zone(name);
+        have_cpu = have_cpu || cpu;
+        s_add_sensor(self, dir + "temp", name, TEMPERATURE_TEMPLATE, "C", 1000, zone, cpu);
+    }
+    // keep former behaviour: thermal_zone0 is the CPU one unless we know better
+    if (!have_cpu) {
+        for (size_t i = first; i < self->sensors.size(); i++) {
+            if (self->sensors[i].index == 0)
+                self->sensors[i].cpu = true;
+        }
+    }
+}
+
+static void s_discover_hwmon_inputs(
+    linuxsensors_t* self, const std::string& dir, const std::string& chip, int hwmon, const char* kind)
+{
+    bool temp = streq(kind, "temp");
+    for (int input : s_list_numbered(self, dir, kind, "_input")) {
+        std::string prefix = dir + kind + std::to_string(input);
+        std::string label  = s_read_name(self, prefix + "_label");
+        if (label.empty())
+            label = kind + std::to_string(input);
+        s_add_sensor(self, prefix + "_input", chip + "_" + label, temp ? TEMPERATURE_TEMPLATE : FAN_TEMPLATE,
+            temp ? "C" : "rpm", temp ? 1000 : 1, hwmon, false);
+    }
+}
+
+static void s_discover_hwmon(linuxsensors_t* self)
+{
+    for (int hwmon : s_list_numbered(self, HWMON_DIR, "hwmon", "")) {
+        std::string dir  = std::string(HWMON_DIR) + "hwmon" + std::to_string(hwmon) + "/";
+        std::string chip = s_read_name(self, dir + "name");
+        if (chip.empty())
+            chip = "hwmon" + std::to_string(hwmon);
+        s_discover_hwmon_inputs(self, dir, chip, hwmon, "temp");
+        s_discover_hwmon_inputs(self, dir, chip, hwmon, "fan");
+    }
+}
+
+static void s_discover_cpus(linuxsensors_t* self)
+{
+    std::set<int> packages;
+    char          buf[32];
+    for (int cpu : s_list_numbered(self, CPU_DIR, "cpu", "")) {
+        std::string dir = std::string(CPU_DIR) + "cpu" + std::to_string(cpu) + "/";
+        linuxcpu_t  core;
+        core.freq_handle = sourcereader_open(self->reader, (dir + "cpufreq/scaling_cur_freq").c_str());
+        core.max_freq    = 0;
+        if (sourcereader_read_once(self->reader, (dir + "cpufreq/cpuinfo_max_freq").c_str(), buf, sizeof(buf)) > 0)
+            core.max_freq = strtod(buf, NULL);
+        core.core_throttle_handle =
+            sourcereader_open(self->reader, (dir + "thermal_throttle/core_throttle_count").c_str());
+        snprintf(core.core_key, sizeof(core.core_key), "%s_%d", HIST_CPU_CORE_THROTTLE, cpu);
+
+        // all cores of a package report the same package counter
+        int package = 0;
+        if (sourcereader_read_once(self->reader, (dir + "topology/physical_package_id").c_str(), buf, sizeof(buf)) > 0)
+            package = atoi(buf);
+        core.package_throttle_handle = -1;
+        snprintf(core.package_key, sizeof(core.package_key), "%s_%d", HIST_CPU_PKG_THROTTLE, package);
+        if (packages.insert(package).second)
+            core.package_throttle_handle =
+                sourcereader_open(self->reader, (dir + "thermal_throttle/package_throttle_count").c_str());
+
+        if (core.freq_handle >= 0 || core.core_throttle_handle >= 0 || core.package_throttle_handle >= 0)
+            self->cpus.push_back(core);
+    }
+}
+
+static void s_forget(linuxsensors_t* self)
+{
+    for (auto& sensor : self->sensors) {
+        sourcereader_close(self->reader, sensor.handle);
+    }
+    self->sensors.clear();
+    for (auto& core : self->cpus) {
+        sourcereader_close(self->reader, core.freq_handle);
+        sourcereader_close(self->reader, core.core_throttle_handle);
+        sourcereader_close(self->reader, core.package_throttle_handle);
+    }
+    self->cpus.clear();
+    sourcereader_close(self->reader, self->online_handle);
+    self->online_handle = -1;
+}
+
+// Read list of online CPUs, e.g. "0-3,5", empty if unknown
+static void s_read_online(linuxsensors_t* self, char* buf, size_t size)
+{
+    sourcereader_read(self->reader, self->online_handle, buf, size);
+}
+
+static bool s_online_changed(linuxsensors_t* self)
+{
+    char online[SOURCEREADER_VALUE_SIZE];
+    s_read_online(self, online, sizeof(online));
+    return !streq(online, self->online);
+}
+
+static void s_discover(linuxsensors_t* self)
+{
+    s_forget(self);
+    self->thermal_entries = s_count_entries(self, THERMAL_DIR);
+    self->hwmon_entries   = s_count_entries(self, HWMON_DIR);
+    self->online_handle   = sourcereader_open(self->reader, CPU_DIR "online");
+    s_read_online(self, self->online, sizeof(self->online));
+
+    s_discover_thermal(self);
+    s_discover_hwmon(self);
+    s_discover_cpus(self);
+
+    // make duplicate names unique
+    std::map<std::string, int> count;
+    for (auto& sensor : self->sensors) {
+        count[std::string(sensor.type) + sensor.name]++;
+    }
+    for (auto& sensor : self->sensors) {
+        if (count[std::string(sensor.type) + sensor.name] > 1)
+            sensor.name += "_" + std::to_string(sensor.index);
+    }
+
+    self->discovered = true;
+    self->rescan     = false;
+    log_debug("linuxsensors: discovered %zu sensors and %zu CPUs", self->sensors.size(), self->cpus.size());
+}
+
+static bool s_hotplug(linuxsensors_t* self)
+{
+    return self->rescan || s_count_entries(self, THERMAL_DIR) != self->thermal_entries ||
+           s_count_entries(self, HWMON_DIR) != self->hwmon_entries || s_online_changed(self);
+}
+
+// Return false if counter is opened but can't be read
+static bool s_readable(int handle, const sourcereader_value_t& value)
+{
+    return handle < 0 || value.size > 0;
+}
+
+// Add value of opened counter to sum
+static void s_add_counter(int handle, const sourcereader_value_t& value, double* sum)
+{
+    if (handle >= 0)
+        *sum = (std::isnan(*sum) ? 0 : *sum) + strtod(value.data, NULL);
+}
+
+// Add rate of opened counter, kept in history under its own key, to sum. A
+// core which is skipped or whose counter restarted adds nothing, the others
+// are not affected.
+static void s_add_rate(int handle, const sourcereader_value_t& value, const char* key, int interval,
+    zhashx_t* history, double* sum)
+{
+    double rate;
+    if (handle >= 0 && history &&
+        linuxmetric_counter_rate(history, key, strtod(value.data, NULL), interval, &rate))
+        *sum = (std::isnan(*sum) ? 0 : *sum) + rate;
+}
+
+static void s_cpus_get_all(linuxsensors_t* self, linuxmetric_list_t* info, int interval, zhashx_t* history)
+{
+    double nan      = std::numeric_limits<double>::quiet_NaN();
+    double freq     = nan, max_freq = 0, core_throttle_rate = nan, package_throttle_rate = nan;
+    size_t freq_count = 0;
+    for (auto& core : self->cpus) {
+        // all counters of the core or none of them, not to skew the sums
+        if (!s_readable(core.freq_handle, core.freq) || !s_readable(core.core_throttle_handle, core.core_throttle) ||
+            !s_readable(core.package_throttle_handle, core.package_throttle)) {
+            // CPU went offline
+            log_debug("linuxsensors: can't read CPU counters, will rescan");
+            self->rescan = true;
+            continue;
+        }
+        double core_freq = nan;
+        s_add_counter(core.freq_handle, core.freq, &core_freq);
+        s_add_rate(core.core_throttle_handle, core.core_throttle, core.core_key, interval, history,
+            &core_throttle_rate);
+        s_add_rate(core.package_throttle_handle, core.package_throttle, core.package_key, interval, history,
+            &package_throttle_rate);
+        if (!std::isnan(core_freq)) {
+            freq = (std::isnan(freq) ? 0 : freq) + core_freq;
+            max_freq += core.max_freq;
+            freq_count++;
+        }
+    }
+
+    if (freq_count > 0) {
+        // kHz -> MHz
+        linuxmetric_add(info, linuxmetric_round(freq / double(freq_count) / 1000), "MHz", LINUXMETRIC_CPU_FREQUENCY);
+        if (max_freq > 0)
+            linuxmetric_add(info, linuxmetric_round(100 * freq / max_freq), "%", LINUXMETRIC_CPU_FREQUENCY_RATIO);
+    }
+    // sums of the rates of all cores and packages
+    if (!std::isnan(core_throttle_rate))
+        linuxmetric_add(info, core_throttle_rate, "/s", LINUXMETRIC_CPU_THROTTLE_RATE);
+    if (!std::isnan(package_throttle_rate))
+        linuxmetric_add(info, package_throttle_rate, "/s", LINUXMETRIC_CPU_PKG_THROTTLE_RATE);
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new linuxsensors
+
+linuxsensors_t* linuxsensors_new(sourcereader_t* reader)
+{
+    assert(reader);
+    linuxsensors_t* self = new linuxsensors_t;
+    assert(self);
+    //  Initialize class properties here
+    self->reader          = reader;
+    self->discovered      = false;
+    self->rescan          = false;
+    self->thermal_entries = 0;
+    self->hwmon_entries   = 0;
+    self->online_handle   = -1;
+    self->online[0]       = '\0';
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the linuxsensors
+
+void linuxsensors_destroy(linuxsensors_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        linuxsensors_t* self = *self_p;
+        //  Free class properties here
+        s_forget(self);
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of discovered sensors
+
+size_t linuxsensors_size(linuxsensors_t* self)
+{
+    assert(self);
+    return self->sensors.size() + self->cpus.size();
+}
+
+//  --------------------------------------------------------------------------
+//  Return values of all sensors
+
+linuxmetric_list_t* linuxsensors_get_all(linuxsensors_t* self, int interval, zhashx_t* history)
+{
+    assert(self);
+    if (!self->discovered || s_hotplug(self))
+        s_discover(self);
+
+    // read all sensors at once
+    for (auto& sensor : self->sensors) {
+        sourcereader_queue(self->reader, sensor.handle, &sensor.value);
+    }
+    for (auto& core : self->cpus) {
+        sourcereader_queue(self->reader, core.freq_handle, &core.freq);
+        sourcereader_queue(self->reader, core.core_throttle_handle, &core.core_throttle);
+        sourcereader_queue(self->reader, core.package_throttle_handle, &core.package_throttle);
+    }
+    sourcereader_submit(self->reader);
+
+    linuxmetric_list_t* info = linuxmetric_list_new();
+    for (auto& sensor : self->sensors) {
+        if (sensor.value.size <= 0) {
+            log_debug("linuxsensors: can't read %s, will rescan", sensor.name.c_str());
+            self->rescan = true;
+            continue;
+        }
+        double value = linuxmetric_round(strtod(sensor.value.data, NULL) / sensor.scale);
+        char   type[128];
+        snprintf(type, sizeof(type), sensor.type, sensor.name.c_str());
+        linuxmetric_add(info, value, sensor.unit, "%s", type);
+        if (sensor.cpu && !streq(type, LINUXMETRIC_CPU_TEMPERATURE))
+            linuxmetric_add(info, value, sensor.unit, LINUXMETRIC_CPU_TEMPERATURE);
+    }
+    s_cpus_get_all(self, info, interval, history);
+    return info;
+}
@@ -0,0 +1,49 @@
+/*  =========================================================================
+    linuxsensors - Class for finding out hardware sensors values
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include "sourcereader.h"
+#include <czmq.h>
+
+#define TEMPERATURE_TEMPLATE "temperature.%s"
+#define FAN_TEMPLATE         "fan.%s"
+
+#define LINUXMETRIC_CPU_FREQUENCY        "frequency.cpu"
+#define LINUXMETRIC_CPU_FREQUENCY_RATIO  "frequency_ratio.cpu"
+#define LINUXMETRIC_CPU_THROTTLE_RATE    "throttle_rate.cpu"
+#define LINUXMETRIC_CPU_PKG_THROTTLE_RATE "package_throttle_rate.cpu"
+
+typedef struct _linuxsensors_t linuxsensors_t;
+
+//  Create a new linuxsensors reading sensors through reader
+linuxsensors_t* linuxsensors_new(sourcereader_t* reader);
+
+//  Destroy the linuxsensors
+void linuxsensors_destroy(linuxsensors_t** self_p);
+
+//  Return list of metrics with values of all sensors.
+//  Sensors are discovered on the first call and again only when a sensor
+//  disappears or the list of devices changes.
+linuxmetric_list_t* linuxsensors_get_all(linuxsensors_t* self, int interval, zhashx_t* history);
+
+//  Return number of discovered sensors (including CPU frequency and throttle counters)
+size_t linuxsensors_size(linuxsensors_t* self);
@@ -0,0 +1,59 @@
+/*  =========================================================================
+    metricarena - Monotonic arena for metrics of one interval
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+
+#pragma once
+#include <stdarg.h>
+#include <stddef.h>
+
+#define METRICARENA_SIZE 16384 // initial size, grows to what one interval needs
+
+typedef struct _metricarena_t metricarena_t;
+
+//  Create a new metricarena with first chunk of size bytes
+metricarena_t* metricarena_new(size_t size);
+
+//  Destroy the metricarena and all memory allocated from it
+void metricarena_destroy(metricarena_t** self_p);
+
+//  Allocate size bytes (zeroed, aligned for any type). Memory is valid until
+//  metricarena_reset and is never freed individually.
+void* metricarena_alloc(metricarena_t* self, size_t size);
+
+//  Copy string into the arena
+char* metricarena_strdup(metricarena_t* self, const char* string);
+
+//  Format string into the arena
+char* metricarena_sprintf(metricarena_t* self, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+//  Format string into the arena, va_list version
+char* metricarena_vprintf(metricarena_t* self, const char* format, va_list args);
+
+//  Release everything allocated since the last reset. Memory is kept for the
+//  next interval; if it did not fit into one chunk, chunks are merged into
+//  one large enough, so that a steady state interval does not hit the heap.
+void metricarena_reset(metricarena_t* self);
+
+//  Return number of bytes allocated since the last reset
+size_t metricarena_used(metricarena_t* self);
+
+//  Return number of bytes the arena holds
+size_t metricarena_capacity(metricarena_t* self);
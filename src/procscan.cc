@@ -0,0 +1,294 @@
+/*  =========================================================================
+    procscan - Class for finding out top CPU and memory consuming processes
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    procscan - Class for finding out top CPU and memory consuming processes
+@discuss
+    Processes are scanned incrementally: every call reads /proc/[pid]/stat of
+    at most 'batch' pids (plus the current top processes to keep their rates
+    fresh), so the cost per tick is bounded even with thousands of processes.
+    When all pids of a listing were visited, /proc is listed again and the
+    processes which are not in the new listing are dropped. A process whose
+    stat file can't be read any more is dropped right away.
+
+    Per process history is kept in a hash keyed by pid together with the
+    starttime of the process, so that a reused pid does not inherit the
+    counters of a dead process. CPU usage is the rate between two samples,
+    a process is ranked by CPU only from its second sample on: the lifetime
+    average of a new process is not comparable with the rates of the others.
+
+    The process name (comm) is only logged: metric values are numbers and
+    a metric type per process name would create a new metric for every
+    process which ever made it to the top. Consumers map the published pid
+    to the process.
+@end
+*/
+
+#include "procscan.h"
+#include "linuxmetric.h"
+#include "sourcereader.h"
+#include <algorithm>
+#include <cmath>
+#include <fty_log.h>
+#include <unistd.h>
+#include <vector>
+
+//  Per process history
+
+typedef struct
+{
+    int     pid;
+    char    comm[17];
+    double  starttime; // in clock ticks since boot
+    double  ticks;     // utime + stime
+    double  rss;       // kB
+    double  cpu;       // % of one CPU, NaN until the second sample
+    int64_t scanned;   // zclock_mono() of the last scan
+} procscan_entry_t;
+
+//  Structure of our class
+
+struct _procscan_t
+{
+    sourcereader_t*                reader; // of root_dir
+    size_t                         top;
+    size_t                         batch;
+    std::vector<int>               pids;      // last listing of /proc
+    size_t                         cursor;    // next pid to scan in pids
+    std::vector<int>               hot;       // pids of the top processes of the last call
+    std::vector<int>               gone;      // pids to drop, kept to reuse its buffer
+    std::vector<procscan_entry_t*> entries;   // for ranking, kept to reuse its buffer
+    zhashx_t*                      processes; // "pid" -> procscan_entry_t
+    double                         clk_tck;
+    double                         page_kb;
+};
+
+static void s_entry_destructor(void** item)
+{
+    free(*item);
+}
+
+// List numerical entries of <root_dir>/proc
+static void s_list_pids(procscan_t* self)
+{
+    self->pids.clear();
+    self->cursor = 0;
+
+    const char** names = sourcereader_list(self->reader, "proc", NULL);
+    if (!names) {
+        log_error("Could not list '%sproc'", sourcereader_root_dir(self->reader).c_str());
+        return;
+    }
+    for (; *names; names++) {
+        char* end;
+        long  pid = strtol(*names, &end, 10);
+        if (*end == '\0' && pid > 0)
+            self->pids.push_back(int(pid));
+    }
+    std::sort(self->pids.begin(), self->pids.end());
+}
+
+// Drop processes which are not in the new listing
+static void s_purge(procscan_t* self)
+{
+    self->gone.clear();
+    procscan_entry_t* entry = static_cast<procscan_entry_t*>(zhashx_first(self->processes));
+    while (entry) {
+        if (!std::binary_search(self->pids.begin(), self->pids.end(), entry->pid))
+            self->gone.push_back(entry->pid);
+        entry = static_cast<procscan_entry_t*>(zhashx_next(self->processes));
+    }
+    for (int pid : self->gone) {
+        char key[16];
+        snprintf(key, sizeof(key), "%d", pid);
+        zhashx_delete(self->processes, key);
+    }
+}
+
+// Read /proc/[pid]/stat and update its history, return NULL if process is gone
+static procscan_entry_t* s_scan_pid(procscan_t* self, int pid, int64_t now)
+{
+    char key[16];
+    char path[PATH_MAX];
+    char buf[1024];
+    snprintf(key, sizeof(key), "%d", pid);
+    snprintf(path, sizeof(path), "proc/%d/stat", pid);
+    if (sourcereader_read_once(self->reader, path, buf, sizeof(buf)) <= 0) {
+        zhashx_delete(self->processes, key);
+        return NULL;
+    }
+
+    // comm may contain spaces and parentheses, it ends with the last ')'
+    char* comm_start = strchr(buf, '(');
+    char* comm_end   = strrchr(buf, ')');
+    if (!comm_start || !comm_end || comm_end < comm_start)
+        return NULL;
+    *comm_end = '\0';
+
+    double ticks = 0, starttime = 0, rss = 0;
+    char*  save;
+    int    field = 3; // first field after comm is state
+    for (char* token = strtok_r(comm_end + 1, " ", &save); token && field <= 24;
+         token       = strtok_r(NULL, " ", &save), field++) {
+        if (field == 14 || field == 15)
+            ticks += strtod(token, NULL);
+        else if (field == 22)
+            starttime = strtod(token, NULL);
+        else if (field == 24)
+            rss = strtod(token, NULL) * self->page_kb;
+    }
+    if (field <= 24) {
+        log_debug("procscan: can't parse '%s'", path);
+        return NULL;
+    }
+
+    procscan_entry_t* entry = static_cast<procscan_entry_t*>(zhashx_lookup(self->processes, key));
+    if (!entry) {
+        entry = static_cast<procscan_entry_t*>(zmalloc(sizeof(procscan_entry_t)));
+        zhashx_insert(self->processes, key, entry);
+    }
+    if (entry->pid != pid || entry->starttime != starttime) {
+        // new process, or pid reused by another one: no rate until the next sample
+        entry->pid       = pid;
+        entry->starttime = starttime;
+        entry->cpu       = NAN;
+    } else if (now > entry->scanned) {
+        entry->cpu = 100 * ((ticks - entry->ticks) / self->clk_tck) / (double(now - entry->scanned) / 1000);
+    }
+    snprintf(entry->comm, sizeof(entry->comm), "%s", comm_start + 1);
+    entry->ticks   = ticks;
+    entry->rss     = rss;
+    entry->scanned = now;
+    return entry;
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new procscan
+
+procscan_t* procscan_new(const std::string& root_dir, size_t top, size_t batch)
+{
+    procscan_t* self = new procscan_t;
+    assert(self);
+    //  Initialize class properties here
+    self->reader    = sourcereader_new(root_dir);
+    self->top       = top;
+    self->batch     = batch ? batch : DEFAULT_PROCSCAN_BATCH;
+    self->cursor    = 0;
+    self->processes = zhashx_new();
+    zhashx_set_destructor(self->processes, s_entry_destructor);
+    self->hot.reserve(top);
+    self->clk_tck = double(sysconf(_SC_CLK_TCK));
+    self->page_kb = double(sysconf(_SC_PAGESIZE)) / 1024;
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the procscan
+
+void procscan_destroy(procscan_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        procscan_t* self = *self_p;
+        //  Free class properties here
+        zhashx_destroy(&self->processes);
+        sourcereader_destroy(&self->reader);
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of processes kept in the cache
+
+size_t procscan_size(procscan_t* self)
+{
+    assert(self);
+    return zhashx_size(self->processes);
+}
+
+//  --------------------------------------------------------------------------
+//  Scan next batch of processes and return top processes
+
+linuxmetric_list_t* procscan_get_all(procscan_t* self)
+{
+    assert(self);
+    int64_t now = zclock_mono();
+
+    if (self->cursor >= self->pids.size()) {
+        s_list_pids(self);
+        s_purge(self);
+    }
+
+    // keep rates of the current top processes fresh
+    for (int pid : self->hot) {
+        s_scan_pid(self, pid, now);
+    }
+
+    size_t end = std::min(self->cursor + self->batch, self->pids.size());
+    for (; self->cursor < end; self->cursor++) {
+        int pid = self->pids[self->cursor];
+        if (std::find(self->hot.begin(), self->hot.end(), pid) == self->hot.end())
+            s_scan_pid(self, pid, now);
+    }
+
+    // processes with a CPU rate first, only those are ranked by CPU
+    std::vector<procscan_entry_t*>& entries = self->entries;
+    entries.clear();
+    size_t            rated = 0;
+    procscan_entry_t* entry = static_cast<procscan_entry_t*>(zhashx_first(self->processes));
+    while (entry) {
+        entries.push_back(entry);
+        if (!std::isnan(entry->cpu))
+            std::swap(entries[rated++], entries.back());
+        entry = static_cast<procscan_entry_t*>(zhashx_next(self->processes));
+    }
+
+    linuxmetric_list_t* info = linuxmetric_list_new();
+    size_t              top  = std::min(self->top, rated);
+    self->hot.clear();
+
+    std::partial_sort(entries.begin(), entries.begin() + long(top), entries.begin() + long(rated),
+        [](const procscan_entry_t* a, const procscan_entry_t* b) {
+            return a->cpu > b->cpu;
+        });
+    for (size_t i = 0; i < top; i++) {
+        log_debug("procscan: top CPU %zu: %d (%s) %.1lf%%", i + 1, entries[i]->pid, entries[i]->comm, entries[i]->cpu);
+        linuxmetric_add(info, entries[i]->cpu, "%", PROCESS_CPU_TEMPLATE, i + 1);
+        linuxmetric_add(info, entries[i]->pid, "pid", PROCESS_CPU_PID_TEMPLATE, i + 1);
+        self->hot.push_back(entries[i]->pid);
+    }
+
+    top = std::min(self->top, entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + long(top), entries.end(),
+        [](const procscan_entry_t* a, const procscan_entry_t* b) {
+            return a->rss > b->rss;
+        });
+    for (size_t i = 0; i < top; i++) {
+        log_debug("procscan: top memory %zu: %d (%s) %.0lf kB", i + 1, entries[i]->pid, entries[i]->comm, entries[i]->rss);
+        linuxmetric_add(info, entries[i]->rss, "kB", PROCESS_MEMORY_TEMPLATE, i + 1);
+        linuxmetric_add(info, entries[i]->pid, "pid", PROCESS_MEMORY_PID_TEMPLATE, i + 1);
+    }
+
+    return info;
+}
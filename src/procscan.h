@@ -0,0 +1,50 @@
+/*  =========================================================================
+    procscan - Class for finding out top CPU and memory consuming processes
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include <czmq.h>
+#include <string>
+
+#define PROCESS_CPU_TEMPLATE        "process_cpu.%zu"
+#define PROCESS_CPU_PID_TEMPLATE    "process_cpu_pid.%zu"
+#define PROCESS_MEMORY_TEMPLATE     "process_memory.%zu"
+#define PROCESS_MEMORY_PID_TEMPLATE "process_memory_pid.%zu"
+
+#define DEFAULT_PROCSCAN_TOP   5
+#define DEFAULT_PROCSCAN_BATCH 256
+
+typedef struct _procscan_t procscan_t;
+
+//  Create a new procscan reading <root_dir>/proc (a missing trailing '/' of
+//  root_dir is added), publishing top processes
+//  and reading at most batch /proc/[pid]/stat files per call
+procscan_t* procscan_new(const std::string& root_dir, size_t top, size_t batch);
+
+//  Destroy the procscan
+void procscan_destroy(procscan_t** self_p);
+
+//  Scan next batch of processes and return zlistx of linuxmetric_t with
+//  the top processes by CPU usage and by resident memory
+linuxmetric_list_t* procscan_get_all(procscan_t* self);
+
+//  Return number of processes kept in the cache
+size_t procscan_size(procscan_t* self);
@@ -0,0 +1,223 @@
+/*  =========================================================================
+    selfmetric - Class for finding out resource usage of fty-info itself
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    selfmetric - Class for finding out resource usage of fty-info itself
+@discuss
+    Reads /proc/self/{stat,statm,status,fd} of the running agent, so that
+    slow leaks (RSS, heap, fds, history cache) are visible as metrics.
+@end
+*/
+
+#include "selfmetric.h"
+#include "linuxmetric.h"
+#include <cmath>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fty_log.h>
+#include <limits>
+#include <malloc.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define SELF_PROC_DIR "/proc/self/"
+
+// Read whole (small) file into buf, NUL terminated. Returns number of bytes
+// read, -1 on error.
+static ssize_t s_read_file(const char* filename, char* buf, size_t size)
+{
+    int fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_error("Could not open '%s'", filename);
+        return -1;
+    }
+    ssize_t length = pread(fd, buf, size - 1, 0);
+    close(fd);
+    if (length < 0) {
+        log_error("Could not read '%s'", filename);
+        return -1;
+    }
+    buf[length] = '\0';
+    return length;
+}
+
+static linuxmetric_t* s_metric_new(const char* type, double value, const char* unit)
+{
+    linuxmetric_t* metric = linuxmetric_new();
+    metric->type          = linuxmetric_strdup(type);
+    metric->value         = value;
+    metric->unit          = unit;
+    return metric;
+}
+
+// utime + stime (in clock ticks) from /proc/self/stat, NaN on error
+static double s_cpu_ticks()
+{
+    char buf[1024];
+    // comm (field 2) may contain spaces, fields are counted after the last ')'
+    const char* field = (s_read_file(SELF_PROC_DIR "stat", buf, sizeof(buf)) > 0) ? strrchr(buf, ')') : NULL;
+    double      utime = std::numeric_limits<double>::quiet_NaN();
+    double      stime = std::numeric_limits<double>::quiet_NaN();
+    // field 3 (state) is the first after ')', utime is 14, stime is 15
+    for (int i = 3; field && i <= 15; i++) {
+        field = strchr(field, ' ');
+        if (!field)
+            break;
+        field++;
+        if (i == 14)
+            utime = strtod(field, NULL);
+        else if (i == 15)
+            stime = strtod(field, NULL);
+    }
+    return utime + stime;
+}
+
+// resident set size in kB from /proc/self/statm
+static double s_rss_kb()
+{
+    char buf[256];
+    if (s_read_file(SELF_PROC_DIR "statm", buf, sizeof(buf)) <= 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    char* size_end;
+    char* resident_end;
+    strtod(buf, &size_end);
+    double resident = strtod(size_end, &resident_end);
+    if (size_end == buf || resident_end == size_end)
+        return std::numeric_limits<double>::quiet_NaN();
+    return resident * double(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+// Threads: line of /proc/self/status
+static double s_threads()
+{
+    char buf[4096];
+    if (s_read_file(SELF_PROC_DIR "status", buf, sizeof(buf)) <= 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    const char* line = strstr(buf, "\nThreads:");
+    if (!line)
+        return std::numeric_limits<double>::quiet_NaN();
+    return strtod(line + 9, NULL);
+}
+
+// number of entries in /proc/self/fd, without the one used for listing it.
+// Listed by getdents64 into a stack buffer, readdir() would allocate one.
+static double s_open_fds()
+{
+    int fd = open(SELF_PROC_DIR "fd", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        log_error("Could not open '%s'", SELF_PROC_DIR "fd");
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    alignas(struct dirent64) char buf[4096];
+    int                           count = 0;
+    long                          length;
+    while ((length = syscall(SYS_getdents64, fd, buf, sizeof(buf))) > 0) {
+        for (long pos = 0; pos < length;) {
+            const struct dirent64* entry = reinterpret_cast<const struct dirent64*>(buf + pos);
+            pos += entry->d_reclen;
+            if (entry->d_name[0] != '.')
+                count++;
+        }
+    }
+    close(fd);
+    if (length < 0) {
+        log_error("Could not list '%s'", SELF_PROC_DIR "fd");
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return count - 1;
+}
+
+// bytes allocated by malloc, both from the heap and mmap-ed chunks
+static double s_heap_bytes()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+#else
+    struct mallinfo info = mallinfo();
+#endif
+    return double(info.uordblks) + double(info.hblkhd);
+}
+
+//--------------------------------------------------------------------------
+//// Create list containing resource usage of this process
+
+linuxmetric_list_t* selfmetric_get_all(
+    int interval, zhashx_t* history, size_t assets_size, size_t dropped_interfaces)
+{
+    linuxmetric_list_t* info = linuxmetric_list_new();
+
+    double ticks = s_cpu_ticks();
+    double rate;
+    if (!std::isnan(ticks) && linuxmetric_counter_rate(history, HIST_SELF_CPU_TICKS, ticks, interval, &rate)) {
+        // percent of one CPU
+        double usage = 100 * rate / double(sysconf(_SC_CLK_TCK));
+        linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_CPU_USAGE, usage, "%"));
+    }
+
+    double rss = s_rss_kb();
+    if (!std::isnan(rss))
+        linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_MEMORY_RSS, rss, "kB"));
+
+    linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_MEMORY_HEAP, s_heap_bytes(), "B"));
+
+    double fds = s_open_fds();
+    if (!std::isnan(fds))
+        linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_FD_OPEN, fds, "fd"));
+
+    double threads = s_threads();
+    if (!std::isnan(threads))
+        linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_THREADS, threads, "thread"));
+
+    linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_HISTORY_SIZE, double(zhashx_size(history)), "item"));
+    linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_ASSETS_SIZE, double(assets_size), "item"));
+    linuxmetric_list_add_end(info, s_metric_new(SELFMETRIC_IFACE_DROPPED, double(dropped_interfaces), "interface"));
+
+    return info;
+}
+
+//--------------------------------------------------------------------------
+//// Create list containing cost of collecting another root filesystem
+
+linuxmetric_list_t* selfmetric_target(const char* iname, int64_t duration, size_t history_size, size_t open_files)
+{
+    assert(iname);
+    linuxmetric_list_t* info   = linuxmetric_list_new();
+    linuxmetric_t*      metric = linuxmetric_new();
+    metric->type          = linuxmetric_sprintf(SELFMETRIC_TARGET_DURATION_TEMPLATE, iname);
+    metric->value         = double(duration) / 1000;
+    metric->unit          = "ms";
+    linuxmetric_list_add_end(info, metric);
+
+    metric        = linuxmetric_new();
+    metric->type  = linuxmetric_sprintf(SELFMETRIC_TARGET_HISTORY_TEMPLATE, iname);
+    metric->value = double(history_size);
+    metric->unit  = "item";
+    linuxmetric_list_add_end(info, metric);
+
+    metric        = linuxmetric_new();
+    metric->type  = linuxmetric_sprintf(SELFMETRIC_TARGET_FD_TEMPLATE, iname);
+    metric->value = double(open_files);
+    metric->unit  = "fd";
+    linuxmetric_list_add_end(info, metric);
+
+    return info;
+}
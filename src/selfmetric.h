@@ -0,0 +1,54 @@
+/*  =========================================================================
+    selfmetric - Class for finding out resource usage of fty-info itself
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include <czmq.h>
+
+#define SELFMETRIC_CPU_USAGE     "fty-info.usage.cpu"
+#define SELFMETRIC_MEMORY_RSS    "fty-info.rss.memory"
+#define SELFMETRIC_MEMORY_HEAP   "fty-info.heap.memory"
+#define SELFMETRIC_FD_OPEN       "fty-info.open.fd"
+#define SELFMETRIC_THREADS       "fty-info.count.thread"
+#define SELFMETRIC_HISTORY_SIZE  "fty-info.size.history"
+#define SELFMETRIC_ASSETS_SIZE   "fty-info.size.assets"
+#define SELFMETRIC_IFACE_DROPPED "fty-info.dropped.interface"
+
+// cost of collecting other root filesystems, per target iname
+#define SELFMETRIC_TARGET_DURATION_TEMPLATE "fty-info.duration.%s"
+#define SELFMETRIC_TARGET_HISTORY_TEMPLATE  "fty-info.size.history.%s"
+#define SELFMETRIC_TARGET_FD_TEMPLATE       "fty-info.open.fd.%s"
+
+// values within history
+#define HIST_SELF_CPU_TICKS "self_cpu_ticks"
+
+// Create list of metrics describing resource usage of this process.
+// history is the same hash used by linuxmetric_get_all, assets_size is the
+// number of assets cached by the topology resolver, dropped_interfaces the
+// number of network interfaces not published because of the interface filter.
+// Note: always reads /proc/self of the running process, regardless of root_dir.
+linuxmetric_list_t* selfmetric_get_all(
+    int interval, zhashx_t* history, size_t assets_size, size_t dropped_interfaces);
+
+// Create list of metrics describing the cost of collecting target iname:
+// duration of its last collection (given in microseconds, published in ms),
+// size of its history and number of its open files.
+linuxmetric_list_t* selfmetric_target(const char* iname, int64_t duration, size_t history_size, size_t open_files);
@@ -0,0 +1,567 @@
+/*  =========================================================================
+    sourcereader - Class for reading /proc and /sys files through cached fds
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    sourcereader - Class for reading /proc and /sys files through cached fds
+@discuss
+    Files which are read every interval are opened once and re-read with
+    pread() from offset 0, which makes kernel regenerate their content. This
+    saves open/close syscalls and path building for each value.
+
+    root_dir is opened once as a directory fd and all files are opened with
+    openat() relative to it, so collectors pass constant relative paths (or
+    paths formatted into stack buffers) and never concatenate root_dir.
+
+    Files of which only the path is known at read time (e.g. per interface
+    counters) are opened once by sourcereader_lookup and cached by path, so
+    they can be queued like any other opened file. Files read every interval
+    which don't fit into a queued value (proc/stat, meminfo, vmstat, net/snmp)
+    are cached the same way and read by sourcereader_read_cached.
+    sourcereader_read_once uses a transient fd which is never registered, it
+    is left for files read only on events (e.g. link speed).
+
+    Directories listed every interval (network interfaces, hotplug checks)
+    are read by sourcereader_list into buffers kept by the reader instead of
+    readdir(), which allocates a buffer for every opened directory.
+
+    Collectors queue reads of all their files and submit them together. When
+    fty-info is built with liburing (WITH_IO_URING) and the kernel supports
+    io_uring, the opened fds are kept in a sparse table of registered files,
+    updated slot by slot on open and close, and all queued reads are submitted
+    and reaped with a single io_uring_enter() call. Otherwise, or when the
+    ring can't be set up, files are read one by one with pread().
+@end
+*/
+
+#include "sourcereader.h"
+#include <algorithm>
+#include <assert.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fty_log.h>
+#include <map>
+#include <set>
+#include <string.h>
+#include <string_view>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#define RING_ENTRIES 64
+#define RING_FILES   64 // initial size of the registered file table
+
+//  File cached by sourcereader_lookup
+
+typedef struct
+{
+    int  fd;
+    bool used; // looked up since the last sweep
+} cached_t;
+
+//  Structure of our class
+
+struct _sourcereader_t
+{
+    std::string                                        root_dir;
+    int                                                dirfd;
+    std::set<int>                                      fds;
+    std::map<std::string, cached_t, std::less<>>       paths;  // cached by sourcereader_lookup
+    std::set<int>                                      failed; // fds of which the last read failed
+    sourcereader_backend_t                             backend;
+    std::vector<std::pair<int, sourcereader_value_t*>> queue; // handle and destination
+    std::vector<char>                                  names;   // of the last sourcereader_list
+    std::vector<size_t>                                offsets; // of entries in names
+    std::vector<const char*>                           entries; // NULL terminated, pointers into names
+#ifdef HAVE_LIBURING
+    struct io_uring    ring;
+    bool               ring_ready;
+    bool               files_dirty; // table must be registered again
+    std::vector<int>   registered;  // table of registered files, -1 for free slot
+    std::map<int, int> fixed;       // fd -> slot of registered file
+    std::vector<bool>  reaped;      // queued reads of the current submit which completed
+#endif
+};
+
+static void s_set_size(sourcereader_t* self, int handle, sourcereader_value_t* value, ssize_t size)
+{
+    value->size = size;
+    if (size < 0 && self->fds.count(handle))
+        self->failed.insert(handle);
+}
+
+static void s_pread_value(sourcereader_t* self, int handle, sourcereader_value_t* value)
+{
+    s_set_size(self, handle, value, sourcereader_read(self, handle, value->data, sizeof(value->data)));
+}
+
+#ifdef HAVE_LIBURING
+static void s_register_files(sourcereader_t* self)
+{
+    if (!self->registered.empty())
+        io_uring_unregister_files(&self->ring);
+    // sparse table with room to grow, so opening or closing a file updates
+    // only its slot
+    self->registered.assign(std::max(size_t(RING_FILES), 2 * self->fds.size()), -1);
+    std::copy(self->fds.begin(), self->fds.end(), self->registered.begin());
+    self->fixed.clear();
+    int r = io_uring_register_files(&self->ring, self->registered.data(), unsigned(self->registered.size()));
+    if (r == 0) {
+        for (size_t i = 0; i < self->fds.size(); i++) {
+            self->fixed[self->registered[i]] = int(i);
+        }
+    } else {
+        // reads still work on plain fds
+        log_debug("Could not register files with io_uring (%d)", r);
+        self->registered.clear();
+    }
+    self->files_dirty = false;
+}
+
+//  Put newly opened fd into a free slot of the registered table
+static void s_fixed_add(sourcereader_t* self, int fd)
+{
+    if (self->files_dirty || self->registered.empty())
+        return;
+    auto slot = std::find(self->registered.begin(), self->registered.end(), -1);
+    if (slot == self->registered.end()) {
+        // table is full, register a bigger one before the next submit
+        self->files_dirty = true;
+        return;
+    }
+    int index = int(slot - self->registered.begin());
+    if (io_uring_register_files_update(&self->ring, unsigned(index), &fd, 1) != 1) {
+        self->files_dirty = true;
+        return;
+    }
+    *slot           = fd;
+    self->fixed[fd] = index;
+}
+
+//  Free slot of fd which is going to be closed
+static void s_fixed_remove(sourcereader_t* self, int fd)
+{
+    auto it = self->fixed.find(fd);
+    if (it == self->fixed.end())
+        return;
+    int none = -1;
+    if (io_uring_register_files_update(&self->ring, unsigned(it->second), &none, 1) != 1)
+        self->files_dirty = true;
+    self->registered[size_t(it->second)] = -1;
+    self->fixed.erase(it);
+}
+
+//  Tear the ring down after it failed, the reader goes on with pread
+static void s_uring_exit(sourcereader_t* self)
+{
+    io_uring_queue_exit(&self->ring);
+    self->ring_ready  = false;
+    self->files_dirty = true;
+    self->registered.clear();
+    self->fixed.clear();
+    self->backend = SOURCEREADER_PREAD;
+}
+
+//  Submit queued reads from begin to end and wait for all of them. Returns
+//  false if the ring failed, reads which did not complete are done by pread.
+static bool s_uring_submit(sourcereader_t* self, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++) {
+        int                   fd    = self->queue[i].first;
+        sourcereader_value_t* value = self->queue[i].second;
+        struct io_uring_sqe*  sqe   = io_uring_get_sqe(&self->ring);
+        auto                  it    = self->fixed.find(fd);
+        if (it != self->fixed.end()) {
+            io_uring_prep_read(sqe, it->second, value->data, sizeof(value->data) - 1, 0);
+            io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+        } else
+            io_uring_prep_read(sqe, fd, value->data, sizeof(value->data) - 1, 0);
+        io_uring_sqe_set_data64(sqe, i);
+    }
+
+    int r = io_uring_submit_and_wait(&self->ring, unsigned(end - begin));
+    if (r < 0) {
+        log_warning("io_uring submit failed (%d), using pread", r);
+        for (size_t i = begin; i < end; i++) {
+            s_pread_value(self, self->queue[i].first, self->queue[i].second);
+        }
+        return true;
+    }
+    self->reaped.assign(end - begin, false);
+    for (size_t i = begin; i < end; i++) {
+        struct io_uring_cqe* cqe;
+        do {
+            r = io_uring_wait_cqe(&self->ring, &cqe);
+        } while (r == -EINTR);
+        if (r < 0) {
+            // completions of this submit can't be told from the ones of the
+            // next one anymore, so the ring is not used again
+            log_warning("io_uring wait failed (%d), using pread", r);
+            s_uring_exit(self);
+            for (size_t j = begin; j < end; j++) {
+                if (!self->reaped[j - begin])
+                    s_pread_value(self, self->queue[j].first, self->queue[j].second);
+            }
+            return false;
+        }
+        size_t                index = size_t(io_uring_cqe_get_data64(cqe));
+        sourcereader_value_t* value = self->queue[index].second;
+        self->reaped[index - begin] = true;
+        if (cqe->res >= 0) {
+            value->data[cqe->res] = '\0';
+            s_set_size(self, self->queue[index].first, value, cqe->res);
+        } else {
+            value->data[0] = '\0';
+            s_set_size(self, self->queue[index].first, value, -1);
+        }
+        io_uring_cqe_seen(&self->ring, cqe);
+    }
+    return true;
+}
+#endif
+
+//  --------------------------------------------------------------------------
+//  Create a new sourcereader
+
+sourcereader_t* sourcereader_new(const std::string& root_dir)
+{
+    sourcereader_t* self = new sourcereader_t;
+    assert(self);
+    //  Initialize class properties here
+    self->root_dir = root_dir;
+    // paths for logs and other users of root_dir are formatted as root_dir + path
+    if (!self->root_dir.empty() && self->root_dir.back() != '/')
+        self->root_dir += '/';
+    self->dirfd = open(self->root_dir.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+    if (self->dirfd < 0)
+        log_error("Could not open '%s'", self->root_dir.c_str());
+    self->backend = SOURCEREADER_PREAD;
+#ifdef HAVE_LIBURING
+    self->ring_ready  = false;
+    self->files_dirty = true;
+    sourcereader_set_backend(self, SOURCEREADER_IO_URING);
+#endif
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the sourcereader
+
+void sourcereader_destroy(sourcereader_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        sourcereader_t* self = *self_p;
+        //  Free class properties here
+#ifdef HAVE_LIBURING
+        if (self->ring_ready)
+            io_uring_queue_exit(&self->ring);
+#endif
+        for (int fd : self->fds) {
+            close(fd);
+        }
+        if (self->dirfd >= 0)
+            close(self->dirfd);
+        //  Free object itself
+        delete self;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return root dir of the sourcereader
+
+const std::string& sourcereader_root_dir(sourcereader_t* self)
+{
+    assert(self);
+    return self->root_dir;
+}
+
+//  --------------------------------------------------------------------------
+//  Return fd of root_dir
+
+int sourcereader_dirfd(sourcereader_t* self)
+{
+    assert(self);
+    return self->dirfd;
+}
+
+//  --------------------------------------------------------------------------
+//  List entries of directory into buffers of the reader
+
+const char** sourcereader_list(sourcereader_t* self, const char* path, size_t* size)
+{
+    assert(self);
+    assert(path);
+    if (size)
+        *size = 0;
+    int fd = openat(self->dirfd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        log_debug("Could not open '%s%s'", self->root_dir.c_str(), path);
+        return NULL;
+    }
+    // getdents64 instead of readdir(), which allocates its buffer for every
+    // opened directory
+    alignas(struct dirent64) char buf[4096];
+    self->names.clear();
+    self->offsets.clear();
+    long length;
+    while ((length = syscall(SYS_getdents64, fd, buf, sizeof(buf))) > 0) {
+        for (long pos = 0; pos < length;) {
+            const struct dirent64* entry = reinterpret_cast<const struct dirent64*>(buf + pos);
+            pos += entry->d_reclen;
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+                continue;
+            self->offsets.push_back(self->names.size());
+            self->names.insert(self->names.end(), entry->d_name, entry->d_name + strlen(entry->d_name) + 1);
+        }
+    }
+    close(fd);
+    if (length < 0) {
+        log_debug("Could not list '%s%s': %s", self->root_dir.c_str(), path, strerror(errno));
+        return NULL;
+    }
+    // names are not moved any more, pointers to them can be taken
+    self->entries.resize(self->offsets.size() + 1);
+    for (size_t i = 0; i < self->offsets.size(); i++) {
+        self->entries[i] = self->names.data() + self->offsets[i];
+    }
+    self->entries.back() = NULL;
+    if (size)
+        *size = self->offsets.size();
+    return self->entries.data();
+}
+
+//  --------------------------------------------------------------------------
+//  Open file and keep it open
+
+int sourcereader_open(sourcereader_t* self, const char* path)
+{
+    assert(self);
+    assert(path);
+    int fd = openat(self->dirfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_debug("Could not open '%s%s'", self->root_dir.c_str(), path);
+        return -1;
+    }
+    self->fds.insert(fd);
+#ifdef HAVE_LIBURING
+    s_fixed_add(self, fd);
+#endif
+    return fd;
+}
+
+//  --------------------------------------------------------------------------
+//  Close file opened by sourcereader_open
+
+void sourcereader_close(sourcereader_t* self, int handle)
+{
+    assert(self);
+    if (self->fds.erase(handle)) {
+#ifdef HAVE_LIBURING
+        s_fixed_remove(self, handle);
+#endif
+        self->failed.erase(handle);
+        close(handle);
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return handle of file kept open and cached by its path
+
+int sourcereader_lookup(sourcereader_t* self, const char* path)
+{
+    assert(self);
+    assert(path);
+    auto it = self->paths.find(std::string_view(path));
+    if (it != self->paths.end()) {
+        if (!self->failed.count(it->second.fd)) {
+            it->second.used = true;
+            return it->second.fd;
+        }
+        // file might have been re-created (e.g. interface was re-added)
+        sourcereader_close(self, it->second.fd);
+        self->paths.erase(it);
+    }
+    int fd = sourcereader_open(self, path);
+    if (fd >= 0)
+        self->paths.emplace(path, cached_t{fd, true});
+    return fd;
+}
+
+//  --------------------------------------------------------------------------
+//  Close cached files which were not looked up since the last sweep
+
+void sourcereader_sweep(sourcereader_t* self)
+{
+    assert(self);
+    for (auto it = self->paths.begin(); it != self->paths.end();) {
+        if (it->second.used) {
+            it->second.used = false;
+            ++it;
+        } else {
+            sourcereader_close(self, it->second.fd);
+            it = self->paths.erase(it);
+        }
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Read content of the opened file from its beginning
+
+ssize_t sourcereader_read(sourcereader_t* self, int handle, char* buf, size_t size)
+{
+    assert(self);
+    assert(buf && size > 0);
+    buf[0] = '\0';
+    if (handle < 0)
+        return -1;
+    ssize_t r = pread(handle, buf, size - 1, 0);
+    if (r < 0)
+        return -1;
+    buf[r] = '\0';
+    return r;
+}
+
+//  --------------------------------------------------------------------------
+//  Read content of a file kept open and cached by its path
+
+ssize_t sourcereader_read_cached(sourcereader_t* self, const char* path, char* buf, size_t size)
+{
+    assert(self);
+    int     handle = sourcereader_lookup(self, path);
+    ssize_t r      = sourcereader_read(self, handle, buf, size);
+    if (r < 0 && handle >= 0)
+        self->failed.insert(handle);
+    return r;
+}
+
+//  --------------------------------------------------------------------------
+//  Read content of a file which is not kept open
+
+ssize_t sourcereader_read_once(sourcereader_t* self, const char* path, char* buf, size_t size)
+{
+    assert(self);
+    assert(path);
+    // transient fd is not one of the opened files, so it doesn't touch the
+    // registered file table
+    int fd = openat(self->dirfd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_debug("Could not open '%s%s'", self->root_dir.c_str(), path);
+        buf[0] = '\0';
+        return -1;
+    }
+    ssize_t r = sourcereader_read(self, fd, buf, size);
+    close(fd);
+    return r;
+}
+
+//  --------------------------------------------------------------------------
+//  Queue read of opened file
+
+void sourcereader_queue(sourcereader_t* self, int handle, sourcereader_value_t* value)
+{
+    assert(self);
+    assert(value);
+    value->data[0] = '\0';
+    value->size    = -1;
+    if (handle >= 0)
+        self->queue.emplace_back(handle, value);
+}
+
+//  --------------------------------------------------------------------------
+//  Read all queued files
+
+void sourcereader_submit(sourcereader_t* self)
+{
+    assert(self);
+#ifdef HAVE_LIBURING
+    if (self->backend == SOURCEREADER_IO_URING) {
+        if (self->files_dirty)
+            s_register_files(self);
+        size_t begin = 0;
+        while (begin < self->queue.size()) {
+            size_t end = std::min(begin + RING_ENTRIES, self->queue.size());
+            bool   ok  = s_uring_submit(self, begin, end);
+            begin      = end;
+            if (!ok)
+                break;
+        }
+        // the rest after a failed ring
+        for (size_t i = begin; i < self->queue.size(); i++) {
+            s_pread_value(self, self->queue[i].first, self->queue[i].second);
+        }
+        self->queue.clear();
+        return;
+    }
+#endif
+    for (auto& item : self->queue) {
+        s_pread_value(self, item.first, item.second);
+    }
+    self->queue.clear();
+}
+
+//  --------------------------------------------------------------------------
+//  Select backend
+
+sourcereader_backend_t sourcereader_set_backend(sourcereader_t* self, sourcereader_backend_t backend)
+{
+    assert(self);
+    self->backend = SOURCEREADER_PREAD;
+    if (backend == SOURCEREADER_IO_URING) {
+#ifdef HAVE_LIBURING
+        if (!self->ring_ready) {
+            int r = io_uring_queue_init(RING_ENTRIES, &self->ring, 0);
+            if (r == 0)
+                self->ring_ready = true;
+            else
+                log_warning("io_uring is not available (%d), using pread", r);
+        }
+        if (self->ring_ready)
+            self->backend = SOURCEREADER_IO_URING;
+#else
+        log_debug("fty-info is built without io_uring, using pread");
+#endif
+    }
+    return self->backend;
+}
+
+//  --------------------------------------------------------------------------
+//  Return backend in use
+
+sourcereader_backend_t sourcereader_backend(sourcereader_t* self)
+{
+    assert(self);
+    return self->backend;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of opened files
+
+size_t sourcereader_size(sourcereader_t* self)
+{
+    assert(self);
+    return self->fds.size();
+}
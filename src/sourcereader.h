@@ -0,0 +1,110 @@
+/*  =========================================================================
+    sourcereader - Class for reading /proc and /sys files through cached fds
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include <string>
+#include <sys/types.h>
+
+#define SOURCEREADER_VALUE_SIZE 64
+
+typedef struct _sourcereader_t sourcereader_t;
+
+//  Backend used by sourcereader_submit
+typedef enum
+{
+    SOURCEREADER_PREAD    = 0,
+    SOURCEREADER_IO_URING = 1
+} sourcereader_backend_t;
+
+//  Destination of a queued read
+typedef struct
+{
+    char    data[SOURCEREADER_VALUE_SIZE]; // NUL terminated content
+    ssize_t size;                          // same as sourcereader_read return value
+} sourcereader_value_t;
+
+//  Create a new sourcereader for files under root_dir, a missing trailing '/'
+//  is added
+sourcereader_t* sourcereader_new(const std::string& root_dir);
+
+//  Destroy the sourcereader, closing all its files
+void sourcereader_destroy(sourcereader_t** self_p);
+
+//  Return root dir of the sourcereader
+const std::string& sourcereader_root_dir(sourcereader_t* self);
+
+//  Return fd of root_dir, opened once for the lifetime of the sourcereader,
+//  or -1 if root_dir can't be opened
+int sourcereader_dirfd(sourcereader_t* self);
+
+//  List entries of directory (path relative to root_dir), "." and ".."
+//  excluded, in directory order. Returns NULL terminated array of names and
+//  stores their number in size (if not NULL), NULL on error. The array and
+//  names are kept in buffers of the reader, valid until the next listing;
+//  once the buffers are big enough, listing does not allocate.
+const char** sourcereader_list(sourcereader_t* self, const char* path, size_t* size);
+
+//  Open file (path relative to root_dir) and keep it open.
+//  Returns handle for sourcereader_read or -1 on error
+int sourcereader_open(sourcereader_t* self, const char* path);
+
+//  Close file opened by sourcereader_open
+void sourcereader_close(sourcereader_t* self, int handle);
+
+//  Return handle of file (path relative to root_dir) which is opened on the
+//  first call and kept open, cached by its path, until the reader is
+//  destroyed or swept. After a failed queued read the file is opened again
+//  (e.g. an interface was removed and re-added). Don't close the handle.
+int sourcereader_lookup(sourcereader_t* self, const char* path);
+
+//  Close files cached by sourcereader_lookup which were not looked up since
+//  the previous sweep (e.g. counters of removed interfaces)
+void sourcereader_sweep(sourcereader_t* self);
+
+//  Read content of the opened file from its beginning into buf, NUL terminated.
+//  Returns number of bytes read or -1 on error (e.g. device was unplugged)
+ssize_t sourcereader_read(sourcereader_t* self, int handle, char* buf, size_t size);
+
+//  Read content of file (path relative to root_dir) kept open and cached as by
+//  sourcereader_lookup, for files too big for a queued value. Same return value
+//  as sourcereader_read, after a failed read the file is opened again.
+ssize_t sourcereader_read_cached(sourcereader_t* self, const char* path, char* buf, size_t size);
+
+//  Read content of a file which is not kept open, same return value as sourcereader_read
+ssize_t sourcereader_read_once(sourcereader_t* self, const char* path, char* buf, size_t size);
+
+//  Queue read of file opened by sourcereader_open into value. Reads are
+//  done by sourcereader_submit, value must stay valid until then.
+void sourcereader_queue(sourcereader_t* self, int handle, sourcereader_value_t* value);
+
+//  Read all queued files. With io_uring backend all reads are submitted and
+//  reaped together, otherwise they are read one by one with pread().
+void sourcereader_submit(sourcereader_t* self);
+
+//  Select backend, io_uring is used only if fty-info was built with it and
+//  the kernel supports it. Returns the backend actually in use.
+sourcereader_backend_t sourcereader_set_backend(sourcereader_t* self, sourcereader_backend_t backend);
+
+//  Return backend in use
+sourcereader_backend_t sourcereader_backend(sourcereader_t* self);
+
+//  Return number of opened files
+size_t sourcereader_size(sourcereader_t* self);
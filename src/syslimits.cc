@@ -0,0 +1,144 @@
+/*  =========================================================================
+    syslimits - Class for finding out usage of kernel resource limits
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    syslimits - Class for finding out usage of kernel resource limits
+@discuss
+    Publishes how close the system is to running out of file handles
+    (proc/sys/fs/file-nr, whose third field is file-max) and pids
+    (tasks from proc/loadavg against proc/sys/kernel/pid_max), together
+    with the number of used inodes and the available entropy.
+
+    All files are tiny and kept open by the sourcereader, their reads are
+    submitted together once per interval.
+@end
+*/
+
+#include "syslimits.h"
+#include "linuxmetric.h"
+#include <cmath>
+#include <fty_log.h>
+#include <stdio.h>
+
+//  Structure of our class
+
+struct _syslimits_t
+{
+    sourcereader_t*      reader;
+    int                  file_nr;
+    int                  inode_nr;
+    int                  pid_max;
+    int                  loadavg;
+    int                  entropy;
+    sourcereader_value_t file_nr_value;
+    sourcereader_value_t inode_nr_value;
+    sourcereader_value_t pid_max_value;
+    sourcereader_value_t loadavg_value;
+    sourcereader_value_t entropy_value;
+};
+
+static void s_add_usage(linuxmetric_list_t* info, const char* total_type, const char* used_type, const char* usage_type,
+    double total, double used, const char* unit)
+{
+    linuxmetric_add(info, total, unit, "%s", total_type);
+    linuxmetric_add(info, used, unit, "%s", used_type);
+    linuxmetric_add(info, (total > 0) ? linuxmetric_round(100 * used / total) : 0, "%", "%s", usage_type);
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new syslimits
+
+syslimits_t* syslimits_new(sourcereader_t* reader)
+{
+    assert(reader);
+    syslimits_t* self = static_cast<syslimits_t*>(zmalloc(sizeof(syslimits_t)));
+    assert(self);
+    //  Initialize class properties here
+    self->reader   = reader;
+    self->file_nr  = sourcereader_open(reader, "proc/sys/fs/file-nr");
+    self->inode_nr = sourcereader_open(reader, "proc/sys/fs/inode-nr");
+    self->pid_max  = sourcereader_open(reader, "proc/sys/kernel/pid_max");
+    self->loadavg  = sourcereader_open(reader, "proc/loadavg");
+    self->entropy  = sourcereader_open(reader, "proc/sys/kernel/random/entropy_avail");
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the syslimits
+
+void syslimits_destroy(syslimits_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        syslimits_t* self = *self_p;
+        //  Free class properties here
+        sourcereader_close(self->reader, self->file_nr);
+        sourcereader_close(self->reader, self->inode_nr);
+        sourcereader_close(self->reader, self->pid_max);
+        sourcereader_close(self->reader, self->loadavg);
+        sourcereader_close(self->reader, self->entropy);
+        //  Free object itself
+        free(self);
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Return usage of kernel resource limits
+
+linuxmetric_list_t* syslimits_get_all(syslimits_t* self)
+{
+    assert(self);
+    sourcereader_queue(self->reader, self->file_nr, &self->file_nr_value);
+    sourcereader_queue(self->reader, self->inode_nr, &self->inode_nr_value);
+    sourcereader_queue(self->reader, self->pid_max, &self->pid_max_value);
+    sourcereader_queue(self->reader, self->loadavg, &self->loadavg_value);
+    sourcereader_queue(self->reader, self->entropy, &self->entropy_value);
+    sourcereader_submit(self->reader);
+
+    linuxmetric_list_t* info = linuxmetric_list_new();
+
+    // allocated, free (always 0 since 2.6) and maximum file handles
+    double allocated, unused, file_max;
+    if (self->file_nr_value.size > 0 &&
+        sscanf(self->file_nr_value.data, "%lf %lf %lf", &allocated, &unused, &file_max) == 3)
+        s_add_usage(info, LINUXMETRIC_FILE_HANDLE_TOTAL, LINUXMETRIC_FILE_HANDLE_USED, LINUXMETRIC_FILE_HANDLE_USAGE,
+            file_max, allocated - unused, "handle");
+
+    // inodes are allocated dynamically, there is no limit to compare with
+    double inodes, free_inodes;
+    if (self->inode_nr_value.size > 0 && sscanf(self->inode_nr_value.data, "%lf %lf", &inodes, &free_inodes) == 2)
+        linuxmetric_add(info, inodes - free_inodes, "inode", LINUXMETRIC_INODE_USED);
+
+    // every task (thread) takes a pid, loadavg has "running/total" tasks
+    double pid_max, running, tasks;
+    if (self->pid_max_value.size > 0 && sscanf(self->pid_max_value.data, "%lf", &pid_max) == 1 &&
+        self->loadavg_value.size > 0 &&
+        sscanf(self->loadavg_value.data, "%*s %*s %*s %lf/%lf", &running, &tasks) == 2)
+        s_add_usage(info, LINUXMETRIC_PID_TOTAL, LINUXMETRIC_PID_USED, LINUXMETRIC_PID_USAGE, pid_max, tasks, "pid");
+
+    double entropy;
+    if (self->entropy_value.size > 0 && sscanf(self->entropy_value.data, "%lf", &entropy) == 1)
+        linuxmetric_add(info, entropy, "bit", LINUXMETRIC_ENTROPY_AVAILABLE);
+
+    return info;
+}
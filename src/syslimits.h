@@ -0,0 +1,46 @@
+/*  =========================================================================
+    syslimits - Class for finding out usage of kernel resource limits
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include "linuxmetric.h"
+#include "sourcereader.h"
+#include <czmq.h>
+
+#define LINUXMETRIC_FILE_HANDLE_TOTAL "total.file_handle"
+#define LINUXMETRIC_FILE_HANDLE_USED  "used.file_handle"
+#define LINUXMETRIC_FILE_HANDLE_USAGE "usage.file_handle"
+#define LINUXMETRIC_INODE_USED        "used.inode"
+#define LINUXMETRIC_PID_TOTAL         "total.pid"
+#define LINUXMETRIC_PID_USED          "used.pid"
+#define LINUXMETRIC_PID_USAGE         "usage.pid"
+#define LINUXMETRIC_ENTROPY_AVAILABLE "available.entropy"
+
+typedef struct _syslimits_t syslimits_t;
+
+//  Create a new syslimits reading its files through reader
+syslimits_t* syslimits_new(sourcereader_t* reader);
+
+//  Destroy the syslimits
+void syslimits_destroy(syslimits_t** self_p);
+
+//  Return list of metrics with usage of file handles, inodes, pids
+//  and available entropy
+linuxmetric_list_t* syslimits_get_all(syslimits_t* self);
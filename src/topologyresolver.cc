@@ -33,9 +33,15 @@
 #include <string>
 #include <fty_log.h>
 #include "fty_info.h"
+#include "infostats.h"
+#include "tracespan.h"
 
 // State
 #define DEFAULT_ENDPOINT "ipc://@/malamute"
+// How long to wait for ASSET_DETAIL reply of asset agent
+#define ASSET_DETAIL_TIMEOUT_MS 5000
+// How many requests not answered in time are remembered to recognize late replies
+#define ASSET_DETAIL_TIMED_OUT_MAX 16
 
 typedef enum
 {
@@ -53,10 +59,13 @@ struct _topologyresolver_t
     ResolverState state;
     zhashx_t*     assets;
     mlm_client_t* client;
+    zpoller_t*    poller;    // on replies of client, set with endpoint
+    zlistx_t*     timed_out; // uuids of ASSET_DETAIL requests not answered in time
 };
 
 static std::map<std::string, std::set<std::string>> s_local_addresses()
 {
+    TRACESPAN("s_local_addresses");
     struct ifaddrs *                             interfaces, *iface;
     char                                         host[NI_MAXHOST];
     std::map<std::string, std::set<std::string>> result;
@@ -155,6 +164,60 @@ static bool s_is_this_me(fty_proto_t* asset)
     return found;
 }
 
+// is iname one of the parents listed in asset message?
+static bool s_is_parent(fty_proto_t* asset, const char* iname)
+{
+    char buffer[16]; // strlen ("parent_name.123") + 1
+
+    for (int i = 1; i < 100; i++) {
+        snprintf(buffer, 16, "parent_name.%i", i);
+        const char* parent = fty_proto_aux_string(asset, buffer, nullptr);
+        if (!parent)
+            return false;
+        if (streq(parent, iname))
+            return true;
+    }
+    return false;
+}
+
+// Wait at most ASSET_DETAIL_TIMEOUT_MS for reply with uuid, nullptr if it
+// doesn't come. Replies to previous requests which timed out are dropped.
+static zmsg_t* s_recv_reply(topologyresolver_t* self, const char* uuid)
+{
+    if (!self->poller)
+        return nullptr;
+    int64_t deadline = zclock_mono() + ASSET_DETAIL_TIMEOUT_MS;
+    zmsg_t* reply    = nullptr;
+    while (!reply) {
+        int64_t timeout = deadline - zclock_mono();
+        if (timeout <= 0 || !zpoller_wait(self->poller, int(timeout)))
+            break;
+        zmsg_t* msg      = mlm_client_recv(self->client);
+        char*   rcv_uuid = msg ? zmsg_popstr(msg) : nullptr;
+        if (rcv_uuid && streq(rcv_uuid, uuid))
+            reply = msg;
+        else {
+            void* late = rcv_uuid ? zlistx_find(self->timed_out, rcv_uuid) : nullptr;
+            if (late) {
+                log_debug("dropping late reply %s of asset agent", rcv_uuid);
+                zlistx_delete(self->timed_out, late);
+                infostats_add(INFOSTATS_TOPOLOGY_FETCH_LATE);
+            } else
+                log_warning("dropping unexpected reply of asset agent");
+            zmsg_destroy(&msg);
+        }
+        zstr_free(&rcv_uuid);
+    }
+    if (!reply) {
+        if (zlistx_size(self->timed_out) >= ASSET_DETAIL_TIMED_OUT_MAX) {
+            char* oldest = static_cast<char*>(zlistx_detach(self->timed_out, nullptr));
+            zstr_free(&oldest);
+        }
+        zlistx_add_end(self->timed_out, const_cast<char*>(uuid));
+    }
+    return reply;
+}
+
 static void s_purge_message_cache(topologyresolver_t* self)
 {
     if (!self || !self->assets)
@@ -189,7 +252,11 @@ topologyresolver_t* topologyresolver_new(const char* iname)
     self->assets = zhashx_new();
     zhashx_set_destructor(self->assets, reinterpret_cast<czmq_destructor*>(fty_proto_destroy));
     zhashx_set_duplicator(self->assets, reinterpret_cast<czmq_duplicator*>(fty_proto_dup));
-    self->client = mlm_client_new();
+    self->client    = mlm_client_new();
+    self->timed_out = zlistx_new();
+    zlistx_set_duplicator(self->timed_out, reinterpret_cast<czmq_duplicator*>(strdup));
+    zlistx_set_destructor(self->timed_out, reinterpret_cast<czmq_destructor*>(zstr_free));
+    zlistx_set_comparator(self->timed_out, reinterpret_cast<int (*)(const void*, const void*)>(strcmp));
     return self;
 }
 
@@ -206,6 +273,8 @@ void topologyresolver_destroy(topologyresolver_t** self_p)
         zhashx_destroy(&self->assets);
         zstr_free(&self->iname);
         zstr_free(&self->topology);
+        zlistx_destroy(&self->timed_out);
+        zpoller_destroy(&self->poller);
         mlm_client_destroy(&self->client);
         //  Free object itself
         free(self);
@@ -219,6 +288,8 @@ void topologyresolver_set_endpoint(topologyresolver_t* self, const char* endpoin
 {
     self->endpoint = endpoint;
     mlm_client_connect(self->client, endpoint, 1000, "fty_info_topologyresolver");
+    if (!self->poller)
+        self->poller = zpoller_new(mlm_client_msgpipe(self->client), nullptr);
 }
 
 //  --------------------------------------------------------------------------
@@ -231,6 +302,16 @@ char* topologyresolver_id(topologyresolver_t* self)
     return strdup(self->iname);
 }
 
+//  --------------------------------------------------------------------------
+//  Return number of asset messages kept in the cache
+
+size_t topologyresolver_assets_size(topologyresolver_t* self)
+{
+    if (!self || !self->assets)
+        return 0;
+    return zhashx_size(self->assets);
+}
+
 //  --------------------------------------------------------------------------
 //  Give topology resolver one asset information
 bool topologyresolver_asset(topologyresolver_t* self, fty_proto_t* message)
@@ -262,12 +343,22 @@ bool topologyresolver_asset(topologyresolver_t* self, fty_proto_t* message)
             return false;
         }
         zlistx_destroy(&list);
+        // parents are cached or got from asset agent, other assets are not
+        // needed any more
+        if (self->state == DISCOVERING) {
+            self->state = UPTODATE;
+            s_purge_message_cache(self);
+        }
         return true;
     }
 
     // is this message about my parent?
     if (self->state == DISCOVERING) {
-        // discovering - every asset (except me) is a possible parent
+        // discovering - every asset (except me) is a possible parent until my
+        // message comes, then only the parents it lists are
+        fty_proto_t* me = self->iname ? static_cast<fty_proto_t*>(zhashx_lookup(self->assets, self->iname)) : nullptr;
+        if (me && !s_is_parent(me, iname))
+            return false;
         zhashx_update(self->assets, iname, message);
         zlistx_t* list = topologyresolver_to_list(self);
         if (zlistx_size(list)) {
@@ -414,6 +505,7 @@ char* topologyresolver_to_string(topologyresolver_t* self, const char* separator
 //  Empty list is returned if the topology is incomplete yet
 zlistx_t* topologyresolver_to_list(topologyresolver_t* self)
 {
+    TRACESPAN("topologyresolver_to_list");
     zlistx_t* list = zlistx_new();
     zlistx_set_destructor(list, reinterpret_cast<void (*)(void**)>(zstr_free));
     zlistx_set_duplicator(list, reinterpret_cast<void* (*)(const void*)>(strdup));
@@ -435,29 +527,33 @@ zlistx_t* topologyresolver_to_list(topologyresolver_t* self)
         if (!zhashx_lookup(self->assets, parent)) {
             // ask ASSET_AGENT for ASSET_DETAIL
             if (mlm_client_connected(self->client)) {
-                zuuid_t* uuid = zuuid_new();
+                TRACESPAN("ASSET_DETAIL fetch");
+                int64_t  start = zclock_usecs();
+                zuuid_t* uuid  = zuuid_new();
                 log_debug("ask ASSET AGENT for ASSET_DETAIL, RC = %s, iname = %s", self->iname, parent);
                 mlm_client_sendtox(
                     self->client, FTY_ASSET_AGENT, "ASSET_DETAIL", "GET", zuuid_str_canonical(uuid), parent, nullptr);
-                zmsg_t* parent_msg = mlm_client_recv(self->client);
-                if (parent_msg) {
-                    char* rcv_uuid = zmsg_popstr(parent_msg);
-                    if (0 == strcmp(rcv_uuid, zuuid_str_canonical(uuid)) && fty_proto_is(parent_msg)) {
-                        fty_proto_t* parent_fmsg = fty_proto_decode(&parent_msg);
-                        zhashx_update(self->assets, parent, parent_fmsg);
-                        zlistx_add_start(list, const_cast<char*>(parent));
+                zmsg_t* parent_msg = s_recv_reply(self, zuuid_str_canonical(uuid));
+                zuuid_destroy(&uuid);
+                infostats_record(INFOSTATS_TOPOLOGY_FETCH, zclock_usecs() - start);
+                if (parent_msg && fty_proto_is(parent_msg)) {
+                    fty_proto_t* parent_fmsg = fty_proto_decode(&parent_msg);
+                    // the cache keeps its own copy
+                    zhashx_update(self->assets, parent, parent_fmsg);
+                    fty_proto_destroy(&parent_fmsg);
+                    zlistx_add_start(list, const_cast<char*>(parent));
+                } else {
+                    // no reply or unknown parent, topology is not complete
+                    if (!parent_msg) {
+                        log_warning("asset agent did not send ASSET_DETAIL of %s in time", parent);
+                        infostats_add(INFOSTATS_TOPOLOGY_FETCH_TIMEOUT);
                     } else {
-                        // invalid zuuid or unknown parent, topology is not complete
-                        zlistx_purge(list);
-                        break;
+                        infostats_add(INFOSTATS_TOPOLOGY_FETCH_FAILED);
                     }
-                    zstr_free(&rcv_uuid);
-                } else {
-                    // parent is unknown, topology is not complete
+                    zmsg_destroy(&parent_msg);
                     zlistx_purge(list);
                     break;
                 }
-                zuuid_destroy(&uuid);
             } else {
                 // parent is unknown, topology is not complete
                 zlistx_purge(list);
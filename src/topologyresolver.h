@@ -39,6 +39,9 @@ char* topologyresolver_id(topologyresolver_t* self);
 // Return URI of asset for this topologyresolver
 char* topologyresolver_to_rc_name_uri(topologyresolver_t* self);
 
+//  Return number of asset messages kept in the cache
+size_t topologyresolver_assets_size(topologyresolver_t* self);
+
 //  Give topology resolver one asset information
 bool topologyresolver_asset(topologyresolver_t* self, fty_proto_t* message);
 
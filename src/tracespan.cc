@@ -0,0 +1,187 @@
+/*  =========================================================================
+    tracespan - Scoped tracing spans dumped in Chrome trace format
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+/*
+@header
+    tracespan - Scoped tracing spans dumped in Chrome trace format
+@discuss
+    Spans show where the time of a slow reply or interval went (waiting on
+    asset-agent, parsing release details, getifaddrs, ...). TRACESPAN(name)
+    records the enclosing scope; when tracing is disabled this is a relaxed
+    load of a flag and nothing else.
+
+    Each thread writes its spans into its own ring buffer, created on its
+    first span and kept until exit, so recording takes no lock: the span is
+    stored and the head index is published with a release store. A dump
+    reads the buffers of all threads up to their published head. A span
+    overwritten by its thread during a dump may show up garbled, which is
+    acceptable for a diagnostic tool; the agent dumps from the thread which
+    records the spans.
+@end
+*/
+
+#include "tracespan.h"
+#include <assert.h>
+#include <memory>
+#include <mutex>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+std::atomic<bool> tracespan_on(false);
+
+typedef struct
+{
+    const char* name;
+    int64_t     start; // ns
+    int64_t     end;   // ns
+} tracespan_event_t;
+
+typedef struct
+{
+    int                   tid;
+    std::atomic<uint64_t> head; // number of spans ever recorded
+    tracespan_event_t     events[TRACESPAN_CAPACITY];
+} tracespan_buffer_t;
+
+static std::mutex                                       s_buffers_mutex; // taken once per thread and by dumps
+static std::vector<std::unique_ptr<tracespan_buffer_t>> s_buffers;
+static thread_local tracespan_buffer_t*                 s_buffer = nullptr;
+
+static tracespan_buffer_t* s_thread_buffer(void)
+{
+    if (!s_buffer) {
+        std::unique_ptr<tracespan_buffer_t> buffer(new tracespan_buffer_t);
+        buffer->tid = int(syscall(SYS_gettid));
+        buffer->head.store(0, std::memory_order_relaxed);
+        s_buffer = buffer.get();
+        std::lock_guard<std::mutex> lock(s_buffers_mutex);
+        s_buffers.push_back(std::move(buffer));
+    }
+    return s_buffer;
+}
+
+//  Write string as JSON string
+static void s_print_string(FILE* output, const char* string)
+{
+    fputc('"', output);
+    for (const char* c = string; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', output);
+        fputc(*c, output);
+    }
+    fputc('"', output);
+}
+
+//  --------------------------------------------------------------------------
+//  Enable or disable recording of spans
+
+void tracespan_enable(bool enable)
+{
+    tracespan_on.store(enable, std::memory_order_relaxed);
+}
+
+//  --------------------------------------------------------------------------
+//  Return monotonic time in nanoseconds
+
+int64_t tracespan_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return int64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+//  --------------------------------------------------------------------------
+//  Record span into the buffer of the calling thread
+
+void tracespan_record(const char* name, int64_t start, int64_t end)
+{
+    assert(name);
+    tracespan_buffer_t* buffer = s_thread_buffer();
+    uint64_t            head   = buffer->head.load(std::memory_order_relaxed);
+    buffer->events[head % TRACESPAN_CAPACITY] = {name, start, end};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+//  --------------------------------------------------------------------------
+//  Write spans of all threads as Chrome trace JSON
+
+size_t tracespan_dump(FILE* output)
+{
+    assert(output);
+    std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    size_t                      count = 0;
+    int                         pid   = int(getpid());
+    fprintf(output, "{\"traceEvents\":[");
+    for (const auto& buffer : s_buffers) {
+        uint64_t head  = buffer->head.load(std::memory_order_acquire);
+        uint64_t first = head > TRACESPAN_CAPACITY ? head - TRACESPAN_CAPACITY : 0;
+        for (uint64_t i = first; i < head; i++) {
+            const tracespan_event_t& event = buffer->events[i % TRACESPAN_CAPACITY];
+            fprintf(output, "%s\n{\"name\":", count ? "," : "");
+            s_print_string(output, event.name);
+            fprintf(output, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}", double(event.start) / 1000,
+                double(event.end - event.start) / 1000, pid, buffer->tid);
+            count++;
+        }
+    }
+    fprintf(output, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return count;
+}
+
+//  --------------------------------------------------------------------------
+//  Write spans of all threads to file path
+
+bool tracespan_dump_file(const char* path)
+{
+    assert(path);
+    FILE* output = fopen(path, "w");
+    if (!output)
+        return false;
+    tracespan_dump(output);
+    return fclose(output) == 0;
+}
+
+//  --------------------------------------------------------------------------
+//  Return number of spans held by all threads
+
+size_t tracespan_size(void)
+{
+    std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    size_t                      size = 0;
+    for (const auto& buffer : s_buffers) {
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        size += head > TRACESPAN_CAPACITY ? TRACESPAN_CAPACITY : size_t(head);
+    }
+    return size;
+}
+
+//  --------------------------------------------------------------------------
+//  Drop spans of all threads
+
+void tracespan_reset(void)
+{
+    std::lock_guard<std::mutex> lock(s_buffers_mutex);
+    for (const auto& buffer : s_buffers) {
+        buffer->head.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,86 @@
+/*  =========================================================================
+    tracespan - Scoped tracing spans dumped in Chrome trace format
+
+    Copyright (C) 2014 - 2020 Eaton
+
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    =========================================================================
+*/
+
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <stdio.h>
+
+#define TRACESPAN_CAPACITY 8192 // spans kept per thread, older are overwritten
+
+//  Trace the rest of the enclosing scope as span name (a string literal)
+#define TRACESPAN(name)             TRACESPAN_SCOPE_(name, __LINE__)
+#define TRACESPAN_SCOPE_(name, line) TRACESPAN_SCOPE__(name, line)
+#define TRACESPAN_SCOPE__(name, line) tracespan_scope_t tracespan_scope_##line(name)
+
+extern std::atomic<bool> tracespan_on;
+
+//  Enable or disable recording of spans, disabled by default
+void tracespan_enable(bool enable);
+
+//  Return true if spans are recorded
+inline bool tracespan_enabled(void)
+{
+    return tracespan_on.load(std::memory_order_relaxed);
+}
+
+//  Return monotonic time in nanoseconds
+int64_t tracespan_now(void);
+
+//  Record span name which started at start and ended at end (tracespan_now
+//  values) into the buffer of the calling thread
+void tracespan_record(const char* name, int64_t start, int64_t end);
+
+//  Write spans of all threads to output as Chrome trace JSON (chrome://tracing,
+//  Perfetto), return number of spans written
+size_t tracespan_dump(FILE* output);
+
+//  Write spans of all threads to file path, return false on error
+bool tracespan_dump_file(const char* path);
+
+//  Return number of spans held by all threads
+size_t tracespan_size(void);
+
+//  Drop spans of all threads
+void tracespan_reset(void);
+
+//  Span covering the lifetime of the object, costs one relaxed load when
+//  tracing is disabled
+class tracespan_scope_t
+{
+public:
+    explicit tracespan_scope_t(const char* name)
+        : m_name(name)
+        , m_start(tracespan_enabled() ? tracespan_now() : 0)
+    {
+    }
+    ~tracespan_scope_t()
+    {
+        if (m_start)
+            tracespan_record(m_name, m_start, tracespan_now());
+    }
+    tracespan_scope_t(const tracespan_scope_t&) = delete;
+    tracespan_scope_t& operator=(const tracespan_scope_t&) = delete;
+
+private:
+    const char* m_name;
+    int64_t     m_start;
+};
@@ -0,0 +1,104 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "allocbudget.h"
+#include <malloc.h>
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void  __libc_free(void* ptr);
+
+//  Plain thread_local data, the wrappers must not allocate
+static thread_local bool          s_counting = false;
+static thread_local allocbudget_t s_budget;
+static thread_local long          s_live; // usable bytes, may go negative
+
+static void s_allocated(void* ptr, size_t size)
+{
+    if (!s_counting || !ptr)
+        return;
+    s_budget.allocations++;
+    s_budget.bytes += size;
+    s_live += long(malloc_usable_size(ptr));
+    if (s_live > 0 && size_t(s_live) > s_budget.peak)
+        s_budget.peak = size_t(s_live);
+}
+
+static void s_freed(void* ptr)
+{
+    if (!s_counting || !ptr)
+        return;
+    s_budget.frees++;
+    s_live -= long(malloc_usable_size(ptr));
+}
+
+extern "C" void* malloc(size_t size)
+{
+    void* ptr = __libc_malloc(size);
+    s_allocated(ptr, size);
+    return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size)
+{
+    void* ptr = __libc_calloc(count, size);
+    s_allocated(ptr, count * size);
+    return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    if (s_counting && ptr)
+        s_live -= long(malloc_usable_size(ptr));
+    void* result = __libc_realloc(ptr, size);
+    s_allocated(result, size);
+    return result;
+}
+
+extern "C" void free(void* ptr)
+{
+    s_freed(ptr);
+    __libc_free(ptr);
+}
+
+//  --------------------------------------------------------------------------
+//  Start recording allocations of the calling thread
+
+void allocbudget_start(void)
+{
+    s_budget   = allocbudget_t{0, 0, 0, 0};
+    s_live     = 0;
+    s_counting = true;
+}
+
+//  --------------------------------------------------------------------------
+//  Stop recording
+
+allocbudget_t allocbudget_stop(void)
+{
+    s_counting = false;
+    return s_budget;
+}
+
+//  --------------------------------------------------------------------------
+//  Return allocations made by operation
+
+allocbudget_t allocbudget_measure(const std::function<void()>& operation)
+{
+    allocbudget_start();
+    operation();
+    return allocbudget_stop();
+}
@@ -0,0 +1,153 @@
+#include "src/fty_info_server_internal.h"
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/metricarena.h"
+#include "src/procscan.h"
+#include "src/selfmetric.h"
+#include "src/syslimits.h"
+#include "src/topologyresolver.h"
+#include "tests/allocbudget.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+
+//  Budgets of heap allocations per operation in steady state. An operation
+//  may not allocate more, nor leak. When a change lowers the numbers, lower
+//  the budget too, so that the gain can't be lost unnoticed. A metrics tick
+//  may not allocate at all.
+//
+//  Measured on x86_64 with glibc 2.36 (allocations, bytes):
+//      INFO request        87  14073
+//      ASSETS message      64   1270 (asset outside of the topology)
+//                          71   1899 (parent in the topology)
+//      HW_CAP request      80   7974
+//  The budgets are 15 % above. A failing check prints the new numbers.
+
+#define INFO_ALLOCATIONS   100
+#define INFO_BYTES         (16 * 1024)
+#define ASSET_ALLOCATIONS  82
+#define ASSET_BYTES        2200
+#define HW_CAP_ALLOCATIONS 92
+#define HW_CAP_BYTES       (9 * 1024)
+
+static fty_proto_t* s_asset(const char* iname, const char* parent)
+{
+    fty_proto_t* msg = fty_proto_new(FTY_PROTO_ASSET);
+    fty_proto_set_name(msg, "%s", iname);
+    fty_proto_set_operation(msg, FTY_PROTO_ASSET_OP_UPDATE);
+    fty_proto_ext_insert(msg, "name", "friendly %s", iname);
+    fty_proto_aux_insert(msg, "type", "device");
+    fty_proto_aux_insert(msg, "subtype", "epdu");
+    if (parent)
+        fty_proto_aux_insert(msg, "parent_name.1", "%s", parent);
+    return msg;
+}
+
+static void s_check(const allocbudget_t& used, size_t allocations, size_t bytes)
+{
+    INFO(used.allocations << " allocations, " << used.bytes << " bytes, " << used.frees << " frees");
+    CHECK(used.allocations <= allocations);
+    CHECK(used.bytes <= bytes);
+    CHECK(used.frees == used.allocations);
+}
+
+TEST_CASE("allocation budget of metrics tick")
+{
+    sourcereader_t* reader   = sourcereader_new("tests/selftest-ro/data/");
+    linuxsensors_t* sensors  = linuxsensors_new(reader);
+    syslimits_t*    limits   = syslimits_new(reader);
+    procscan_t*     procscan = procscan_new("tests/selftest-ro/data/", 2, 256);
+    metricarena_t*  arena    = metricarena_new(METRICARENA_SIZE);
+    zhashx_t*       history  = linuxmetric_history_new();
+    size_t          count    = 0;
+
+    // one interval of the server without publishing
+    auto tick = [&] {
+        linuxmetric_set_arena(arena);
+        linuxmetric_list_t* info           = linuxmetric_get_all(30, history, reader, true);
+        linuxmetric_list_t* sensors_info   = linuxsensors_get_all(sensors, 30, history);
+        linuxmetric_list_t* limits_info    = syslimits_get_all(limits);
+        linuxmetric_list_t* processes_info = procscan_get_all(procscan);
+        linuxmetric_list_t* self_info      = selfmetric_get_all(30, history, 0, 0);
+        linuxmetric_list_append(info, &sensors_info);
+        linuxmetric_list_append(info, &limits_info);
+        linuxmetric_list_append(info, &processes_info);
+        linuxmetric_list_append(info, &self_info);
+        count = metriclist_destroy(&info);
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+    };
+    // the first intervals fill history, open files and size the arena and
+    // the buffers of the reader
+    tick();
+    tick();
+    allocbudget_t used = allocbudget_measure(tick);
+    INFO(used.allocations << " allocations, " << used.bytes << " bytes");
+    CHECK(count > 50);
+    CHECK(used.allocations == 0);
+    CHECK(used.frees == 0);
+
+    zhashx_destroy(&history);
+    metricarena_destroy(&arena);
+    procscan_destroy(&procscan);
+    syslimits_destroy(&limits);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("allocation budget of INFO request")
+{
+    topologyresolver_t* resolver = topologyresolver_new(NULL);
+    auto                request  = [&] {
+        ftyinfo_t* info  = ftyinfo_new(resolver, "/api/v1/admin/info");
+        zmsg_t*    reply = fty_info_server_info_msg(info);
+        zmsg_destroy(&reply);
+        ftyinfo_destroy(&info);
+    };
+    request();
+    s_check(allocbudget_measure(request), INFO_ALLOCATIONS, INFO_BYTES);
+    topologyresolver_destroy(&resolver);
+}
+
+TEST_CASE("allocation budget of ASSETS message")
+{
+    topologyresolver_t* resolver = topologyresolver_new("me");
+    fty_proto_t*        parent   = s_asset("rack-1", NULL);
+    fty_proto_t*        me       = s_asset("me", "rack-1");
+    topologyresolver_asset(resolver, parent);
+    REQUIRE(topologyresolver_asset(resolver, me));
+
+    // decoded and given to the resolver as s_handle_stream does, for an asset
+    // outside of the topology and for the parent
+    for (const char* iname : {"device-1", "rack-1"}) {
+        fty_proto_t* asset   = s_asset(iname, "rack-1");
+        zmsg_t*      encoded = fty_proto_encode(&asset);
+        auto         stream  = [&] {
+            zmsg_t*      aux     = zmsg_dup(encoded);
+            fty_proto_t* message = fty_proto_decode(&aux);
+            zmsg_destroy(&aux);
+            topologyresolver_asset(resolver, message);
+            fty_proto_destroy(&message);
+        };
+        stream();
+        s_check(allocbudget_measure(stream), ASSET_ALLOCATIONS, ASSET_BYTES);
+        zmsg_destroy(&encoded);
+    }
+
+    fty_proto_destroy(&me);
+    fty_proto_destroy(&parent);
+    topologyresolver_destroy(&resolver);
+}
+
+TEST_CASE("allocation budget of HW_CAP request")
+{
+    size_t size    = 0;
+    auto   request = [&] {
+        zmsg_t* reply = fty_info_server_hw_cap_msg("tests/selftest-ro/data/hw_cap", "gpo", "uuid1234");
+        size          = zmsg_size(reply);
+        zmsg_destroy(&reply);
+    };
+    request();
+    REQUIRE(size > 4);
+    s_check(allocbudget_measure(request), HW_CAP_ALLOCATIONS, HW_CAP_BYTES);
+}
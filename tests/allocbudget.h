@@ -0,0 +1,42 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#pragma once
+#include <functional>
+#include <stddef.h>
+
+//  Heap allocations of scoped operations, for asserting per-operation budgets
+//  in tests. The test binary replaces malloc, calloc, realloc and free by
+//  wrappers around the glibc allocator (no LD_PRELOAD needed); operator new
+//  and czmq's zmalloc end up in malloc, so they are counted as well. Only
+//  allocations of the thread which started counting are recorded, so threads
+//  of the broker or actors do not disturb the numbers.
+
+typedef struct
+{
+    size_t allocations; // calls of malloc, calloc and realloc
+    size_t frees;       // calls of free (of non-NULL pointers)
+    size_t bytes;       // bytes requested by the allocations
+    size_t peak;        // peak of usable bytes allocated and not yet freed
+} allocbudget_t;
+
+//  Start recording allocations of the calling thread
+void allocbudget_start(void);
+
+//  Stop recording and return what was recorded since allocbudget_start
+allocbudget_t allocbudget_stop(void);
+
+//  Return allocations made by operation
+allocbudget_t allocbudget_measure(const std::function<void()>& operation);
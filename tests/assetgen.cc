@@ -0,0 +1,88 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "assetgen.h"
+#include <algorithm>
+#include <random>
+#include <string>
+
+static fty_proto_t* s_asset(
+    const std::string& iname, const char* type, const char* subtype, const std::vector<std::string>& parents)
+{
+    fty_proto_t* msg = fty_proto_new(FTY_PROTO_ASSET);
+    fty_proto_set_name(msg, "%s", iname.c_str());
+    fty_proto_set_operation(msg, FTY_PROTO_ASSET_OP_CREATE);
+    fty_proto_ext_insert(msg, "name", "friendly %s", iname.c_str());
+    fty_proto_aux_insert(msg, "type", "%s", type);
+    fty_proto_aux_insert(msg, "subtype", "%s", subtype);
+    // parents are given from the datacenter down, parent_name.1 is the nearest
+    for (size_t i = 0; i < parents.size(); i++) {
+        std::string key = "parent_name." + std::to_string(parents.size() - i);
+        fty_proto_aux_insert(msg, key.c_str(), "%s", parents[i].c_str());
+    }
+    return msg;
+}
+
+//  --------------------------------------------------------------------------
+//  Generate assets of a data center
+
+std::vector<fty_proto_t*> assetgen_datacenter(size_t assets, const char* rc_iname, unsigned seed)
+{
+    std::vector<fty_proto_t*> result;
+    std::vector<std::string>  racks;
+    result.reserve(std::max(assets, size_t(1112)));
+
+    result.push_back(s_asset(ASSETGEN_DATACENTER, "datacenter", "", {}));
+    for (int room = 0; room < 10; room++) {
+        std::string room_iname = "room-" + std::to_string(room);
+        result.push_back(s_asset(room_iname, "room", "", {ASSETGEN_DATACENTER}));
+        for (int row = 0; row < 10; row++) {
+            std::string row_iname = "row-" + std::to_string(room) + "-" + std::to_string(row);
+            result.push_back(s_asset(row_iname, "row", "", {ASSETGEN_DATACENTER, room_iname}));
+            for (int rack = 0; rack < 10; rack++) {
+                std::string rack_iname = "rack-" + std::to_string(room) + "-" + std::to_string(row) + "-" +
+                                         std::to_string(rack);
+                result.push_back(s_asset(rack_iname, "rack", "", {ASSETGEN_DATACENTER, room_iname, row_iname}));
+                racks.push_back(rack_iname);
+            }
+        }
+    }
+
+    result.push_back(s_asset(rc_iname, "device", "rackcontroller",
+        {ASSETGEN_DATACENTER, "room-9", "row-9-9", ASSETGEN_RC_RACK}));
+    for (size_t device = 0; result.size() < assets; device++) {
+        const std::string& rack = racks[device % racks.size()];
+        // rack-R-W-K is in row-R-W of room-R
+        std::string row  = "row-" + rack.substr(5, 3);
+        std::string room = "room-" + rack.substr(5, 1);
+        result.push_back(s_asset("device-" + std::to_string(device), "device", device % 2 ? "server" : "epdu",
+            {ASSETGEN_DATACENTER, room, row, rack}));
+    }
+
+    std::mt19937 random(seed);
+    std::shuffle(result.begin(), result.end(), random);
+    return result;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy all messages
+
+void assetgen_destroy(std::vector<fty_proto_t*>& assets)
+{
+    for (fty_proto_t*& asset : assets) {
+        fty_proto_destroy(&asset);
+    }
+    assets.clear();
+}
@@ -0,0 +1,35 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#pragma once
+#include <fty_proto.h>
+#include <vector>
+
+//  Synthetic asset messages of a large data center, as the ASSETS stream
+//  delivers them during REPUBLISH: one datacenter with 10 rooms, 10 rows per
+//  room and 10 racks per row, devices spread over all racks and the rack
+//  controller rc_iname in the last rack. Every asset lists all its parents
+//  (parent_name.1 is the nearest one). Messages are shuffled by seed.
+
+#define ASSETGEN_DATACENTER "datacenter-1"
+#define ASSETGEN_RC_RACK    "rack-9-9-9"
+#define ASSETGEN_DEPTH      4 // parents of every device
+
+//  Return assets messages (at least 1112 of them), caller destroys them with
+//  assetgen_destroy
+std::vector<fty_proto_t*> assetgen_datacenter(size_t assets, const char* rc_iname, unsigned seed);
+
+//  Destroy all messages
+void assetgen_destroy(std::vector<fty_proto_t*>& assets);
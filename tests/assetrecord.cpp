@@ -0,0 +1,89 @@
+#include "src/assetrecord.h"
+#include "src/topologyresolver.h"
+#include <catch2/catch.hpp>
+#include <stdio.h>
+#include <unistd.h>
+
+static fty_proto_t* s_asset(const char* iname, const char* name, const char* parent)
+{
+    fty_proto_t* msg = fty_proto_new(FTY_PROTO_ASSET);
+    fty_proto_set_name(msg, "%s", iname);
+    fty_proto_set_operation(msg, FTY_PROTO_ASSET_OP_CREATE);
+    fty_proto_ext_insert(msg, "name", "%s", name);
+    if (parent)
+        fty_proto_aux_insert(msg, "parent_name.1", "%s", parent);
+    return msg;
+}
+
+TEST_CASE("assetrecord test")
+{
+    const char* path = "assetrecord-rw.bin";
+
+    assetrecord_t* record = assetrecord_new(path, true);
+    REQUIRE(record);
+    fty_proto_t* messages[] = {
+        s_asset("datacenter-1", "my datacenter", NULL), s_asset("me", "this is me", "datacenter-1")};
+    CHECK(assetrecord_write(record, 0, messages[0]) == 0);
+    CHECK(assetrecord_write(record, 1500, messages[1]) == 0);
+    CHECK(assetrecord_size(record) == 2);
+    assetrecord_destroy(&record);
+    CHECK(!record);
+
+    // replay into resolver the same way the server feeds it
+    record                       = assetrecord_new(path, false);
+    topologyresolver_t* resolver = topologyresolver_new("me");
+    REQUIRE(record);
+    int64_t      timestamp = -1;
+    fty_proto_t* message   = assetrecord_read(record, &timestamp);
+    REQUIRE(message);
+    CHECK(timestamp == 0);
+    CHECK(streq(fty_proto_name(message), "datacenter-1"));
+    CHECK(streq(fty_proto_operation(message), FTY_PROTO_ASSET_OP_CREATE));
+    CHECK(streq(fty_proto_ext_string(message, "name", ""), "my datacenter"));
+    CHECK(!topologyresolver_asset(resolver, message));
+    fty_proto_destroy(&message);
+    message = assetrecord_read(record, &timestamp);
+    REQUIRE(message);
+    CHECK(timestamp == 1500);
+    CHECK(streq(fty_proto_aux_string(message, "parent_name.1", ""), "datacenter-1"));
+    CHECK(topologyresolver_asset(resolver, message));
+    fty_proto_destroy(&message);
+    CHECK(!assetrecord_read(record, &timestamp));
+    CHECK(assetrecord_size(record) == 2);
+    topologyresolver_destroy(&resolver);
+    assetrecord_destroy(&record);
+
+    // truncated header of a third record, then truncated frame of the second
+    FILE* file = fopen(path, "ab");
+    REQUIRE(file);
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fwrite("\0\0\0\0\0", 1, 5, file);
+    fclose(file);
+    for (size_t complete : {2, 1}) {
+        record = assetrecord_new(path, false);
+        REQUIRE(record);
+        for (size_t i = 0; i < complete; i++) {
+            message = assetrecord_read(record, &timestamp);
+            CHECK(message);
+            fty_proto_destroy(&message);
+        }
+        CHECK(!assetrecord_read(record, &timestamp));
+        CHECK(assetrecord_size(record) == complete);
+        // the replay does not go on past a corrupted record
+        CHECK(!assetrecord_read(record, &timestamp));
+        assetrecord_destroy(&record);
+        REQUIRE(truncate(path, length - 1) == 0);
+    }
+
+    // not a recording
+    file = fopen(path, "w");
+    fputs("garbage", file);
+    fclose(file);
+    CHECK(!assetrecord_new(path, false));
+    CHECK(!assetrecord_new("nonexistent/assets.bin", false));
+
+    fty_proto_destroy(&messages[0]);
+    fty_proto_destroy(&messages[1]);
+    remove(path);
+}
@@ -0,0 +1,142 @@
+#include "bench/results.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+
+static bench_result_t s_result(const char* name, double ns, double allocations, double p99)
+{
+    bench_result_t result     = bench_result(name);
+    result.ns_per_op          = ns;
+    result.allocations_per_op = allocations;
+    result.p99_us             = p99;
+    return result;
+}
+
+static size_t s_compare(const std::vector<bench_result_t>& results, const std::vector<bench_result_t>& baseline,
+    std::string* output = nullptr, bool timing = true)
+{
+    char*  buf    = NULL;
+    size_t size   = 0;
+    FILE*  file   = open_memstream(&buf, &size);
+    size_t result = bench_results_compare(results, baseline, 10, timing, file);
+    fclose(file);
+    if (output)
+        output->assign(buf, size);
+    free(buf);
+    return result;
+}
+
+TEST_CASE("benchresults test")
+{
+    const char* path = "benchresults-rw.json";
+
+    SECTION("results survive write and load")
+    {
+        bench_result_t quoted  = s_result("linuxmetric_get_all \"10\\ifaces\"", 41250.5, 630, NAN);
+        quoted.syscalls_per_op = 82;
+
+        bench_result_t requests = bench_result("INFO (8 clients)");
+        requests.p50_us         = 120.25;
+        requests.p99_us         = 480;
+        requests.p999_us        = 1500.75;
+        REQUIRE(bench_results_write(path, {quoted, requests}));
+
+        std::vector<bench_result_t> loaded;
+        REQUIRE(bench_results_load(path, &loaded));
+        REQUIRE(loaded.size() == 2);
+        CHECK(loaded[0].name == quoted.name);
+        CHECK(loaded[0].ns_per_op == Approx(41250.5));
+        CHECK(loaded[0].allocations_per_op == 630);
+        CHECK(loaded[0].syscalls_per_op == 82);
+        // not measured values stay NaN
+        CHECK(std::isnan(loaded[0].p99_us));
+        CHECK(std::isnan(loaded[0].p50_us));
+        CHECK(loaded[1].name == "INFO (8 clients)");
+        CHECK(std::isnan(loaded[1].ns_per_op));
+        CHECK(loaded[1].p50_us == Approx(120.25));
+        CHECK(loaded[1].p99_us == 480);
+        CHECK(loaded[1].p999_us == Approx(1500.75));
+
+        // a loaded file compares clean against itself
+        CHECK(s_compare(loaded, loaded) == 0);
+        remove(path);
+    }
+
+    SECTION("missing or broken file is an error")
+    {
+        std::vector<bench_result_t> loaded;
+        CHECK(!bench_results_load("nonexistent/bench.json", &loaded));
+        FILE* file = fopen(path, "w");
+        fputs("{\"git_sha\": \"39a3d51\"}", file);
+        fclose(file);
+        CHECK(!bench_results_load(path, &loaded));
+        CHECK(loaded.empty());
+        remove(path);
+    }
+
+    SECTION("values worse by more than threshold regress")
+    {
+        std::vector<bench_result_t> baseline = {s_result("get_all", 1000, 100, 50)};
+        CHECK(s_compare({s_result("get_all", 1100, 110, 55)}, baseline) == 0);
+        CHECK(s_compare({s_result("get_all", 500, 10, 5)}, baseline) == 0);
+        CHECK(s_compare({s_result("get_all", 1101, 100, 50)}, baseline) == 1);
+        CHECK(s_compare({s_result("get_all", 1000, 111, 50)}, baseline) == 1);
+        CHECK(s_compare({s_result("get_all", 1000, 100, 56)}, baseline) == 1);
+        std::string output;
+        CHECK(s_compare({s_result("get_all", 2000, 200, 100)}, baseline, &output) == 3);
+        CHECK(output.find("REGRESSION") != std::string::npos);
+        // values measured on one side only are not compared
+        CHECK(s_compare({s_result("get_all", 2000, NAN, NAN)}, {s_result("get_all", NAN, 100, 50)}) == 0);
+        // cases missing in results are reported, not counted
+        CHECK(s_compare({}, baseline, &output) == 0);
+        CHECK(output.find("get_all") != std::string::npos);
+        CHECK(output.find("not run") != std::string::npos);
+    }
+
+    SECTION("timing is compared only on the machine of the baseline")
+    {
+        bench_result_t result  = s_result("get_all", 1000, 100, 50);
+        result.syscalls_per_op = 20;
+        REQUIRE(bench_results_write(path, {result}));
+        std::vector<bench_result_t> baseline;
+        bool                        same_machine = false;
+        REQUIRE(bench_results_load(path, &baseline, &same_machine));
+        CHECK(same_machine);
+
+        FILE* file = fopen(path, "w");
+        fputs("{\"machine\": {\"hostname\": \"elsewhere\", \"cpu\": \"\", \"cpus\": 1},\n"
+              " \"results\": [{\"name\": \"get_all\", \"ns_per_op\": 1000, \"allocations_per_op\": 100,\n"
+              " \"syscalls_per_op\": 20, \"p99_us\": 50}]}",
+            file);
+        fclose(file);
+        baseline.clear();
+        REQUIRE(bench_results_load(path, &baseline, &same_machine));
+        remove(path);
+        CHECK(!same_machine);
+
+        bench_result_t slower  = s_result("get_all", 5000, 100, 500);
+        slower.syscalls_per_op = 20;
+        CHECK(s_compare({slower}, baseline) == 2);
+        std::string output;
+        CHECK(s_compare({slower}, baseline, &output, false) == 0);
+        CHECK(output.find("another machine") != std::string::npos);
+        // allocations and system calls do not depend on the machine
+        bench_result_t heavier  = s_result("get_all", 1000, 200, 50);
+        heavier.syscalls_per_op = 40;
+        CHECK(s_compare({heavier}, baseline, nullptr, false) == 2);
+    }
+
+    SECTION("any allocation over a zero allocation baseline regresses")
+    {
+        REQUIRE(bench_results_write(path, {s_result("linuxsensors_get_all", 1000, 0, NAN)}));
+        std::vector<bench_result_t> baseline;
+        REQUIRE(bench_results_load(path, &baseline));
+        remove(path);
+        REQUIRE(baseline.size() == 1);
+        CHECK(baseline[0].allocations_per_op == 0);
+        CHECK(s_compare({s_result("linuxsensors_get_all", 1000, 0, NAN)}, baseline) == 0);
+        CHECK(s_compare({s_result("linuxsensors_get_all", 1000, 0.01, NAN)}, baseline) == 1);
+        CHECK(s_compare({s_result("linuxsensors_get_all", 1000, 1, NAN)}, baseline) == 1);
+    }
+}
@@ -0,0 +1,194 @@
+#include "src/burstsampler.h"
+#include "src/infostats.h"
+#include "src/linuxmetric.h"
+#include "src/sourcereader.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <fstream>
+
+static void s_write(const std::string& path, double value)
+{
+    std::ofstream file(path, std::ofstream::trunc);
+    file << std::fixed << value << "\n";
+}
+
+TEST_CASE("burstsampler test")
+{
+    std::string root_dir = "burstsampler-rw/";
+    std::string dir      = root_dir + "sys/class/net/eth0/";
+    std::filesystem::create_directories(dir + "statistics");
+    s_write(dir + "speed", 100);
+    s_write(dir + "carrier_changes", 1);
+    s_write(dir + "statistics/rx_bytes", 0);
+    s_write(dir + "statistics/tx_bytes", 0);
+
+    sourcereader_t* reader = sourcereader_new(root_dir);
+    burstsampler_t* burst  = burstsampler_new(reader, "eth0, nonexistent", 100, 80);
+    CHECK(burstsampler_size(burst) == 2);
+    CHECK(sourcereader_size(reader) == 3);
+
+    // 1.25 MB in 100 ms saturates 100 Mbps link, then the link is idle
+    burstsampler_sample(burst, 0);
+    s_write(dir + "statistics/rx_bytes", 1250000);
+    for (int64_t now = 100; now <= 1100; now += 100) {
+        burstsampler_sample(burst, now);
+    }
+    CHECK(burstsampler_next(burst) == 1200);
+
+    linuxmetric_list_t* info   = burstsampler_get_all(burst);
+    linuxmetric_t*      metric = metriclist_find(info, "rx_peak_bandwidth_sample.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 12500000);
+    CHECK(streq(metric->unit, "Bps"));
+    // the oldest sample in the last second is the one at time 0
+    metric = metriclist_find(info, "rx_peak_bandwidth_1s.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 1136364);
+    metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 1);
+    metric = metriclist_find(info, "tx_peak_bandwidth_sample.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metric = metriclist_find(info, "tx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metriclist_destroy(&info);
+
+    // new publish window without samples
+    info = burstsampler_get_all(burst);
+    CHECK(linuxmetric_list_size(info) == 2);
+    CHECK(!metriclist_find(info, "rx_peak_bandwidth_sample.eth0"));
+    metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metriclist_destroy(&info);
+
+    // missed samples are not caught up
+    burstsampler_sample(burst, 5000);
+    CHECK(burstsampler_next(burst) == 5100);
+
+    burstsampler_destroy(&burst);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+    std::filesystem::remove_all(root_dir);
+}
+
+TEST_CASE("burstsampler unknown speed test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    burstsampler_t* burst  = burstsampler_new(reader, "LAN1", 0, 80);
+    burstsampler_sample(burst, 0);
+    burstsampler_sample(burst, 100);
+
+    // no bursts without link speed
+    linuxmetric_list_t* info = burstsampler_get_all(burst);
+    CHECK(linuxmetric_list_size(info) == 2);
+    CHECK(metriclist_find(info, "rx_peak_bandwidth_sample.LAN1"));
+    CHECK(!metriclist_find(info, "rx_bursts.LAN1"));
+    metriclist_destroy(&info);
+
+    burstsampler_destroy(&burst);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("burstsampler link change test")
+{
+    std::string root_dir = "burstsampler-link-rw/";
+    std::string dir      = root_dir + "sys/class/net/eth0/";
+    std::filesystem::create_directories(dir + "statistics");
+    // link is down at start
+    s_write(dir + "speed", -1);
+    s_write(dir + "carrier_changes", 1);
+    s_write(dir + "statistics/rx_bytes", 0);
+    s_write(dir + "statistics/tx_bytes", 0);
+
+    sourcereader_t* reader = sourcereader_new(root_dir);
+    burstsampler_t* burst  = burstsampler_new(reader, "eth0", 100, 80);
+    burstsampler_sample(burst, 0);
+    linuxmetric_list_t* info = burstsampler_get_all(burst);
+    CHECK(!metriclist_find(info, "rx_bursts.eth0"));
+    metriclist_destroy(&info);
+
+    // link comes up with 100 Mbps and is saturated
+    s_write(dir + "speed", 100);
+    s_write(dir + "carrier_changes", 2);
+    burstsampler_sample(burst, 100);
+    s_write(dir + "statistics/rx_bytes", 1250000);
+    burstsampler_sample(burst, 200);
+    info                  = burstsampler_get_all(burst);
+    linuxmetric_t* metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 1);
+    metriclist_destroy(&info);
+
+    // speed renegotiated to 1 Gbps, the same rate is no burst anymore
+    s_write(dir + "speed", 1000);
+    s_write(dir + "carrier_changes", 4);
+    burstsampler_sample(burst, 300);
+    s_write(dir + "statistics/rx_bytes", 2500000);
+    burstsampler_sample(burst, 400);
+    info   = burstsampler_get_all(burst);
+    metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metriclist_destroy(&info);
+
+    burstsampler_destroy(&burst);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+    std::filesystem::remove_all(root_dir);
+}
+
+TEST_CASE("burstsampler gap test")
+{
+    std::string root_dir = "burstsampler-gap-rw/";
+    std::string dir      = root_dir + "sys/class/net/eth0/";
+    std::filesystem::create_directories(dir + "statistics");
+    s_write(dir + "speed", 100);
+    s_write(dir + "statistics/rx_bytes", 0);
+    s_write(dir + "statistics/tx_bytes", 0);
+
+    sourcereader_t* reader = sourcereader_new(root_dir);
+    // periods longer than the 1 s window are not accepted
+    burstsampler_t* burst = burstsampler_new(reader, "eth0", 5000, 80);
+    burstsampler_sample(burst, 0);
+    CHECK(burstsampler_next(burst) == DEFAULT_BURST_PERIOD_MS);
+    burstsampler_destroy(&burst);
+
+    burst = burstsampler_new(reader, "eth0", 100, 80);
+    infostats_reset();
+    burstsampler_sample(burst, 0);
+    burstsampler_sample(burst, 100);
+    // the caller was busy for 2 s, while 2.5 MB were received
+    s_write(dir + "statistics/rx_bytes", 2500000);
+    burstsampler_sample(burst, 2100);
+    CHECK(infostats_counter(INFOSTATS_BURST_GAP) == 1);
+    linuxmetric_list_t* info   = burstsampler_get_all(burst);
+    linuxmetric_t*      metric = metriclist_find(info, "rx_peak_bandwidth_sample.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    CHECK(!metriclist_find(info, "rx_peak_bandwidth_1s.eth0"));
+    metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metriclist_destroy(&info);
+
+    // rates are taken again from the sample after the gap
+    s_write(dir + "statistics/rx_bytes", 3750000);
+    burstsampler_sample(burst, 2200);
+    info   = burstsampler_get_all(burst);
+    metric = metriclist_find(info, "rx_peak_bandwidth_sample.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 12500000);
+    metric = metriclist_find(info, "rx_bursts.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 1);
+    metriclist_destroy(&info);
+    CHECK(infostats_counter(INFOSTATS_BURST_GAP) == 1);
+
+    burstsampler_destroy(&burst);
+    sourcereader_destroy(&reader);
+    std::filesystem::remove_all(root_dir);
+}
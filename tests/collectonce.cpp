@@ -0,0 +1,38 @@
+#include "src/collectonce.h"
+#include <catch2/catch.hpp>
+#include <stdlib.h>
+#include <string.h>
+
+static std::string s_run(size_t iterations, bool json)
+{
+    char*  buf  = NULL;
+    size_t size = 0;
+    FILE*  file = open_memstream(&buf, &size);
+    REQUIRE(collectonce_run("tests/selftest-ro/data/", 30, iterations, json, file) == 0);
+    fclose(file);
+    std::string output(buf, size);
+    free(buf);
+    return output;
+}
+
+TEST_CASE("collectonce test")
+{
+    std::string output = s_run(1, false);
+    CHECK(output.find("uptime ") == 0);
+    CHECK(output.find("rx_bytes.eth0") != std::string::npos);
+    CHECK(output.find("temperature.cpu") != std::string::npos);
+    CHECK(output.find("iterations") == std::string::npos);
+
+    output = s_run(5, false);
+    CHECK(output.find("5 iterations") != std::string::npos);
+    CHECK(output.find("p95") != std::string::npos);
+
+    output = s_run(3, true);
+    CHECK(output.find("{\"metrics\":[{\"type\":\"uptime\",\"value\":1000000,\"unit\":\"sec\"}") == 0);
+    CHECK(output.find("\"timing\":{\"iterations\":3,") != std::string::npos);
+    CHECK(output.back() == '\n');
+
+    FILE* file = fopen("/dev/null", "w");
+    CHECK(collectonce_run("tests/selftest-ro/nonexistent/", 30, 1, false, file) == -1);
+    fclose(file);
+}
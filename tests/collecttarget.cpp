@@ -0,0 +1,66 @@
+#include "src/collecttarget.h"
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "src/selfmetric.h"
+#include "src/syslimits.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("collecttarget test")
+{
+    collecttarget_t* guest1 = collecttarget_new("container-1", "tests/selftest-ro/data/");
+    collecttarget_t* guest2 = collecttarget_new("container-2", "tests/selftest-ro/data/");
+    CHECK(streq(collecttarget_iname(guest1), "container-1"));
+    CHECK(collecttarget_root_dir(guest2) == "tests/selftest-ro/data/");
+
+    linuxmetric_list_t* info = collecttarget_get_all(guest1, 10, true, NULL);
+    linuxmetric_t* metric = metriclist_find(info, LINUXMETRIC_UPTIME);
+    REQUIRE(metric);
+    CHECK(metric->value == 1000000);
+    metric = metriclist_find(info, LINUXMETRIC_MEMORY_TOTAL);
+    REQUIRE(metric);
+    CHECK(metric->value == 4096);
+    CHECK(metriclist_find(info, LINUXMETRIC_PID_USAGE));
+    CHECK(metriclist_find(info, "rx_bytes.eth0"));
+    // sensors belong to the host
+    CHECK(!metriclist_find(info, LINUXMETRIC_CPU_TEMPERATURE));
+    metriclist_destroy(&info);
+    CHECK(collecttarget_duration(guest1) > 0);
+    CHECK(collecttarget_open_files(guest1) > 0);
+
+    // each target keeps its own history
+    size_t history_size = collecttarget_history_size(guest1);
+    CHECK(history_size > 2);
+    CHECK(collecttarget_history_size(guest2) == 2);
+    info = collecttarget_get_all(guest2, 10, true, NULL);
+    metriclist_destroy(&info);
+    CHECK(collecttarget_history_size(guest2) == history_size);
+    CHECK(collecttarget_history_size(guest1) == history_size);
+
+    info   = selfmetric_target(collecttarget_iname(guest2), 1500, 3, 4);
+    metric = metriclist_find(info, "fty-info.duration.container-2");
+    REQUIRE(metric);
+    CHECK(metric->value == 1.5);
+    CHECK(streq(metric->unit, "ms"));
+    metric = metriclist_find(info, "fty-info.size.history.container-2");
+    REQUIRE(metric);
+    CHECK(metric->value == 3);
+    metric = metriclist_find(info, "fty-info.open.fd.container-2");
+    REQUIRE(metric);
+    CHECK(metric->value == 4);
+    metriclist_destroy(&info);
+
+    collecttarget_destroy(&guest2);
+    collecttarget_destroy(&guest1);
+    CHECK(!guest1);
+
+    // root_dir without trailing '/' reads the same files
+    guest1 = collecttarget_new("container-1", "tests/selftest-ro/data");
+    CHECK(collecttarget_root_dir(guest1) == "tests/selftest-ro/data/");
+    info   = collecttarget_get_all(guest1, 10, true, NULL);
+    metric = metriclist_find(info, LINUXMETRIC_UPTIME);
+    REQUIRE(metric);
+    CHECK(metric->value == 1000000);
+    metriclist_destroy(&info);
+    collecttarget_destroy(&guest1);
+}
@@ -0,0 +1,242 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "fixturegen.h"
+#include <assert.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#define USER_HZ 100
+
+//  Structure of our class
+
+struct _fixturegen_t
+{
+    std::string         root_dir;
+    fixturegen_config_t config;
+    double              time; // seconds since boot
+};
+
+static void s_write(const std::string& path, const std::string& content)
+{
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+    std::ofstream file(path, std::ofstream::trunc);
+    file << content;
+}
+
+static std::string s_integer(double value)
+{
+    std::ostringstream stream;
+    stream.precision(0);
+    stream << std::fixed << value;
+    return stream.str();
+}
+
+//  Content of a sysfs file with one number
+static std::string s_number(double value)
+{
+    return s_integer(value) + "\n";
+}
+
+static void s_write_proc(fixturegen_t* self)
+{
+    const std::string& root = self->root_dir;
+    double             t    = self->time;
+    double             cpus = double(self->config.cpus);
+
+    s_write(root + "proc/uptime", s_integer(t) + ".00 " + s_integer(t * cpus * 0.6) + ".00\n");
+
+    // user nice system idle iowait irq softirq steal guest guest_nice
+    std::ostringstream stat;
+    stat.precision(0);
+    stat << std::fixed;
+    stat << "cpu  " << t * USER_HZ * 0.3 * cpus << " 0 " << t * USER_HZ * 0.1 * cpus << " "
+         << t * USER_HZ * 0.6 * cpus << " 0 0 0 0 0 0\n";
+    for (size_t cpu = 0; cpu < self->config.cpus; cpu++) {
+        stat << "cpu" << cpu << " " << t * USER_HZ * 0.3 << " 0 " << t * USER_HZ * 0.1 << " " << t * USER_HZ * 0.6
+             << " 0 0 0 0 0 0\n";
+    }
+    stat << "intr " << t * 1000 * cpus << "\nctxt " << t * 2000 * cpus << "\nbtime 1700000000\n"
+         << "processes " << 1000 + t << "\nprocs_running 2\nprocs_blocked 0\n";
+    s_write(root + "proc/stat", stat.str());
+
+    // all keys of a 5.x kernel, in kB
+    double             total = double(self->config.memory_kb);
+    std::ostringstream meminfo;
+    meminfo.precision(0);
+    meminfo << std::fixed;
+    const struct
+    {
+        const char* name;
+        double      share; // of MemTotal
+    } memory[] = {{"MemTotal", 1}, {"MemFree", 0.40}, {"MemAvailable", 0.70}, {"Buffers", 0.02},
+        {"Cached", 0.25}, {"SwapCached", 0}, {"Active", 0.30}, {"Inactive", 0.20}, {"Active(anon)", 0.15},
+        {"Inactive(anon)", 0.01}, {"Active(file)", 0.15}, {"Inactive(file)", 0.19}, {"Unevictable", 0},
+        {"Mlocked", 0}, {"SwapTotal", 0.5}, {"SwapFree", 0.45}, {"Dirty", 0.001}, {"Writeback", 0},
+        {"AnonPages", 0.16}, {"Mapped", 0.05}, {"Shmem", 0.01}, {"KReclaimable", 0.03}, {"Slab", 0.05},
+        {"SReclaimable", 0.03}, {"SUnreclaim", 0.02}, {"KernelStack", 0.002}, {"PageTables", 0.003},
+        {"NFS_Unstable", 0}, {"Bounce", 0}, {"WritebackTmp", 0}, {"CommitLimit", 1}, {"Committed_AS", 0.4},
+        {"VmallocTotal", 8192}, {"VmallocUsed", 0.01}, {"VmallocChunk", 0}, {"Percpu", 0.001},
+        {"HardwareCorrupted", 0}, {"AnonHugePages", 0.02}, {"ShmemHugePages", 0}, {"ShmemPmdMapped", 0},
+        {"FileHugePages", 0}, {"FilePmdMapped", 0}, {"HugePages_Total", 0}, {"HugePages_Free", 0},
+        {"HugePages_Rsvd", 0}, {"HugePages_Surp", 0}, {"Hugepagesize", 0}, {"Hugetlb", 0},
+        {"DirectMap4k", 0.05}, {"DirectMap2M", 0.6}, {"DirectMap1G", 0.4}};
+    for (const auto& line : memory) {
+        meminfo << line.name << ":";
+        meminfo.width(std::streamsize(24 - strlen(line.name)));
+        meminfo << total * line.share << " kB\n";
+    }
+    s_write(root + "proc/meminfo", meminfo.str());
+
+    std::ostringstream vmstat;
+    vmstat.precision(0);
+    vmstat << std::fixed << "nr_free_pages " << total * 0.1 << "\npgpgin " << t * 1000 << "\npgpgout " << t * 500
+           << "\npswpin " << t << "\npswpout " << t * 2 << "\npgfault " << t * 10000 << "\npgmajfault " << t * 10
+           << "\npgsteal_kswapd " << t * 50 << "\npgsteal_direct " << t * 5 << "\npgscan_kswapd " << t * 100
+           << "\npgscan_direct " << t * 10 << "\noom_kill 0\n";
+    s_write(root + "proc/vmstat", vmstat.str());
+
+    std::ostringstream snmp;
+    snmp.precision(0);
+    snmp << std::fixed
+         << "Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens AttemptFails EstabResets CurrEstab "
+            "InSegs OutSegs RetransSegs InErrs OutRsts InCsumErrors\n"
+         << "Tcp: 1 200 120000 -1 " << t * 10 << " " << t * 20 << " 0 0 " << 50 << " " << t * 5000 << " "
+         << t * 4000 << " " << t * 4 << " 0 0 0\n"
+         << "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors IgnoredMulti "
+            "MemErrors\n"
+         << "Udp: " << t * 100 << " 0 0 " << t * 100 << " 0 0 0 0 0\n";
+    s_write(root + "proc/net/snmp", snmp.str());
+    s_write(root + "proc/net/netstat",
+        "TcpExt: ListenOverflows ListenDrops\nTcpExt: 0 0\nIpExt: InOctets OutOctets\nIpExt: 0 0\n");
+
+    s_write(root + "proc/loadavg", "1.00 1.00 1.00 2/" + std::to_string(200 + self->config.cgroups * 10) + " 4242\n");
+    s_write(root + "proc/sys/fs/file-nr", "4096\t0\t1000000\n");
+    s_write(root + "proc/sys/fs/inode-nr", "100000\t5000\n");
+    s_write(root + "proc/sys/kernel/pid_max", "4194304\n");
+    s_write(root + "proc/sys/kernel/random/entropy_avail", "256\n");
+}
+
+static void s_write_sys(fixturegen_t* self)
+{
+    const std::string& root = self->root_dir;
+    double             t    = self->time;
+
+    s_write(root + "sys/class/net/lo/operstate", "unknown\n");
+    for (size_t i = 0; i < self->config.interfaces; i++) {
+        std::string dir  = root + "sys/class/net/eth" + std::to_string(i) + "/";
+        double      rate = double(i + 1) * 1000;
+        s_write(dir + "operstate", "up\n");
+        s_write(dir + "speed", "1000\n");
+        s_write(dir + "duplex", "full\n");
+        s_write(dir + "carrier_changes", "2\n");
+        s_write(dir + "statistics/rx_bytes", s_number(t * rate));
+        s_write(dir + "statistics/tx_bytes", s_number(t * rate / 2));
+        s_write(dir + "statistics/rx_packets", s_number(t * rate / 1000));
+        s_write(dir + "statistics/tx_packets", s_number(t * rate / 2000));
+        s_write(dir + "statistics/rx_errors", "0\n");
+        s_write(dir + "statistics/tx_errors", "0\n");
+        s_write(dir + "statistics/rx_dropped", s_number(t / 10));
+        s_write(dir + "statistics/tx_dropped", "0\n");
+    }
+
+    for (size_t zone = 0; zone < self->config.thermal_zones; zone++) {
+        std::string dir = root + "sys/class/thermal/thermal_zone" + std::to_string(zone) + "/";
+        s_write(dir + "type", zone == 0 ? "x86_pkg_temp\n" : "zone" + std::to_string(zone) + "\n");
+        s_write(dir + "temp", s_number(40000 + double(zone % 40) * 500));
+    }
+
+    for (size_t cpu = 0; cpu < self->config.cpus; cpu++) {
+        std::string dir = root + "sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/";
+        s_write(dir + "cpufreq/cpuinfo_max_freq", "3000000\n");
+        s_write(dir + "cpufreq/scaling_cur_freq", "2400000\n");
+        s_write(dir + "thermal_throttle/core_throttle_count", s_number(t / 100));
+        s_write(dir + "thermal_throttle/package_throttle_count", s_number(t / 100));
+        s_write(dir + "topology/physical_package_id", cpu < self->config.cpus / 2 ? "0\n" : "1\n");
+    }
+    if (self->config.cpus > 0)
+        s_write(root + "sys/devices/system/cpu/online", "0-" + std::to_string(self->config.cpus - 1) + "\n");
+
+    for (size_t cgroup = 0; cgroup < self->config.cgroups; cgroup++) {
+        std::string dir = root + "sys/fs/cgroup/system.slice/service" + std::to_string(cgroup) + ".service/";
+        s_write(dir + "cpu.stat", "usage_usec " + s_integer(t * 100000) + "\nuser_usec " + s_integer(t * 75000) +
+                                      "\nsystem_usec " + s_number(t * 25000));
+        s_write(dir + "memory.current", s_number(double(cgroup + 1) * 1024 * 1024));
+        s_write(dir + "pids.current", "10\n");
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Create a new fixturegen
+
+fixturegen_t* fixturegen_new(const std::string& root_dir, const fixturegen_config_t& config)
+{
+    assert(!root_dir.empty() && root_dir.back() == '/');
+    fixturegen_t* self = new fixturegen_t;
+    assert(self);
+    //  Initialize class properties here
+    self->root_dir = root_dir;
+    self->config   = config;
+    if (self->config.memory_kb == 0)
+        self->config.memory_kb = 16 * 1024 * 1024;
+    self->time = 100000;
+    s_write_proc(self);
+    s_write_sys(self);
+    return self;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy the fixturegen
+
+void fixturegen_destroy(fixturegen_t** self_p)
+{
+    assert(self_p);
+    if (*self_p) {
+        //  Free object itself
+        delete *self_p;
+        *self_p = NULL;
+    }
+}
+
+//  --------------------------------------------------------------------------
+//  Advance counters and write the next snapshot
+
+void fixturegen_advance(fixturegen_t* self, double seconds)
+{
+    assert(self);
+    self->time += seconds;
+    s_write_proc(self);
+    s_write_sys(self);
+}
+
+//  --------------------------------------------------------------------------
+//  Return root dir of the tree
+
+const std::string& fixturegen_root_dir(fixturegen_t* self)
+{
+    assert(self);
+    return self->root_dir;
+}
+
+//  --------------------------------------------------------------------------
+//  Remove the whole tree
+
+void fixturegen_remove(fixturegen_t* self)
+{
+    assert(self);
+    std::filesystem::remove_all(self->root_dir);
+}
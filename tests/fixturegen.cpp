@@ -0,0 +1,63 @@
+#include "tests/fixturegen.h"
+#include "src/collecttarget.h"
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/sourcereader.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <filesystem>
+
+TEST_CASE("fixturegen test")
+{
+    fixturegen_config_t config = {};
+    config.interfaces          = 200;
+    config.cpus                = 128;
+    config.thermal_zones       = 16;
+    config.cgroups             = 50;
+    fixturegen_t* fixture      = fixturegen_new("fixturegen-rw/", config);
+    CHECK(fixturegen_root_dir(fixture) == "fixturegen-rw/");
+    CHECK(std::filesystem::exists("fixturegen-rw/proc/stat"));
+    CHECK(std::filesystem::exists("fixturegen-rw/sys/fs/cgroup/system.slice/service49.service/cpu.stat"));
+
+    sourcereader_t* reader     = sourcereader_new("fixturegen-rw/");
+    zhashx_t*       interfaces = linuxmetric_list_interfaces(reader);
+    CHECK(zhashx_size(interfaces) == 200);
+    zhashx_destroy(&interfaces);
+
+    collecttarget_t*    target = collecttarget_new("fixture", "fixturegen-rw/");
+    linuxmetric_list_t* info   = collecttarget_get_all(target, 10, true, NULL);
+    linuxmetric_t*      metric = metriclist_find(info, LINUXMETRIC_MEMORY_TOTAL);
+    REQUIRE(metric);
+    CHECK(metric->value == 16 * 1024 * 1024);
+    metriclist_destroy(&info);
+
+    // counters grow at known rates
+    fixturegen_advance(fixture, 10);
+    info   = collecttarget_get_all(target, 10, true, NULL);
+    metric = metriclist_find(info, LINUXMETRIC_CPU_USAGE);
+    REQUIRE(metric);
+    CHECK(metric->value == 40);
+    metric = metriclist_find(info, "rx_bandwidth.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 1000);
+    metric = metriclist_find(info, "tx_bandwidth.eth199");
+    REQUIRE(metric);
+    CHECK(metric->value == 100000);
+    metriclist_destroy(&info);
+    collecttarget_destroy(&target);
+
+    linuxsensors_t* sensors = linuxsensors_new(reader);
+    zhashx_t*       history = linuxmetric_history_new();
+    info                    = linuxsensors_get_all(sensors, 10, history);
+    CHECK(metriclist_find(info, "temperature.zone15"));
+    metriclist_destroy(&info);
+    CHECK(linuxsensors_size(sensors) >= 16 + 128);
+    zhashx_destroy(&history);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+
+    fixturegen_remove(fixture);
+    CHECK(!std::filesystem::exists("fixturegen-rw/"));
+    fixturegen_destroy(&fixture);
+    CHECK(!fixture);
+}
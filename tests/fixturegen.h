@@ -0,0 +1,57 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#pragma once
+#include <stddef.h>
+#include <string>
+
+//  Synthetic /proc and /sys tree for scale tests and benchmarks.
+//
+//  The tree contains everything the collectors read: uptime, stat with one
+//  line per CPU, a full meminfo, vmstat, net/snmp and net/netstat, the
+//  limits files, network interfaces (eth0..ethN-1, all up, 1 Gbps) with
+//  their statistics, thermal zones, cpufreq and thermal_throttle of every
+//  CPU and cgroup v2 directories. Counters grow at fixed rates, so values
+//  computed by collectors after fixturegen_advance are known:
+//  - interface ethI receives (I + 1) * 1000 B/s and sends half of that
+//  - every CPU is 40 % busy (30 % user, 10 % system)
+//  - every cgroup uses 10 % of one CPU
+
+typedef struct
+{
+    size_t interfaces;    // number of network interfaces besides lo
+    size_t cpus;          // number of CPUs
+    size_t thermal_zones; // number of thermal zones, named zoneN
+    size_t cgroups;       // number of cgroups under sys/fs/cgroup
+    size_t memory_kb;     // MemTotal
+} fixturegen_config_t;
+
+typedef struct _fixturegen_t fixturegen_t;
+
+//  Create a new fixturegen and write the first snapshot under root_dir,
+//  which must end with '/'. Existing files are overwritten, other files are kept.
+fixturegen_t* fixturegen_new(const std::string& root_dir, const fixturegen_config_t& config);
+
+//  Destroy the fixturegen, the tree is kept unless fixturegen_remove was called
+void fixturegen_destroy(fixturegen_t** self_p);
+
+//  Advance all counters by seconds and write the new snapshot
+void fixturegen_advance(fixturegen_t* self, double seconds);
+
+//  Return root dir of the tree
+const std::string& fixturegen_root_dir(fixturegen_t* self);
+
+//  Remove the whole tree
+void fixturegen_remove(fixturegen_t* self);
@@ -0,0 +1,56 @@
+#include "src/ifacefilter.h"
+#include "src/linuxmetric.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("ifacefilter test")
+{
+    ifacefilter_t* filter = ifacefilter_new("", "", 0);
+    CHECK(ifacefilter_match(filter, "eth0"));
+    CHECK(ifacefilter_match(filter, "veth1234"));
+    CHECK(ifacefilter_max(filter) == 0);
+    ifacefilter_destroy(&filter);
+    CHECK(!filter);
+
+    filter = ifacefilter_new("eth*, LAN?", "eth0.*,docker*", 2);
+    CHECK(ifacefilter_match(filter, "eth0"));
+    CHECK(ifacefilter_match(filter, "LAN1"));
+    CHECK(!ifacefilter_match(filter, "LAN10"));
+    CHECK(!ifacefilter_match(filter, "eth0.100"));
+    CHECK(!ifacefilter_match(filter, "docker0"));
+    CHECK(!ifacefilter_match(filter, "veth1234"));
+    CHECK(ifacefilter_max(filter) == 2);
+    ifacefilter_destroy(&filter);
+}
+
+TEST_CASE("ifacefilter interfaces test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+
+    // LAN1 and eth0 are up, LAN2 down, lo is never listed
+    ifacefilter_t* filter     = ifacefilter_new("", "", 0);
+    zhashx_t*      interfaces = linuxmetric_list_interfaces(reader, filter);
+    CHECK(zhashx_size(interfaces) == 3);
+    CHECK(ifacefilter_dropped(filter) == 0);
+    zhashx_destroy(&interfaces);
+    ifacefilter_destroy(&filter);
+
+    filter     = ifacefilter_new("", "LAN*", 0);
+    interfaces = linuxmetric_list_interfaces(reader, filter);
+    CHECK(zhashx_size(interfaces) == 1);
+    CHECK(zhashx_lookup(interfaces, "eth0"));
+    CHECK(ifacefilter_dropped(filter) == 2);
+    zhashx_destroy(&interfaces);
+    ifacefilter_destroy(&filter);
+
+    // cap applies to interfaces which are up, in name order
+    filter     = ifacefilter_new("", "", 1);
+    interfaces = linuxmetric_list_interfaces(reader, filter);
+    CHECK(zhashx_size(interfaces) == 2);
+    CHECK(zhashx_lookup(interfaces, "LAN1"));
+    CHECK(zhashx_lookup(interfaces, "LAN2"));
+    CHECK(!zhashx_lookup(interfaces, "eth0"));
+    CHECK(ifacefilter_dropped(filter) == 1);
+    zhashx_destroy(&interfaces);
+    ifacefilter_destroy(&filter);
+    sourcereader_destroy(&reader);
+}
@@ -1,10 +1,14 @@
 #include "src/fty_info.h"
 #include "src/fty_info_server.h"
 #include "src/ftyinfo.h"
+#include "src/infostats.h"
 #include "src/linuxmetric.h"
+#include "src/selfmetric.h"
 #include <catch2/catch.hpp>
 #include <fty_shm.h>
 #include <malamute.h>
+#include <map>
+#include <string>
 
 TEST_CASE("info server test")
 {
@@ -27,6 +31,8 @@ TEST_CASE("info server test")
     mlm_client_connect(client, endpoint, 1000, "fty_info_server_test");
 
 
+    // statistics of this server only, checked by TEST #11
+    infostats_reset();
     zactor_t* info_server = zactor_new(fty_info_server, const_cast<char*>("fty-info"));
     zstr_sendx(info_server, "TEST", NULL);
     zstr_sendx(info_server, "PATH", DEFAULT_PATH, NULL);
@@ -488,9 +494,14 @@ TEST_CASE("info server test")
 
         zhashx_t* metrics = zhashx_new();
         zhashx_set_destructor(metrics, reinterpret_cast<void (*)(void**)>(fty_proto_destroy));
-        // we have 12 non-network metrics
-        size_t      number_metrics = 12;
-        zhashx_t*   interfaces     = linuxmetric_list_interfaces(root_dir);
+        // we have 15 non-network metrics (vmstat and netstat rates need two samples),
+        // 9 sensor metrics (6 sensors, temperature.cpu alias and CPU frequency
+        // with its ratio, throttle rates need two samples)
+        // 8 limits metrics (file handles, inodes, pids and entropy)
+        // and 7 self metrics (self CPU usage needs two samples)
+        size_t      number_metrics = 15 + 9 + 8 + 7;
+        sourcereader_t* reader     = sourcereader_new(root_dir);
+        zhashx_t*   interfaces     = linuxmetric_list_interfaces(reader);
         const char* state          = static_cast<const char*>(zhashx_first(interfaces));
         while (state != NULL) {
             const char* iface = static_cast<const char*>(zhashx_cursor(interfaces));
@@ -503,6 +514,7 @@ TEST_CASE("info server test")
             }
             state = static_cast<const char*>(zhashx_next(interfaces));
         }
+        sourcereader_destroy(&reader);
         {
             zclock_sleep(1000);
             fty::shm::shmMetrics results;
@@ -563,6 +575,16 @@ TEST_CASE("info server test")
         metric = static_cast<fty_proto_t*>(zhashx_lookup(metrics, LINUXMETRIC_SYSTEM_USAGE));
         CHECK(50 == atoi(fty_proto_value(metric)));
 
+        CHECK(!zhashx_lookup(metrics, SELFMETRIC_CPU_USAGE));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_MEMORY_RSS));
+        metric = static_cast<fty_proto_t*>(zhashx_lookup(metrics, SELFMETRIC_MEMORY_RSS));
+        CHECK(0 < atoi(fty_proto_value(metric)));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_MEMORY_HEAP));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_FD_OPEN));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_THREADS));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_HISTORY_SIZE));
+        CHECK(zhashx_lookup(metrics, SELFMETRIC_ASSETS_SIZE));
+
         state = static_cast<const char*>(zhashx_first(interfaces));
         while (state != NULL) {
             const char* iface = static_cast<const char*>(zhashx_cursor(interfaces));
@@ -711,6 +733,49 @@ TEST_CASE("info server test")
 
         zmsg_destroy(&recv);
     }
+    {
+        // TEST #11: statistics of the requests above
+        // metrics interval due 2 ms ago, as the timer of the agent sends it
+        zstr_sendx(info_server, "LINUXMETRICS", std::to_string(zclock_usecs() - 2000).c_str(), NULL);
+        zclock_sleep(500);
+
+        zmsg_t* stats_req = zmsg_new();
+        zmsg_addstr(stats_req, "STATS");
+        zmsg_addstr(stats_req, "uuid1236");
+
+        mlm_client_sendto(client, "fty-info", "info", NULL, 1000, &stats_req);
+
+        zmsg_t* recv = mlm_client_recv(client);
+        REQUIRE(recv);
+
+        char* val = zmsg_popstr(recv);
+        CHECK(streq(val, "uuid1236"));
+        zstr_free(&val);
+        val = zmsg_popstr(recv);
+        CHECK(streq(val, "OK"));
+        zstr_free(&val);
+        CHECK(zmsg_size(recv) == 2 * (INFOSTATS_COUNTERS + 7 * INFOSTATS_HISTOGRAMS));
+
+        std::map<std::string, std::string> stats;
+        char*                              name = zmsg_popstr(recv);
+        while (name) {
+            val         = zmsg_popstr(recv);
+            stats[name] = val ? val : "";
+            zstr_free(&val);
+            zstr_free(&name);
+            name = zmsg_popstr(recv);
+        }
+        CHECK(stats["mailbox.HW_CAP.count"] == "3");
+        CHECK(std::stol(stats["mailbox.INFO.count"]) > 0);
+        CHECK(std::stol(stats["stream.processed"]) > 0);
+        CHECK(std::stol(stats["metrics.interval.count"]) > 0);
+        CHECK(std::stol(stats["poll.lag.count"]) > 0);
+        CHECK(std::stol(stats["poll.lag.max_us"]) >= 2000);
+        CHECK(stats["topology.fetch_timeout"] == "0");
+        CHECK(stats["mailbox.STATS.count"] == "0");
+
+        zmsg_destroy(&recv);
+    }
 
     mlm_client_destroy(&asset_generator);
     //  @end
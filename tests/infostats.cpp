@@ -0,0 +1,127 @@
+#include "src/infostats.h"
+#include "src/linuxmetric.h"
+#include <catch2/catch.hpp>
+#include <map>
+#include <string>
+#include <thread>
+
+TEST_CASE("infostats test")
+{
+    infostats_reset();
+
+    SECTION("counters of all threads are summed")
+    {
+        infostats_add(INFOSTATS_STREAM_PROCESSED);
+        infostats_add(INFOSTATS_STREAM_PROCESSED, 2);
+        std::thread thread([] {
+            for (int i = 0; i < 1000; i++) {
+                infostats_add(INFOSTATS_STREAM_PROCESSED);
+            }
+            infostats_add(INFOSTATS_ANNOUNCE_FAILED);
+        });
+        thread.join();
+        CHECK(infostats_counter(INFOSTATS_STREAM_PROCESSED) == 1003);
+        CHECK(infostats_counter(INFOSTATS_ANNOUNCE_FAILED) == 1);
+        CHECK(infostats_counter(INFOSTATS_STREAM_IGNORED) == 0);
+        CHECK(std::string(infostats_counter_name(INFOSTATS_STREAM_PROCESSED)) == "stream.processed");
+        CHECK(std::string(infostats_counter_name(INFOSTATS_TOPOLOGY_FETCH_TIMEOUT)) == "topology.fetch_timeout");
+    }
+
+    SECTION("histogram percentiles are within 1/16")
+    {
+        // 1 .. 100000 us, uniformly
+        for (int64_t value = 1; value <= 100000; value++) {
+            infostats_record(INFOSTATS_INFO, value);
+        }
+        infostats_summary_t summary = infostats_histogram(INFOSTATS_INFO);
+        CHECK(summary.count == 100000);
+        CHECK(summary.mean == Approx(50000.5));
+        CHECK(summary.max == 100000);
+        CHECK(summary.p50 >= 50000);
+        CHECK(summary.p50 <= 50000 + 50000 / 16);
+        CHECK(summary.p99 >= 99000);
+        CHECK(summary.p99 <= 99000 + 99000 / 16);
+        CHECK(summary.p999 <= summary.max);
+
+        // small values are exact, huge ones end up in the last bucket
+        infostats_record(INFOSTATS_HW_CAP, 7);
+        infostats_record(INFOSTATS_HW_CAP, 7);
+        summary = infostats_histogram(INFOSTATS_HW_CAP);
+        CHECK(summary.p50 == 7);
+        CHECK(summary.p999 == 7);
+        infostats_record(INFOSTATS_POLL_LAG, INT64_MAX);
+        infostats_record(INFOSTATS_POLL_LAG, -5);
+        summary = infostats_histogram(INFOSTATS_POLL_LAG);
+        CHECK(summary.count == 2);
+        CHECK(summary.p50 == 0);
+        CHECK(summary.max == INT64_MAX);
+
+        // 2^40 .. 2^41 - 1 us fill the last buckets, nothing past them
+        infostats_record(INFOSTATS_TOPOLOGY_FETCH, 1LL << 40);
+        infostats_record(INFOSTATS_TOPOLOGY_FETCH, (1LL << 41) - 1);
+        summary = infostats_histogram(INFOSTATS_TOPOLOGY_FETCH);
+        CHECK(summary.count == 2);
+        CHECK(summary.max == (1LL << 41) - 1);
+        CHECK(summary.p50 >= 1LL << 40);
+        CHECK(summary.p50 <= (1LL << 40) + (1LL << 40) / 16);
+        CHECK(summary.p99 == (1LL << 41) - 1);
+        summary = infostats_histogram(INFOSTATS_POLL_LAG);
+        CHECK(summary.count == 2);
+        CHECK(summary.p50 == 0);
+
+        // merged over threads
+        std::thread thread([] {
+            infostats_record(INFOSTATS_HW_CAP, 1000);
+            infostats_record(INFOSTATS_HW_CAP, 1000);
+        });
+        thread.join();
+        summary = infostats_histogram(INFOSTATS_HW_CAP);
+        CHECK(summary.count == 4);
+        CHECK(summary.p50 == 7);
+        CHECK(summary.p99 >= 1000);
+        CHECK(summary.p99 <= 1000 + 1000 / 16);
+    }
+
+    SECTION("message and metrics")
+    {
+        infostats_add(INFOSTATS_MAILBOX_UNEXPECTED, 3);
+        infostats_record(INFOSTATS_STATS, 250);
+
+        zmsg_t*                            msg = zmsg_new();
+        std::map<std::string, std::string> values;
+        infostats_to_msg(msg);
+        CHECK(zmsg_size(msg) == 2 * (INFOSTATS_COUNTERS + 7 * INFOSTATS_HISTOGRAMS));
+        char* name = zmsg_popstr(msg);
+        while (name) {
+            char* value  = zmsg_popstr(msg);
+            values[name] = value;
+            zstr_free(&value);
+            zstr_free(&name);
+            name = zmsg_popstr(msg);
+        }
+        zmsg_destroy(&msg);
+        CHECK(values["mailbox.unexpected"] == "3");
+        CHECK(values["mailbox.STATS.count"] == "1");
+        CHECK(values["mailbox.STATS.max_us"] == "250");
+        CHECK(values["mailbox.INFO.count"] == "0");
+
+        linuxmetric_list_t* info = infostats_metrics();
+        CHECK(linuxmetric_list_size(info) == INFOSTATS_COUNTERS + 2 * INFOSTATS_HISTOGRAMS);
+        std::map<std::string, double> metrics;
+        linuxmetric_t*                metric = linuxmetric_list_first(info);
+        while (metric) {
+            metrics[metric->type] = metric->value;
+            metric                = linuxmetric_list_next(info);
+        }
+        linuxmetric_list_destroy(&info);
+        CHECK(metrics["fty-info.count.mailbox.unexpected"] == 3);
+        CHECK(metrics["fty-info.count.mailbox.stats"] == 1);
+        CHECK(metrics["fty-info.p99.mailbox.stats"] == Approx(0.25).epsilon(1.0 / 16));
+        CHECK(metrics["fty-info.count.mailbox.error"] == 0);
+        CHECK(metrics.count("fty-info.count.mailbox.info_test") == 1);
+        CHECK(metrics.count("fty-info.p99.mailbox.hw_cap") == 1);
+        CHECK(metrics.count("fty-info.count.mailbox.INFO-TEST") == 0);
+    }
+
+    infostats_reset();
+}
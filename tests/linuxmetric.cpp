@@ -0,0 +1,233 @@
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <cmath>
+
+TEST_CASE("linuxmetric vmstat test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    zhashx_t*       history = linuxmetric_history_new();
+
+    linuxmetric_list_t* info = linuxmetric_get_all(10, history, reader, true);
+
+    linuxmetric_t* metric = metriclist_find(info, LINUXMETRIC_SWAP_TOTAL);
+    REQUIRE(metric);
+    CHECK(metric->value == 2048);
+    metric = metriclist_find(info, LINUXMETRIC_SWAP_USED);
+    REQUIRE(metric);
+    CHECK(metric->value == 512);
+    metric = metriclist_find(info, LINUXMETRIC_SWAP_USAGE);
+    REQUIRE(metric);
+    CHECK(metric->value == 25);
+
+    // rates need two samples
+    CHECK(!metriclist_find(info, LINUXMETRIC_MAJFAULT_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_SWAPIN_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_SWAPOUT_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_PGSCAN_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_PGSTEAL_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_OOM_KILL_RATE));
+    metriclist_destroy(&info);
+
+    // pretend the counters were lower during the previous interval
+    *static_cast<double*>(zhashx_lookup(history, VMSTAT_HISTORY_PREFIX "_pgmajfault")) -= 100;
+    *static_cast<double*>(zhashx_lookup(history, VMSTAT_HISTORY_PREFIX "_pgscan")) -= 1000;
+
+    info   = linuxmetric_get_all(10, history, reader, true);
+    metric = metriclist_find(info, LINUXMETRIC_MAJFAULT_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 10);
+    metric = metriclist_find(info, LINUXMETRIC_PGSCAN_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 100);
+    metric = metriclist_find(info, LINUXMETRIC_SWAPIN_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    CHECK(metriclist_find(info, LINUXMETRIC_SWAPOUT_RATE));
+    CHECK(metriclist_find(info, LINUXMETRIC_PGSTEAL_RATE));
+    CHECK(metriclist_find(info, LINUXMETRIC_OOM_KILL_RATE));
+    metriclist_destroy(&info);
+
+    // pgscan is the sum of kswapd, direct and khugepaged counters
+    double* pgscan = static_cast<double*>(zhashx_lookup(history, VMSTAT_HISTORY_PREFIX "_pgscan"));
+    REQUIRE(pgscan);
+    CHECK(*pgscan == 30000);
+
+    zhashx_destroy(&history);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxmetric netstat test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    zhashx_t*       history = linuxmetric_history_new();
+
+    linuxmetric_list_t* info   = linuxmetric_get_all(10, history, reader, true);
+    linuxmetric_t*      metric = metriclist_find(info, LINUXMETRIC_TCP_ESTABLISHED);
+    REQUIRE(metric);
+    CHECK(metric->value == 12);
+    // rates need two samples
+    CHECK(!metriclist_find(info, LINUXMETRIC_TCP_RETRANS_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_UDP_RCVBUF_ERROR_RATE));
+    metriclist_destroy(&info);
+
+    // counters from both files are stored
+    double* retrans = static_cast<double*>(zhashx_lookup(history, NETSTAT_HISTORY_PREFIX "_Tcp.RetransSegs"));
+    REQUIRE(retrans);
+    CHECK(*retrans == 300);
+    double* overflows = static_cast<double*>(zhashx_lookup(history, NETSTAT_HISTORY_PREFIX "_TcpExt.ListenOverflows"));
+    REQUIRE(overflows);
+    CHECK(*overflows == 4);
+
+    // pretend the counters were lower during the previous interval
+    *retrans -= 50;
+    *overflows -= 20;
+    info   = linuxmetric_get_all(10, history, reader, true);
+    metric = metriclist_find(info, LINUXMETRIC_TCP_RETRANS_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 5);
+    CHECK(streq(metric->unit, "/s"));
+    metric = metriclist_find(info, LINUXMETRIC_TCP_LISTEN_OVERFLOW_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 2);
+    metric = metriclist_find(info, LINUXMETRIC_TCP_LISTEN_DROP_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    CHECK(metriclist_find(info, LINUXMETRIC_TCP_ACTIVE_OPEN_RATE));
+    CHECK(metriclist_find(info, LINUXMETRIC_TCP_PASSIVE_OPEN_RATE));
+    CHECK(metriclist_find(info, LINUXMETRIC_UDP_RCVBUF_ERROR_RATE));
+    metriclist_destroy(&info);
+
+    zhashx_destroy(&history);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxmetric link test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    zhashx_t*       history = linuxmetric_history_new();
+
+    // utilization, drop rates and flaps need two samples
+    linuxmetric_list_t* info = linuxmetric_get_all(10, history, reader, true);
+    CHECK(!metriclist_find(info, "rx_utilization.eth0"));
+    CHECK(!metriclist_find(info, "rx_drop_rate.eth0"));
+    CHECK(!metriclist_find(info, "link_flaps.eth0"));
+    metriclist_destroy(&info);
+    // link speed was cached
+    double* speed = static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_speed_eth0"));
+    REQUIRE(speed);
+    CHECK(*speed == 100);
+
+    // 12.5 MB received over 10 s on 100 Mbps link
+    *static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_rx_eth0")) -= 12500000;
+    *static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_rx_dropped_eth0")) -= 50;
+    // cached speed is used while there is no link event
+    *speed = 50;
+    info                  = linuxmetric_get_all(10, history, reader, true);
+    linuxmetric_t* metric = metriclist_find(info, "rx_utilization.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 20);
+    CHECK(streq(metric->unit, "%"));
+    metric = metriclist_find(info, "tx_utilization.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metric = metriclist_find(info, "rx_drop_rate.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 5);
+    metric = metriclist_find(info, "tx_drop_rate.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metric = metriclist_find(info, "link_flaps.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    // LAN1 does not report link speed nor drops
+    CHECK(!metriclist_find(info, "rx_utilization.LAN1"));
+    CHECK(!metriclist_find(info, "rx_drop_rate.LAN1"));
+    metriclist_destroy(&info);
+
+    // link went down and up, speed is read again
+    *static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_carrier_eth0")) -= 2;
+    *static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_link_carrier_eth0")) -= 2;
+    *static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_rx_eth0")) -= 12500000;
+    info   = linuxmetric_get_all(10, history, reader, true);
+    metric = metriclist_find(info, "link_flaps.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 2);
+    CHECK(*speed == 100);
+    metric = metriclist_find(info, "rx_utilization.eth0");
+    REQUIRE(metric);
+    CHECK(metric->value == 10);
+    metriclist_destroy(&info);
+
+    // carrier_changes of LAN1 can't be read, which is no link event
+    double* lan_speed = static_cast<double*>(zhashx_lookup(history, NETWORK_HISTORY_PREFIX "_speed_LAN1"));
+    REQUIRE(lan_speed);
+    CHECK(*lan_speed == 0);
+    *lan_speed          = 10;
+    double* lan_carrier = static_cast<double*>(zmalloc(sizeof(double)));
+    *lan_carrier        = 3;
+    zhashx_insert(history, NETWORK_HISTORY_PREFIX "_link_carrier_LAN1", lan_carrier);
+    info = linuxmetric_get_all(10, history, reader, true);
+    CHECK(*lan_speed == 10);
+    CHECK(!metriclist_find(info, "link_flaps.LAN1"));
+    metriclist_destroy(&info);
+
+    zhashx_destroy(&history);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxmetric syscalls test")
+{
+    // fixtures are always parsed from files
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    CHECK(!linuxmetric_live_root(reader));
+    CHECK(linuxmetric_uptime(reader, false) == 1000000);
+    linuxmetric_memory_t memory;
+    REQUIRE(linuxmetric_memory(reader, false, &memory));
+    CHECK(memory.total == 4096);
+    CHECK(memory.cached == 512);
+    CHECK(memory.swap_free == 1536);
+    // sysinfo(2) is only a fallback for unreadable meminfo
+    REQUIRE(linuxmetric_memory(reader, true, &memory));
+    CHECK(memory.total == 4096);
+    CHECK(memory.free == 2048);
+    sourcereader_destroy(&reader);
+
+    // on the live host both paths must agree
+    reader = sourcereader_new("/");
+    CHECK(linuxmetric_live_root(reader));
+    double uptime_file    = linuxmetric_uptime(reader, false);
+    double uptime_syscall = linuxmetric_uptime(reader, true);
+    CHECK(std::fabs(uptime_syscall - uptime_file) < 1);
+
+    linuxmetric_memory_t file, syscall;
+    REQUIRE(linuxmetric_memory(reader, false, &file));
+    REQUIRE(linuxmetric_memory(reader, true, &syscall));
+    // both come from meminfo, free memory moves between the reads
+    double tolerance = file.total / 50;
+    CHECK(syscall.total == file.total);
+    CHECK(syscall.swap_total == file.swap_total);
+    CHECK(std::fabs(syscall.free - file.free) < tolerance);
+    CHECK(std::fabs(syscall.buffers - file.buffers) < tolerance);
+    CHECK(std::fabs(syscall.shmem - file.shmem) < tolerance);
+    CHECK(std::fabs(syscall.swap_free - file.swap_free) < tolerance);
+    CHECK(std::fabs(syscall.cached - file.cached) < tolerance);
+    CHECK(std::fabs(syscall.reclaimable - file.reclaimable) < tolerance);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxmetric storage test")
+{
+    // fixture has no var/, only the root file system is reported
+    sourcereader_t*     reader  = sourcereader_new("tests/selftest-ro/data");
+    zhashx_t*           history = linuxmetric_history_new();
+    linuxmetric_list_t* info    = linuxmetric_get_all(10, history, reader, false);
+    CHECK(!metriclist_find(info, LINUXMETRIC_DATA0_TOTAL));
+    CHECK(!metriclist_find(info, LINUXMETRIC_DATA0_USAGE));
+    CHECK(metriclist_find(info, LINUXMETRIC_SYSTEM_TOTAL));
+    CHECK(metriclist_find(info, LINUXMETRIC_UPTIME));
+    metriclist_destroy(&info);
+    zhashx_destroy(&history);
+    sourcereader_destroy(&reader);
+}
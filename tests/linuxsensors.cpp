@@ -0,0 +1,331 @@
+#include "src/ftyinfo.h"
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/sourcereader.h"
+#include "tests/fixturegen.h"
+#include "tests/metriclist.h"
+#include <fstream>
+#include <vector>
+#include <catch2/catch.hpp>
+
+TEST_CASE("sourcereader test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    CHECK(sourcereader_root_dir(reader) == "tests/selftest-ro/data/");
+
+    char buf[32];
+    int  handle = sourcereader_open(reader, "proc/uptime");
+    REQUIRE(handle >= 0);
+    CHECK(sourcereader_size(reader) == 1);
+    // the file can be read again and again
+    CHECK(sourcereader_read(reader, handle, buf, sizeof(buf)) > 0);
+    CHECK(strtod(buf, NULL) == 1000000);
+    CHECK(sourcereader_read(reader, handle, buf, sizeof(buf)) > 0);
+    CHECK(strtod(buf, NULL) == 1000000);
+    // content is truncated to fit buffer
+    CHECK(sourcereader_read(reader, handle, buf, 4) == 3);
+    CHECK(streq(buf, "100"));
+
+    CHECK(sourcereader_open(reader, "proc/nonexistent") == -1);
+    CHECK(sourcereader_read(reader, -1, buf, sizeof(buf)) == -1);
+    CHECK(streq(buf, ""));
+    CHECK(sourcereader_read_once(reader, "sys/class/net/eth0/operstate", buf, sizeof(buf)) > 0);
+    CHECK(streq(buf, "up\n"));
+    CHECK(sourcereader_size(reader) == 1);
+
+    sourcereader_close(reader, handle);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+    CHECK(!reader);
+}
+
+TEST_CASE("sourcereader batch test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    // pread is always available
+    CHECK(sourcereader_set_backend(reader, SOURCEREADER_PREAD) == SOURCEREADER_PREAD);
+
+    for (sourcereader_backend_t backend : {SOURCEREADER_PREAD, SOURCEREADER_IO_URING}) {
+        // io_uring falls back to pread when not available
+        sourcereader_backend_t used = sourcereader_set_backend(reader, backend);
+        CHECK(sourcereader_backend(reader) == used);
+
+        int                  uptime = sourcereader_open(reader, "proc/uptime");
+        int                  state  = sourcereader_open(reader, "sys/class/net/eth0/operstate");
+        sourcereader_value_t values[3];
+        sourcereader_queue(reader, uptime, &values[0]);
+        sourcereader_queue(reader, state, &values[1]);
+        sourcereader_queue(reader, -1, &values[2]);
+        sourcereader_submit(reader);
+        CHECK(values[0].size > 0);
+        CHECK(strtod(values[0].data, NULL) == 1000000);
+        CHECK(streq(values[1].data, "up\n"));
+        CHECK(values[2].size == -1);
+        CHECK(streq(values[2].data, ""));
+
+        // files can be read again after new files were opened
+        int max_freq = sourcereader_open(reader, "sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+        sourcereader_queue(reader, max_freq, &values[2]);
+        sourcereader_queue(reader, uptime, &values[0]);
+        sourcereader_submit(reader);
+        CHECK(strtod(values[2].data, NULL) == 2400000);
+        CHECK(strtod(values[0].data, NULL) == 1000000);
+
+        sourcereader_close(reader, max_freq);
+        sourcereader_close(reader, state);
+        sourcereader_close(reader, uptime);
+    }
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("sourcereader lookup test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    for (sourcereader_backend_t backend : {SOURCEREADER_PREAD, SOURCEREADER_IO_URING}) {
+        sourcereader_set_backend(reader, backend);
+
+        // files are cached by path
+        int uptime = sourcereader_lookup(reader, "proc/uptime");
+        REQUIRE(uptime >= 0);
+        CHECK(sourcereader_lookup(reader, "proc/uptime") == uptime);
+        CHECK(sourcereader_lookup(reader, "proc/nonexistent") == -1);
+        CHECK(sourcereader_size(reader) == 1);
+
+        // more files than the initial registered table holds, opened and
+        // closed between batches
+        std::vector<int> handles;
+        for (int i = 0; i < 100; i++) {
+            handles.push_back(sourcereader_open(reader, "sys/class/net/eth0/operstate"));
+        }
+        std::vector<sourcereader_value_t> values(handles.size() + 1);
+        for (size_t i = 0; i < handles.size(); i++) {
+            sourcereader_queue(reader, handles[i], &values[i]);
+        }
+        sourcereader_queue(reader, uptime, &values.back());
+        sourcereader_submit(reader);
+        for (size_t i = 0; i < handles.size(); i++) {
+            CHECK(streq(values[i].data, "up\n"));
+        }
+        CHECK(strtod(values.back().data, NULL) == 1000000);
+        for (size_t i = 0; i < handles.size(); i += 2) {
+            sourcereader_close(reader, handles[i]);
+        }
+        // read_once neither keeps nor registers its fd
+        char buf[32];
+        CHECK(sourcereader_read_once(reader, "proc/uptime", buf, sizeof(buf)) > 0);
+        CHECK(sourcereader_size(reader) == 51);
+        int freq = sourcereader_open(reader, "sys/devices/system/cpu/cpu0/cpufreq/cpuinfo_max_freq");
+        sourcereader_queue(reader, freq, &values[0]);
+        sourcereader_queue(reader, handles[1], &values[1]);
+        sourcereader_submit(reader);
+        CHECK(strtod(values[0].data, NULL) == 2400000);
+        CHECK(streq(values[1].data, "up\n"));
+        sourcereader_close(reader, freq);
+        for (size_t i = 1; i < handles.size(); i += 2) {
+            sourcereader_close(reader, handles[i]);
+        }
+
+        // a file which failed to read is opened again by the next lookup
+        int dir = sourcereader_lookup(reader, "sys/class/net");
+        REQUIRE(dir >= 0);
+        sourcereader_queue(reader, dir, &values[0]);
+        sourcereader_submit(reader);
+        CHECK(values[0].size == -1);
+        CHECK(sourcereader_lookup(reader, "sys/class/net") >= 0);
+        CHECK(sourcereader_size(reader) == 2);
+
+        // files not looked up since the previous sweep are closed
+        sourcereader_sweep(reader);
+        CHECK(sourcereader_size(reader) == 2);
+        sourcereader_lookup(reader, "proc/uptime");
+        sourcereader_sweep(reader);
+        CHECK(sourcereader_size(reader) == 1);
+        sourcereader_sweep(reader);
+        CHECK(sourcereader_size(reader) == 0);
+
+        // read_cached keeps the file open under its path
+        char meminfo[4096];
+        CHECK(sourcereader_read_cached(reader, "proc/meminfo", meminfo, sizeof(meminfo)) > 0);
+        CHECK(strncmp(meminfo, "MemTotal:", 9) == 0);
+        CHECK(sourcereader_size(reader) == 1);
+        CHECK(sourcereader_read_cached(reader, "proc/meminfo", meminfo, sizeof(meminfo)) > 0);
+        CHECK(sourcereader_size(reader) == 1);
+        CHECK(sourcereader_read_cached(reader, "sys/class/net", meminfo, sizeof(meminfo)) == -1);
+        CHECK(sourcereader_read_cached(reader, "proc/nonexistent", meminfo, sizeof(meminfo)) == -1);
+        CHECK(sourcereader_size(reader) == 2);
+        sourcereader_sweep(reader);
+        sourcereader_sweep(reader);
+        CHECK(sourcereader_size(reader) == 0);
+    }
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxsensors test")
+{
+    sourcereader_t* reader  = sourcereader_new("tests/selftest-ro/data/");
+    linuxsensors_t* sensors = linuxsensors_new(reader);
+
+    linuxmetric_list_t* info = linuxsensors_get_all(sensors, 30, NULL);
+    // 3 thermal zones, 2 hwmon temperatures, 1 fan and 2 CPUs
+    CHECK(linuxsensors_size(sensors) == 8);
+    // package counter is opened once for both CPUs of package 0
+    CHECK(sourcereader_size(reader) == 6 + 5);
+    CHECK(linuxmetric_list_size(info) == 9);
+
+    linuxmetric_t* metric = metriclist_find(info, "temperature.x86_pkg_temp");
+    REQUIRE(metric);
+    CHECK(metric->value == 50);
+    CHECK(streq(metric->unit, "C"));
+    // zone of x86_pkg_temp type is the CPU one
+    metric = metriclist_find(info, LINUXMETRIC_CPU_TEMPERATURE);
+    REQUIRE(metric);
+    CHECK(metric->value == 50);
+    // duplicate types get the zone number
+    metric = metriclist_find(info, "temperature.acpitz_1");
+    REQUIRE(metric);
+    CHECK(metric->value == 45);
+    metric = metriclist_find(info, "temperature.acpitz_2");
+    REQUIRE(metric);
+    CHECK(metric->value == 40);
+    // hwmon with and without label
+    metric = metriclist_find(info, "temperature.coretemp_Package_id_0");
+    REQUIRE(metric);
+    CHECK(metric->value == 52);
+    metric = metriclist_find(info, "temperature.coretemp_temp2");
+    REQUIRE(metric);
+    CHECK(metric->value == 51);
+    metric = metriclist_find(info, "fan.nct6775_fan1");
+    REQUIRE(metric);
+    CHECK(metric->value == 1200);
+    CHECK(streq(metric->unit, "rpm"));
+    // average of 1800 and 1200 MHz, max is 2400 MHz
+    metric = metriclist_find(info, LINUXMETRIC_CPU_FREQUENCY);
+    REQUIRE(metric);
+    CHECK(metric->value == 1500);
+    CHECK(streq(metric->unit, "MHz"));
+    metric = metriclist_find(info, LINUXMETRIC_CPU_FREQUENCY_RATIO);
+    REQUIRE(metric);
+    CHECK(metric->value == 62);
+    CHECK(!metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE));
+    metriclist_destroy(&info);
+
+    // no rediscovery, files stay open
+    info = linuxsensors_get_all(sensors, 30, NULL);
+    CHECK(linuxmetric_list_size(info) == 9);
+    CHECK(sourcereader_size(reader) == 6 + 5);
+    metriclist_destroy(&info);
+
+    linuxsensors_destroy(&sensors);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxsensors throttle test")
+{
+    sourcereader_t* reader  = sourcereader_new("tests/selftest-ro/data/");
+    linuxsensors_t* sensors = linuxsensors_new(reader);
+    zhashx_t*       history = linuxmetric_history_new();
+
+    // throttle rates need two samples
+    linuxmetric_list_t* info = linuxsensors_get_all(sensors, 30, history);
+    CHECK(!metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE));
+    CHECK(!metriclist_find(info, LINUXMETRIC_CPU_PKG_THROTTLE_RATE));
+    // one history entry per core and package
+    CHECK(*static_cast<double*>(zhashx_lookup(history, HIST_CPU_CORE_THROTTLE "_0")) == 10);
+    CHECK(*static_cast<double*>(zhashx_lookup(history, HIST_CPU_CORE_THROTTLE "_1")) == 20);
+    CHECK(*static_cast<double*>(zhashx_lookup(history, HIST_CPU_PKG_THROTTLE "_0")) == 5);
+    CHECK(!zhashx_lookup(history, HIST_CPU_PKG_THROTTLE "_1"));
+    metriclist_destroy(&info);
+
+    // counters did not change
+    info                  = linuxsensors_get_all(sensors, 30, history);
+    linuxmetric_t* metric = metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    CHECK(streq(metric->unit, "/s"));
+    metric = metriclist_find(info, LINUXMETRIC_CPU_PKG_THROTTLE_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 0);
+    metriclist_destroy(&info);
+
+    // 60 core throttle events over 30 s
+    double* core = static_cast<double*>(zhashx_lookup(history, HIST_CPU_CORE_THROTTLE "_1"));
+    *core -= 60;
+    info   = linuxsensors_get_all(sensors, 30, history);
+    metric = metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 2);
+    metriclist_destroy(&info);
+
+    zhashx_destroy(&history);
+
+    linuxsensors_destroy(&sensors);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("linuxsensors CPU hotplug test")
+{
+    fixturegen_config_t config = {};
+    config.cpus                = 2;
+    fixturegen_t*   fixture    = fixturegen_new("linuxsensors-rw/", config);
+    std::string     cpu_dir    = std::string(fixturegen_root_dir(fixture)) + "sys/devices/system/cpu/";
+    sourcereader_t* reader     = sourcereader_new(fixturegen_root_dir(fixture));
+    linuxsensors_t* sensors    = linuxsensors_new(reader);
+    zhashx_t*       history    = linuxmetric_history_new();
+
+    linuxmetric_list_t* info = linuxsensors_get_all(sensors, 30, history);
+    CHECK(linuxsensors_size(sensors) == 2);
+    metriclist_destroy(&info);
+
+    // cpu1 goes offline, its cpufreq and thermal_throttle entries disappear
+    const char* files[] = {"cpufreq/scaling_cur_freq", "thermal_throttle/core_throttle_count",
+        "thermal_throttle/package_throttle_count"};
+    std::ofstream(cpu_dir + "online") << "0\n";
+    for (const char* file : files) {
+        std::remove((cpu_dir + "cpu1/" + file).c_str());
+    }
+    info = linuxsensors_get_all(sensors, 30, history);
+    CHECK(linuxsensors_size(sensors) == 1);
+    metriclist_destroy(&info);
+
+    // cpu1 comes back online and is rediscovered
+    for (const char* file : files) {
+        std::ofstream(cpu_dir + "cpu1/" + file) << "0\n";
+    }
+    std::ofstream(cpu_dir + "online") << "0-1\n";
+    info = linuxsensors_get_all(sensors, 30, history);
+    CHECK(linuxsensors_size(sensors) == 2);
+    metriclist_destroy(&info);
+
+    // throttle rate of the cores which could be read, cpu1 is offline for
+    // one interval and then counts on from where it was
+    std::string core0 = cpu_dir + "cpu0/thermal_throttle/core_throttle_count";
+    std::string core1 = cpu_dir + "cpu1/thermal_throttle/core_throttle_count";
+    std::ofstream(core0) << "100\n";
+    std::ofstream(core1) << "1000\n";
+    info = linuxsensors_get_all(sensors, 30, history);
+    metriclist_destroy(&info);
+    std::ofstream(cpu_dir + "online") << "0\n";
+    std::remove(core1.c_str());
+    std::ofstream(core0) << "130\n";
+    info                  = linuxsensors_get_all(sensors, 30, history);
+    linuxmetric_t* metric = metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 1);
+    metriclist_destroy(&info);
+    std::ofstream(cpu_dir + "online") << "0-1\n";
+    std::ofstream(core0) << "160\n";
+    std::ofstream(core1) << "1060\n";
+    info   = linuxsensors_get_all(sensors, 30, history);
+    metric = metriclist_find(info, LINUXMETRIC_CPU_THROTTLE_RATE);
+    REQUIRE(metric);
+    CHECK(metric->value == 3);
+    metriclist_destroy(&info);
+
+    zhashx_destroy(&history);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+    fixturegen_remove(fixture);
+    fixturegen_destroy(&fixture);
+}
@@ -0,0 +1,121 @@
+#include "src/linuxmetric.h"
+#include "src/linuxsensors.h"
+#include "src/metricarena.h"
+#include "src/syslimits.h"
+#include "tests/allocbudget.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <stdint.h>
+
+//  Metrics and types created by one interval, as the collectors do
+static void s_tick(linuxmetric_t** metrics, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        metrics[i]        = linuxmetric_new();
+        metrics[i]->type  = linuxmetric_sprintf("rx_bandwidth.eth%zu", i);
+        metrics[i]->value = double(i);
+        metrics[i]->unit  = "Bps";
+    }
+    for (size_t i = 0; i < count; i++) {
+        linuxmetric_destroy(&metrics[i]);
+    }
+}
+
+TEST_CASE("metricarena test")
+{
+    metricarena_t* arena = metricarena_new(64);
+    CHECK(metricarena_capacity(arena) == 64);
+
+    char* a = static_cast<char*>(metricarena_alloc(arena, 3));
+    double* b = static_cast<double*>(metricarena_alloc(arena, sizeof(double)));
+    CHECK(reinterpret_cast<uintptr_t>(b) % alignof(max_align_t) == 0);
+    CHECK(a[0] == 0);
+    CHECK(*b == 0);
+    CHECK(streq(metricarena_strdup(arena, "usage.cpu"), "usage.cpu"));
+    CHECK(streq(metricarena_sprintf(arena, "%s_bandwidth.%s", "rx", "eth0"), "rx_bandwidth.eth0"));
+
+    // larger than the first chunk
+    char* big = static_cast<char*>(metricarena_alloc(arena, 1000));
+    big[999]  = 'x';
+    CHECK(metricarena_capacity(arena) > 1000);
+    CHECK(metricarena_used(arena) > 1000);
+
+    // chunks are merged on reset and the next interval fits into one
+    size_t capacity = metricarena_capacity(arena);
+    metricarena_reset(arena);
+    CHECK(metricarena_used(arena) == 0);
+    CHECK(metricarena_capacity(arena) == capacity);
+    allocbudget_start();
+    metricarena_alloc(arena, 1000);
+    CHECK(allocbudget_stop().allocations == 0);
+
+    metricarena_destroy(&arena);
+    CHECK(!arena);
+}
+
+TEST_CASE("metricarena interval test")
+{
+    linuxmetric_t* metrics[200];
+
+    // on the heap every metric costs the metric and its type
+    allocbudget_start();
+    s_tick(metrics, 200);
+    CHECK(allocbudget_stop().allocations >= 400);
+
+    // the first intervals size the arena, then metrics and types of an
+    // interval do not allocate
+    metricarena_t* arena = metricarena_new(256);
+    for (int i = 0; i < 2; i++) {
+        linuxmetric_set_arena(arena);
+        s_tick(metrics, 200);
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+    }
+    for (int i = 0; i < 3; i++) {
+        allocbudget_start();
+        linuxmetric_set_arena(arena);
+        s_tick(metrics, 200);
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+        CHECK(allocbudget_stop().allocations == 0);
+    }
+
+    // collectors over the fixture tree: on the heap every metric costs the
+    // metric and its type, with the arena the interval does not allocate
+    sourcereader_t* reader            = sourcereader_new("tests/selftest-ro/data/");
+    linuxsensors_t* sensors           = linuxsensors_new(reader);
+    syslimits_t*    limits            = syslimits_new(reader);
+    zhashx_t*       history           = linuxmetric_history_new();
+    size_t          heap_allocations  = 0;
+    size_t          arena_allocations = 0;
+    size_t          count             = 0;
+    for (int i = 0; i < 4; i++) {
+        bool with_arena = i >= 2;
+        if (with_arena)
+            linuxmetric_set_arena(arena);
+        allocbudget_start();
+        linuxmetric_list_t* info         = linuxmetric_get_all(10, history, reader, true);
+        linuxmetric_list_t* sensors_info = linuxsensors_get_all(sensors, 10, history);
+        linuxmetric_list_t* limits_info  = syslimits_get_all(limits);
+        linuxmetric_list_append(info, &sensors_info);
+        linuxmetric_list_append(info, &limits_info);
+        count = metriclist_destroy(&info);
+        size_t allocations = allocbudget_stop().allocations;
+        linuxmetric_set_arena(NULL);
+        metricarena_reset(arena);
+        // first interval of each kind fills history and the arena
+        if (i == 1)
+            heap_allocations = allocations;
+        else if (i == 3)
+            arena_allocations = allocations;
+    }
+    CHECK(count > 40);
+    CHECK(heap_allocations >= 2 * count);
+    CHECK(arena_allocations == 0);
+
+    zhashx_destroy(&history);
+    syslimits_destroy(&limits);
+    linuxsensors_destroy(&sensors);
+    sourcereader_destroy(&reader);
+    metricarena_destroy(&arena);
+}
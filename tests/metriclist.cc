@@ -0,0 +1,40 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#include "metriclist.h"
+
+//  --------------------------------------------------------------------------
+//  Return first metric of type in list
+
+linuxmetric_t* metriclist_find(linuxmetric_list_t* list, const char* type)
+{
+    linuxmetric_t* metric = linuxmetric_list_first(list);
+    while (metric) {
+        if (streq(metric->type, type))
+            return metric;
+        metric = linuxmetric_list_next(list);
+    }
+    return NULL;
+}
+
+//  --------------------------------------------------------------------------
+//  Destroy list with its metrics
+
+size_t metriclist_destroy(linuxmetric_list_t** list_p)
+{
+    size_t size = linuxmetric_list_size(*list_p);
+    linuxmetric_list_destroy(list_p);
+    return size;
+}
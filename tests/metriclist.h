@@ -0,0 +1,26 @@
+/*  ========================================================================
+    Copyright (C) 2021 Eaton
+    This program is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 2 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License along
+    with this program; if not, write to the Free Software Foundation, Inc.,
+    51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+    ========================================================================
+*/
+#pragma once
+#include "src/linuxmetric.h"
+
+//  Helpers for lists of metrics returned by the collectors in tests and
+//  benchmarks. History of the collectors comes from linuxmetric_history_new.
+
+//  Return first metric of type in list, NULL if there is none
+linuxmetric_t* metriclist_find(linuxmetric_list_t* list, const char* type);
+
+//  Destroy list with its metrics and return how many metrics it held
+size_t metriclist_destroy(linuxmetric_list_t** list_p);
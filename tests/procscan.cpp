@@ -0,0 +1,134 @@
+#include "src/linuxmetric.h"
+#include "src/procscan.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <filesystem>
+#include <unistd.h>
+
+static double s_value(linuxmetric_list_t* list, const char* type_template, size_t rank)
+{
+    char*          type   = zsys_sprintf(type_template, rank);
+    double         value  = -1;
+    linuxmetric_t* metric = linuxmetric_list_first(list);
+    while (metric) {
+        if (streq(metric->type, type))
+            value = metric->value;
+        metric = linuxmetric_list_next(list);
+    }
+    zstr_free(&type);
+    return value;
+}
+
+TEST_CASE("procscan test")
+{
+    // fixture has two processes:
+    //   100 (malamute) 500 s of CPU during 1000 s, 1000 pages resident
+    //   200 (fty agent) 10 s of CPU during 100 s, 5000 pages resident
+    std::string root_dir = "tests/selftest-ro/data/";
+    double      page_kb  = double(sysconf(_SC_PAGESIZE)) / 1024;
+    REQUIRE(sysconf(_SC_CLK_TCK) == 100);
+
+    // only one process is read per call
+    procscan_t* procscan = procscan_new(root_dir, 2, 1);
+
+    linuxmetric_list_t* info = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 1);
+    // no CPU rate after the first sample, memory is known
+    CHECK(linuxmetric_list_size(info) == 2);
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 1) == -1);
+    CHECK(s_value(info, PROCESS_MEMORY_TEMPLATE, 1) == Approx(1000 * page_kb));
+    CHECK(s_value(info, PROCESS_MEMORY_PID_TEMPLATE, 1) == 100);
+    metriclist_destroy(&info);
+
+    // second call reads 200
+    zclock_sleep(10);
+    info = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 2);
+    CHECK(linuxmetric_list_size(info) == 4);
+    CHECK(s_value(info, PROCESS_MEMORY_PID_TEMPLATE, 1) == 200);
+    CHECK(s_value(info, PROCESS_MEMORY_PID_TEMPLATE, 2) == 100);
+    metriclist_destroy(&info);
+
+    // new pass keeps both processes, 100 has its rate (no CPU used since)
+    zclock_sleep(10);
+    info = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 2);
+    CHECK(linuxmetric_list_size(info) == 6);
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 1) == Approx(0));
+    CHECK(s_value(info, PROCESS_CPU_PID_TEMPLATE, 1) == 100);
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 2) == -1);
+    metriclist_destroy(&info);
+
+    // top process 100 is rescanned and 200 gets its rate
+    zclock_sleep(10);
+    info = procscan_get_all(procscan);
+    CHECK(linuxmetric_list_size(info) == 8);
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 2) == Approx(0));
+    metriclist_destroy(&info);
+
+    procscan_destroy(&procscan);
+    CHECK(!procscan);
+
+    // root_dir without trailing '/'
+    procscan = procscan_new("tests/selftest-ro/data", 2, 2);
+    info     = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 2);
+    metriclist_destroy(&info);
+    procscan_destroy(&procscan);
+}
+
+static void s_write_stat(const std::string& root_dir, int pid, const char* comm, long ticks, long starttime)
+{
+    std::string dir = root_dir + "proc/" + std::to_string(pid);
+    std::filesystem::create_directories(dir);
+    FILE* file = fopen((dir + "/stat").c_str(), "w");
+    REQUIRE(file);
+    fprintf(file, "%d (%s) S 1 %d %d 0 -1 0 0 0 0 0 %ld 0 0 0 20 0 1 0 %ld 1000000 %d\n", pid, comm, pid, pid, ticks,
+        starttime, pid);
+    fclose(file);
+}
+
+TEST_CASE("procscan rates test")
+{
+    std::string root_dir = "procscan-rw/";
+    std::filesystem::remove_all(root_dir);
+    s_write_stat(root_dir, 10, "idle", 0, 100);
+    s_write_stat(root_dir, 20, "busy", 0, 100);
+    s_write_stat(root_dir, 30, "old", 1000000, 100);
+
+    procscan_t*         procscan = procscan_new(root_dir, 1, 256);
+    linuxmetric_list_t* info     = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 3);
+    // lifetime usage of 30 is not ranked against rates
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 1) == -1);
+    metriclist_destroy(&info);
+
+    zclock_sleep(100);
+    s_write_stat(root_dir, 20, "busy", 5, 100);
+    info = procscan_get_all(procscan);
+    CHECK(s_value(info, PROCESS_CPU_PID_TEMPLATE, 1) == 20);
+    CHECK(s_value(info, PROCESS_CPU_TEMPLATE, 1) > 0);
+    metriclist_destroy(&info);
+
+    // pid 10 is reused by a new process: no rate for it yet
+    zclock_sleep(100);
+    s_write_stat(root_dir, 10, "reused", 1000, 200);
+    info = procscan_get_all(procscan);
+    CHECK(s_value(info, PROCESS_CPU_PID_TEMPLATE, 1) != 10);
+    metriclist_destroy(&info);
+
+    // process 30 is not among the top, it is dropped once it is gone
+    std::filesystem::remove_all(root_dir + "proc/30");
+    info = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 2);
+    metriclist_destroy(&info);
+
+    // so is the top process
+    std::filesystem::remove_all(root_dir + "proc/20");
+    info = procscan_get_all(procscan);
+    CHECK(procscan_size(procscan) == 1);
+    metriclist_destroy(&info);
+
+    procscan_destroy(&procscan);
+    std::filesystem::remove_all(root_dir);
+}
@@ -0,0 +1,76 @@
+#include "src/linuxmetric.h"
+#include "src/selfmetric.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+#include <unistd.h>
+
+TEST_CASE("selfmetric test")
+{
+    zhashx_t* history = linuxmetric_history_new();
+
+    // first sample: no CPU rate yet
+    linuxmetric_list_t* info = selfmetric_get_all(1, history, 42, 3);
+    CHECK(!metriclist_find(info, SELFMETRIC_CPU_USAGE));
+
+    linuxmetric_t* metric = metriclist_find(info, SELFMETRIC_MEMORY_RSS);
+    REQUIRE(metric);
+    CHECK(metric->value > 0);
+    CHECK(streq(metric->unit, "kB"));
+
+    metric = metriclist_find(info, SELFMETRIC_MEMORY_HEAP);
+    REQUIRE(metric);
+    CHECK(metric->value > 0);
+
+    // at least stdin/stdout/stderr
+    metric = metriclist_find(info, SELFMETRIC_FD_OPEN);
+    REQUIRE(metric);
+    CHECK(metric->value >= 3);
+
+    metric = metriclist_find(info, SELFMETRIC_THREADS);
+    REQUIRE(metric);
+    CHECK(metric->value >= 1);
+
+    metric = metriclist_find(info, SELFMETRIC_ASSETS_SIZE);
+    REQUIRE(metric);
+    CHECK(metric->value == 42);
+
+    metric = metriclist_find(info, SELFMETRIC_IFACE_DROPPED);
+    REQUIRE(metric);
+    CHECK(metric->value == 3);
+
+    // the CPU tick counter besides the entries of linuxmetric CPU usage
+    metric = metriclist_find(info, SELFMETRIC_HISTORY_SIZE);
+    REQUIRE(metric);
+    CHECK(metric->value == 3);
+    metriclist_destroy(&info);
+
+    // burn some CPU, second sample has the rate
+    volatile double x = 0;
+    for (int i = 0; i < 10000000; i++)
+        x = x + i;
+    info   = selfmetric_get_all(1, history, 0, 0);
+    metric = metriclist_find(info, SELFMETRIC_CPU_USAGE);
+    REQUIRE(metric);
+    CHECK(metric->value >= 0);
+    CHECK(streq(metric->unit, "%"));
+    metriclist_destroy(&info);
+
+    zhashx_destroy(&history);
+}
+
+TEST_CASE("linuxmetric counter rate test")
+{
+    zhashx_t* history = linuxmetric_history_new();
+
+    double rate = -1;
+    CHECK(!linuxmetric_counter_rate(history, "counter", 100, 10, &rate));
+    CHECK(rate == -1);
+    CHECK(linuxmetric_counter_rate(history, "counter", 300, 10, &rate));
+    CHECK(rate == 20);
+    // counter reset
+    CHECK(!linuxmetric_counter_rate(history, "counter", 5, 10, &rate));
+    CHECK(linuxmetric_counter_rate(history, "counter", 5, 10, &rate));
+    CHECK(rate == 0);
+
+    zhashx_destroy(&history);
+}
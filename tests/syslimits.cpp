@@ -0,0 +1,61 @@
+#include "src/linuxmetric.h"
+#include "src/sourcereader.h"
+#include "src/syslimits.h"
+#include "tests/metriclist.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("syslimits test")
+{
+    sourcereader_t* reader = sourcereader_new("tests/selftest-ro/data/");
+    syslimits_t*    limits = syslimits_new(reader);
+    // files are kept open
+    CHECK(sourcereader_size(reader) == 5);
+
+    linuxmetric_list_t* info = syslimits_get_all(limits);
+    CHECK(linuxmetric_list_size(info) == 8);
+
+    linuxmetric_t* metric = metriclist_find(info, LINUXMETRIC_FILE_HANDLE_TOTAL);
+    REQUIRE(metric);
+    CHECK(metric->value == 100000);
+    metric = metriclist_find(info, LINUXMETRIC_FILE_HANDLE_USED);
+    REQUIRE(metric);
+    CHECK(metric->value == 1536);
+    metric = metriclist_find(info, LINUXMETRIC_FILE_HANDLE_USAGE);
+    REQUIRE(metric);
+    CHECK(metric->value == 2);
+    CHECK(streq(metric->unit, "%"));
+
+    metric = metriclist_find(info, LINUXMETRIC_INODE_USED);
+    REQUIRE(metric);
+    CHECK(metric->value == 48000);
+
+    metric = metriclist_find(info, LINUXMETRIC_PID_TOTAL);
+    REQUIRE(metric);
+    CHECK(metric->value == 32768);
+    metric = metriclist_find(info, LINUXMETRIC_PID_USED);
+    REQUIRE(metric);
+    CHECK(metric->value == 328);
+    metric = metriclist_find(info, LINUXMETRIC_PID_USAGE);
+    REQUIRE(metric);
+    CHECK(metric->value == 1);
+
+    metric = metriclist_find(info, LINUXMETRIC_ENTROPY_AVAILABLE);
+    REQUIRE(metric);
+    CHECK(metric->value == 256);
+    metriclist_destroy(&info);
+
+    syslimits_destroy(&limits);
+    CHECK(sourcereader_size(reader) == 0);
+    sourcereader_destroy(&reader);
+}
+
+TEST_CASE("syslimits missing files test")
+{
+    sourcereader_t*     reader = sourcereader_new("tests/selftest-ro/nonexistent/");
+    syslimits_t*        limits = syslimits_new(reader);
+    linuxmetric_list_t* info   = syslimits_get_all(limits);
+    CHECK(linuxmetric_list_size(info) == 0);
+    metriclist_destroy(&info);
+    syslimits_destroy(&limits);
+    sourcereader_destroy(&reader);
+}
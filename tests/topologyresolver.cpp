@@ -1,6 +1,10 @@
 #include <catch2/catch.hpp>
+#include "src/fty_info.h"
 #include "src/topologyresolver.h"
+#include "tests/assetgen.h"
 #include <malamute.h>
+#include <time.h>
+#include <unordered_map>
 
 typedef enum
 {
@@ -129,3 +133,151 @@ TEST_CASE("topologyresolver test")
 
     topologyresolver_destroy(&resolver);
 }
+
+// Stand-in for fty-asset answering ASSET_DETAIL from the generated assets
+typedef struct
+{
+    const char*                                   endpoint;
+    std::unordered_map<std::string, fty_proto_t*> assets;
+    size_t                                        requests;
+} asset_agent_t;
+
+static void s_asset_agent(zsock_t* pipe, void* args)
+{
+    asset_agent_t* agent  = static_cast<asset_agent_t*>(args);
+    mlm_client_t*  client = mlm_client_new();
+    mlm_client_connect(client, agent->endpoint, 1000, FTY_ASSET_AGENT);
+    zpoller_t* poller = zpoller_new(pipe, mlm_client_msgpipe(client), NULL);
+    zsock_signal(pipe, 0);
+
+    while (!zsys_interrupted) {
+        void* which = zpoller_wait(poller, -1);
+        if (which == pipe || !which)
+            break;
+        zmsg_t* request = mlm_client_recv(client);
+        char*   command = zmsg_popstr(request);
+        char*   uuid    = zmsg_popstr(request);
+        char*   iname   = zmsg_popstr(request);
+        zmsg_t* reply   = NULL;
+        auto    it      = iname ? agent->assets.find(iname) : agent->assets.end();
+        agent->requests++;
+        if (command && streq(command, "GET") && it != agent->assets.end()) {
+            fty_proto_t* asset = fty_proto_dup(it->second);
+            reply              = fty_proto_encode(&asset);
+        } else {
+            reply = zmsg_new();
+            zmsg_addstr(reply, "ERROR");
+        }
+        zmsg_pushstr(reply, uuid ? uuid : "");
+        mlm_client_sendto(client, mlm_client_sender(client), "ASSET_DETAIL", NULL, 1000, &reply);
+        zstr_free(&iname);
+        zstr_free(&uuid);
+        zstr_free(&command);
+        zmsg_destroy(&request);
+    }
+    zpoller_destroy(&poller);
+    mlm_client_destroy(&client);
+}
+
+static double s_cpu_usecs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return double(now.tv_sec) * 1000000 + double(now.tv_nsec) / 1000;
+}
+
+typedef struct
+{
+    size_t announces;
+    size_t peak_cache;  // assets
+    double cpu_per_msg; // usec, reported only
+} stream_stats_t;
+
+// Drive all assets through the resolver like s_handle_stream does
+static stream_stats_t s_stream(topologyresolver_t* resolver, const std::vector<fty_proto_t*>& assets)
+{
+    stream_stats_t stats = {0, 0, 0};
+    double         start = s_cpu_usecs();
+    for (size_t i = 0; i < assets.size(); i++) {
+        if (topologyresolver_asset(resolver, assets[i]))
+            stats.announces++;
+        stats.peak_cache = std::max(stats.peak_cache, topologyresolver_assets_size(resolver));
+    }
+    stats.cpu_per_msg = (s_cpu_usecs() - start) / double(assets.size());
+    return stats;
+}
+
+// Position of asset iname in the stream
+static size_t s_position(const std::vector<fty_proto_t*>& assets, const char* iname)
+{
+    for (size_t i = 0; i < assets.size(); i++) {
+        if (streq(fty_proto_name(assets[i]), iname))
+            return i;
+    }
+    return assets.size();
+}
+
+// Stress tests take seconds and are not run by default, run them with
+// "fty-info-test [stress]". Until my message comes every asset may be my
+// parent and is cached, then only my parents are.
+
+TEST_CASE("topologyresolver stress test without asset agent", "[.][stress]")
+{
+    const size_t              size   = 100000;
+    std::vector<fty_proto_t*> assets = assetgen_datacenter(size, "rackcontroller-0", 42);
+    REQUIRE(assets.size() == size);
+    size_t mine = s_position(assets, "rackcontroller-0");
+    REQUIRE(mine < size);
+
+    topologyresolver_t* resolver = topologyresolver_new("rackcontroller-0");
+    stream_stats_t      stats    = s_stream(resolver, assets);
+    WARN("cached " << stats.peak_cache << " assets at most, " << stats.cpu_per_msg << " us of CPU per message");
+    // parents can't change, topology is announced exactly once
+    CHECK(stats.announces == 1);
+    CHECK(stats.peak_cache <= mine + 1 + ASSETGEN_DEPTH);
+    CHECK(topologyresolver_assets_size(resolver) == ASSETGEN_DEPTH + 1);
+    char* topology = topologyresolver_to_string(resolver);
+    CHECK(streq(topology, "friendly datacenter-1/friendly room-9/friendly row-9-9/friendly rack-9-9-9"));
+    zstr_free(&topology);
+    topologyresolver_destroy(&resolver);
+
+    assetgen_destroy(assets);
+}
+
+TEST_CASE("topologyresolver stress test with asset agent", "[.][stress]")
+{
+    const size_t              size   = 100000;
+    std::vector<fty_proto_t*> assets = assetgen_datacenter(size, "rackcontroller-0", 42);
+    REQUIRE(assets.size() == size);
+    size_t mine = s_position(assets, "rackcontroller-0");
+    REQUIRE(mine < size);
+
+    static const char* endpoint = "inproc://fty-info-topologyresolver-stress";
+    zactor_t*          broker   = zactor_new(mlm_server, const_cast<char*>("Malamute"));
+    zstr_sendx(broker, "BIND", endpoint, NULL);
+    asset_agent_t agent;
+    agent.endpoint = endpoint;
+    agent.requests = 0;
+    for (fty_proto_t* asset : assets) {
+        agent.assets[fty_proto_name(asset)] = asset;
+    }
+    zactor_t* agent_actor = zactor_new(s_asset_agent, &agent);
+
+    topologyresolver_t* resolver = topologyresolver_new("rackcontroller-0");
+    topologyresolver_set_endpoint(resolver, endpoint);
+    stream_stats_t stats = s_stream(resolver, assets);
+    WARN("cached " << stats.peak_cache << " assets at most, " << stats.cpu_per_msg << " us of CPU per message");
+    // my message and then updates of parents which came after it
+    CHECK(stats.announces >= 1);
+    CHECK(stats.announces <= ASSETGEN_DEPTH + 1);
+    CHECK(stats.peak_cache <= mine + 1 + ASSETGEN_DEPTH);
+    CHECK(topologyresolver_assets_size(resolver) == ASSETGEN_DEPTH + 1);
+    topologyresolver_destroy(&resolver);
+
+    zactor_destroy(&agent_actor);
+    // only parents missing when my message came are asked for
+    CHECK(agent.requests <= ASSETGEN_DEPTH);
+    zactor_destroy(&broker);
+
+    assetgen_destroy(assets);
+}
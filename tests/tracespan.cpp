@@ -0,0 +1,67 @@
+#include "src/tracespan.h"
+#include <catch2/catch.hpp>
+#include <string>
+#include <thread>
+
+//  Dump spans into a string
+static std::string s_dump(size_t* count)
+{
+    char*  buffer = NULL;
+    size_t size   = 0;
+    FILE*  output = open_memstream(&buffer, &size);
+    *count        = tracespan_dump(output);
+    fclose(output);
+    std::string dump(buffer, size);
+    free(buffer);
+    return dump;
+}
+
+TEST_CASE("tracespan test")
+{
+    tracespan_reset();
+
+    // disabled, nothing is recorded
+    tracespan_enable(false);
+    {
+        TRACESPAN("disabled");
+    }
+    CHECK(tracespan_size() == 0);
+
+    tracespan_enable(true);
+    {
+        TRACESPAN("outer");
+        {
+            TRACESPAN("inner \"quoted\"");
+        }
+    }
+    std::thread thread([] {
+        TRACESPAN("other thread");
+    });
+    thread.join();
+    CHECK(tracespan_size() == 3);
+
+    size_t      count = 0;
+    std::string dump  = s_dump(&count);
+    CHECK(count == 3);
+    CHECK(dump.compare(0, 15, "{\"traceEvents\":") == 0);
+    CHECK(dump.find("\"name\":\"outer\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(dump.find("\"name\":\"inner \\\"quoted\\\"\"") != std::string::npos);
+    CHECK(dump.find("\"name\":\"other thread\"") != std::string::npos);
+    CHECK(dump.find("\"disabled\"") == std::string::npos);
+    // inner span ends first and is written first
+    CHECK(dump.find("inner") < dump.find("outer"));
+
+    // ring keeps the last TRACESPAN_CAPACITY spans of the thread
+    tracespan_reset();
+    for (int i = 0; i < TRACESPAN_CAPACITY + 10; i++) {
+        tracespan_record("ring", i, i + 1);
+    }
+    CHECK(tracespan_size() == TRACESPAN_CAPACITY);
+    dump = s_dump(&count);
+    CHECK(count == TRACESPAN_CAPACITY);
+    CHECK(dump.find("\"ts\":0.010,") != std::string::npos);
+    CHECK(dump.find("\"ts\":0.009,") == std::string::npos);
+
+    tracespan_enable(false);
+    tracespan_reset();
+}